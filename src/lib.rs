@@ -204,14 +204,30 @@ impl Matrix {
     }
 
     /// Transpose the matrix.
+    ///
+    /// Works in cache-sized tiles; large matrices are split into column strips
+    /// (rows of the result) across scoped threads.
     #[must_use]
     pub fn transpose(&self) -> Matrix {
-        let mut result = Matrix::zeros(self.cols, self.rows);
-        for i in 0..self.rows {
-            for j in 0..self.cols {
-                result.data[j * self.rows + i] = self.data[i * self.cols + j];
-            }
+        let (rows, cols) = (self.rows, self.cols);
+        let mut result = Matrix::zeros(cols, rows);
+        if rows == 0 || cols == 0 {
+            return result;
         }
+        let threads = std::thread::available_parallelism().map_or(1, |n| n.get());
+
+        if rows * cols < TRANSPOSE_PARALLEL_MIN || threads == 1 {
+            transpose_strip(&self.data, rows, cols, &mut result.data, 0);
+            return result;
+        }
+
+        let strip = cols.div_ceil(threads).next_multiple_of(TRANSPOSE_TILE);
+        let src = &self.data;
+        std::thread::scope(|s| {
+            for (t, chunk) in result.data.chunks_mut(strip * rows).enumerate() {
+                s.spawn(move || transpose_strip(src, rows, cols, chunk, t * strip));
+            }
+        });
         result
     }
 
@@ -275,6 +291,26 @@ impl std::ops::IndexMut<(usize, usize)> for Matrix {
 // Matrix Operations (Internal)
 // ============================================================================
 
+const TRANSPOSE_TILE: usize = 32;
+const TRANSPOSE_PARALLEL_MIN: usize = 512 * 512;
+
+/// Write rows `j0..` of the transpose of `src` (rows × cols) into `dst`,
+/// one TILE × TILE block at a time.
+fn transpose_strip(src: &[f32], rows: usize, cols: usize, dst: &mut [f32], j0: usize) {
+    let j1 = j0 + dst.len() / rows;
+    for ib in (0..rows).step_by(TRANSPOSE_TILE) {
+        let ie = (ib + TRANSPOSE_TILE).min(rows);
+        for jb in (j0..j1).step_by(TRANSPOSE_TILE) {
+            let je = (jb + TRANSPOSE_TILE).min(j1);
+            for i in ib..ie {
+                for (j, &v) in (jb..je).zip(&src[i * cols + jb..i * cols + je]) {
+                    dst[(j - j0) * rows + i] = v;
+                }
+            }
+        }
+    }
+}
+
 fn matmul_naive(a: &[f32], b: &[f32], c: &mut [f32], m: usize, k: usize, n: usize) {
     c.fill(0.0);
     for i in 0..m {
@@ -449,6 +485,24 @@ mod tests {
         assert_eq!(t.get(2, 1), 6.0);
     }
 
+    #[test]
+    fn test_matrix_transpose_blocked() {
+        // Spans several tiles with ragged edges on both sides
+        let (rows, cols) = (70, 45);
+        let m = Matrix::from_vec(rows, cols, (0..rows * cols).map(|i| i as f32).collect());
+        let t = m.transpose();
+        assert_eq!(t.shape(), (cols, rows));
+        for i in 0..rows {
+            for j in 0..cols {
+                assert_eq!(t.get(j, i), m.get(i, j));
+            }
+        }
+
+        // Empty matrices transpose to empty matrices of the swapped shape
+        assert_eq!(Matrix::zeros(0, 5).transpose().shape(), (5, 0));
+        assert_eq!(Matrix::zeros(5, 0).transpose().shape(), (0, 5));
+    }
+
     #[test]
     fn test_matmul_identity() {
         if !is_available() {
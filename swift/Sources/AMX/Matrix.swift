@@ -227,17 +227,10 @@ public struct Matrix: Sendable {
     
     public func transposed() -> Matrix {
         let result = Matrix(rows: cols, cols: rows)
-        let src = storage.data
-        let dst = result.storage.data
-        let srcStride = storage.stride
-        let dstStride = result.storage.stride
-        
-        for i in 0..<rows {
-            let srcRow = src + i * srcStride
-            for j in 0..<cols {
-                (dst + j * dstStride + i).pointee = (srcRow + j).pointee
-            }
-        }
+        // Blocked, multithreaded kernel shared with the C API
+        amx_transpose_f32(storage.data, storage.stride,
+                          result.storage.data, result.storage.stride,
+                          rows, cols)
         return result
     }
     
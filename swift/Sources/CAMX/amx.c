@@ -4,9 +4,41 @@
 #include "include/amx.h"
 #include <stdlib.h>
 #include <string.h>
-#include <sys/sysctl.h>
+#include <math.h>
+#include <float.h>
 #include <pthread.h>
+#include <stdatomic.h>
+
+// ============================================================================
+// Platform
+// ============================================================================
+
+// AMX instructions exist only on Apple Silicon. Everywhere else the library
+// still builds: amx_detect() reports AMX_VERSION_NONE, the AMX primitives below
+// compile to nothing, and every operation takes its portable SIMD path.
+#if defined(__APPLE__) && defined(__aarch64__)
+#define AMX_HW 1
+#else
+#define AMX_HW 0
+#endif
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
 #include <dispatch/dispatch.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AMX_X86 1
+#else
+#define AMX_X86 0
+#endif
 
 // ============================================================================
 // Compiler Hints
@@ -40,9 +72,18 @@
 #define AMX_OP_LDZ    (AMX_OP_BASE | (4 << 5))
 #define AMX_OP_STZ    (AMX_OP_BASE | (5 << 5))
 #define AMX_OP_FMA32  (AMX_OP_BASE | (12 << 5))
+#define AMX_OP_FMS32  (AMX_OP_BASE | (13 << 5))
+#define AMX_OP_MAC16  (AMX_OP_BASE | (14 << 5))
+#define AMX_OP_FMA16  (AMX_OP_BASE | (15 << 5))
 #define AMX_OP_SET    (AMX_OP_BASE | (17 << 5))
 #define AMX_OP_CLR    (AMX_OP_BASE | (17 << 5) | 1)
 
+// FMA/MAC operand bit 62: 16-bit inputs accumulate into 32-bit Z rows
+// (f16 -> f32 for fma16, i16 -> i32 for mac16)
+#define AMX_FMA_WIDEN (1ULL << 62)
+
+#define AMX_MAX_THREADS 16
+
 // ============================================================================
 // Detection
 // ============================================================================
@@ -52,6 +93,7 @@ static pthread_once_t g_detect_once = PTHREAD_ONCE_INIT;
 static int g_num_cores = 1;
 
 COLD static void detect_amx_internal(void) {
+#if AMX_HW
     char brand[256] = {0};
     size_t size = sizeof(brand);
     
@@ -74,8 +116,17 @@ COLD static void detect_amx_internal(void) {
     // Get number of performance cores
     size_t ncpu_size = sizeof(g_num_cores);
     sysctlbyname("hw.perflevel0.logicalcpu", &g_num_cores, &ncpu_size, NULL, 0);
+#else
+    g_amx_version = AMX_VERSION_NONE;
+#if defined(__APPLE__)
+    size_t ncpu_size = sizeof(g_num_cores);
+    sysctlbyname("hw.logicalcpu", &g_num_cores, &ncpu_size, NULL, 0);
+#else
+    g_num_cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+#endif
     if (g_num_cores < 1) g_num_cores = 1;
-    if (g_num_cores > 16) g_num_cores = 16;
+    if (g_num_cores > AMX_MAX_THREADS) g_num_cores = AMX_MAX_THREADS;
 }
 
 AmxVersion amx_detect(void) {
@@ -87,6 +138,8 @@ AmxVersion amx_detect(void) {
 // AMX Primitives - Inline Assembly
 // ============================================================================
 
+#if AMX_HW
+
 // AMX SET/CLR require 3 NOPs before the instruction for pipeline safety
 // Use newlines in asm string instead of semicolons to ensure all instructions are emitted
 #define AMX_SET() \
@@ -133,6 +186,25 @@ AmxVersion amx_detect(void) {
     __asm__ volatile(".word %0" :: "i"(AMX_OP_FMA32), "r"(_op) : "memory"); \
 } while(0)
 
+// FMS32: Z[z_row*4..] -= outer_product(X[x_off], Y[y_off])
+#define AMX_FMS32(x_off, y_off, z_row) do { \
+    register uint64_t _op __asm__("x0") = ((uint64_t)(z_row) << 20) | ((uint64_t)(x_off) << 10) | (uint64_t)(y_off); \
+    __asm__ volatile(".word %0" :: "i"(AMX_OP_FMS32), "r"(_op) : "memory"); \
+} while(0)
+
+// FMA16 widening: f16 X/Y, f32 Z. Output (j, i) lands in Z row j*2 + (i & 1),
+// lane i >> 1, so a 32x32 f32 tile occupies all 64 Z rows.
+#define AMX_FMA16_F32(x_off, y_off, z_row) do { \
+    register uint64_t _op __asm__("x0") = AMX_FMA_WIDEN | ((uint64_t)(z_row) << 20) | ((uint64_t)(x_off) << 10) | (uint64_t)(y_off); \
+    __asm__ volatile(".word %0" :: "i"(AMX_OP_FMA16), "r"(_op) : "memory"); \
+} while(0)
+
+// MAC16 widening: i16 X/Y, i32 Z, same interleaved Z layout as AMX_FMA16_F32
+#define AMX_MAC16_I32(x_off, y_off, z_row) do { \
+    register uint64_t _op __asm__("x0") = AMX_FMA_WIDEN | ((uint64_t)(z_row) << 20) | ((uint64_t)(x_off) << 10) | (uint64_t)(y_off); \
+    __asm__ volatile(".word %0" :: "i"(AMX_OP_MAC16), "r"(_op) : "memory"); \
+} while(0)
+
 // For header compatibility
 void amx_set(void) { AMX_SET(); }
 void amx_clr(void) { AMX_CLR(); }
@@ -156,8 +228,8 @@ DEFINE_AMX_FUNC(amx_extry, AMX_OP_BASE | (9 << 5))
 DEFINE_AMX_FUNC(amx_fma64, AMX_OP_BASE | (10 << 5))
 DEFINE_AMX_FUNC(amx_fms64, AMX_OP_BASE | (11 << 5))
 DEFINE_AMX_FUNC(amx_fma32, AMX_OP_FMA32)
-DEFINE_AMX_FUNC(amx_fms32, AMX_OP_BASE | (13 << 5))
-DEFINE_AMX_FUNC(amx_mac16, AMX_OP_BASE | (14 << 5))
+DEFINE_AMX_FUNC(amx_fms32, AMX_OP_FMS32)
+DEFINE_AMX_FUNC(amx_mac16, AMX_OP_MAC16)
 DEFINE_AMX_FUNC(amx_fma16, AMX_OP_BASE | (15 << 5))
 DEFINE_AMX_FUNC(amx_fms16, AMX_OP_BASE | (16 << 5))
 DEFINE_AMX_FUNC(amx_vecint, AMX_OP_BASE | (18 << 5))
@@ -166,6 +238,108 @@ DEFINE_AMX_FUNC(amx_matint, AMX_OP_BASE | (20 << 5))
 DEFINE_AMX_FUNC(amx_matfp, AMX_OP_BASE | (21 << 5))
 DEFINE_AMX_FUNC(amx_genlut, AMX_OP_BASE | (22 << 5))
 
+#else // !AMX_HW
+
+// No coprocessor: the kernels still type-check but their AMX paths are never
+// selected because amx_detect() returns AMX_VERSION_NONE.
+#define AMX_SET()                        ((void)0)
+#define AMX_CLR()                        ((void)0)
+#define AMX_LDX(addr, reg)               ((void)(addr), (void)(reg))
+#define AMX_LDY(addr, reg)               ((void)(addr), (void)(reg))
+#define AMX_LDZ(addr, row)               ((void)(addr), (void)(row))
+#define AMX_STZ(addr, row)               ((void)(addr), (void)(row))
+#define AMX_FMA32(x_off, y_off, z_row)   ((void)(x_off), (void)(y_off), (void)(z_row))
+#define AMX_FMS32(x_off, y_off, z_row)   ((void)(x_off), (void)(y_off), (void)(z_row))
+#define AMX_FMA16_F32(x_off, y_off, z_row) ((void)(x_off), (void)(y_off), (void)(z_row))
+#define AMX_MAC16_I32(x_off, y_off, z_row) ((void)(x_off), (void)(y_off), (void)(z_row))
+
+void amx_set(void) { __builtin_trap(); }
+void amx_clr(void) { __builtin_trap(); }
+
+#define DEFINE_AMX_FUNC(name, opcode) \
+    void name(uint64_t operand) { (void)operand; __builtin_trap(); }
+
+DEFINE_AMX_FUNC(amx_ldx, AMX_OP_LDX)
+DEFINE_AMX_FUNC(amx_ldy, AMX_OP_LDY)
+DEFINE_AMX_FUNC(amx_ldz, AMX_OP_LDZ)
+DEFINE_AMX_FUNC(amx_stx, AMX_OP_STX)
+DEFINE_AMX_FUNC(amx_sty, AMX_OP_STY)
+DEFINE_AMX_FUNC(amx_stz, AMX_OP_STZ)
+DEFINE_AMX_FUNC(amx_ldzi, 0)
+DEFINE_AMX_FUNC(amx_stzi, 0)
+DEFINE_AMX_FUNC(amx_extrx, 0)
+DEFINE_AMX_FUNC(amx_extry, 0)
+DEFINE_AMX_FUNC(amx_fma64, 0)
+DEFINE_AMX_FUNC(amx_fms64, 0)
+DEFINE_AMX_FUNC(amx_fma32, AMX_OP_FMA32)
+DEFINE_AMX_FUNC(amx_fms32, AMX_OP_FMS32)
+DEFINE_AMX_FUNC(amx_mac16, AMX_OP_MAC16)
+DEFINE_AMX_FUNC(amx_fma16, AMX_OP_FMA16)
+DEFINE_AMX_FUNC(amx_fms16, 0)
+DEFINE_AMX_FUNC(amx_vecint, 0)
+DEFINE_AMX_FUNC(amx_vecfp, 0)
+DEFINE_AMX_FUNC(amx_matint, 0)
+DEFINE_AMX_FUNC(amx_matfp, 0)
+DEFINE_AMX_FUNC(amx_genlut, 0)
+
+#endif // AMX_HW
+
+// ============================================================================
+// Parallelism
+// ============================================================================
+
+typedef void (*ParallelBody)(void *ctx, size_t index);
+
+/// Run body(ctx, i) for i in [0, n) across the performance cores.
+/// GCD's global queue on Apple platforms, short-lived pthreads elsewhere.
+#if defined(__APPLE__)
+static void parallel_for(size_t n, void *ctx, ParallelBody body) {
+    if (n == 1) { body(ctx, 0); return; }
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0);
+    dispatch_apply_f(n, queue, ctx, body);
+}
+#else
+typedef struct {
+    void *ctx;
+    ParallelBody body;
+    size_t n;
+    atomic_size_t next;
+} ParallelJob;
+
+static void *parallel_worker(void *arg) {
+    ParallelJob *job = (ParallelJob *)arg;
+    size_t i;
+    while ((i = atomic_fetch_add(&job->next, 1)) < job->n) job->body(job->ctx, i);
+    return NULL;
+}
+
+static void parallel_for(size_t n, void *ctx, ParallelBody body) {
+    size_t workers = n < (size_t)g_num_cores ? n : (size_t)g_num_cores;
+    if (workers <= 1) {
+        for (size_t i = 0; i < n; ++i) body(ctx, i);
+        return;
+    }
+    
+    ParallelJob job = { .ctx = ctx, .body = body, .n = n };
+    atomic_init(&job.next, 0);
+    
+    // The calling thread is one of the workers
+    pthread_t threads[AMX_MAX_THREADS];
+    size_t spawned = 0;
+    for (; spawned < workers - 1; ++spawned) {
+        if (pthread_create(&threads[spawned], NULL, parallel_worker, &job) != 0) break;
+    }
+    parallel_worker(&job);
+    for (size_t t = 0; t < spawned; ++t) pthread_join(threads[t], NULL);
+}
+#endif
+
+/// Number of worker threads parallel_for will use.
+static int num_workers(void) {
+    amx_detect();
+    return g_num_cores;
+}
+
 // ============================================================================
 // Memory
 // ============================================================================
@@ -190,7 +364,8 @@ struct AmxMatrix {
     size_t stride;           // >= cols, multiple of 16
 };
 
-AmxMatrix *amx_matrix_zeros(size_t rows, size_t cols) {
+// Storage is left uninitialized, padding included; callers write every lane
+static AmxMatrix *matrix_alloc(size_t rows, size_t cols) {
     if (UNLIKELY(!rows || !cols)) return NULL;
     
     AmxMatrix *m = malloc(sizeof(AmxMatrix));
@@ -200,11 +375,16 @@ AmxMatrix *amx_matrix_zeros(size_t rows, size_t cols) {
     m->cols = cols;
     m->stride = round_up(cols, AMX_TILE);
     
-    size_t bytes = rows * m->stride * sizeof(float);
-    m->data = alloc_aligned(bytes);
+    m->data = alloc_aligned(rows * m->stride * sizeof(float));
     if (UNLIKELY(!m->data)) { free(m); return NULL; }
+    return m;
+}
+
+AmxMatrix *amx_matrix_zeros(size_t rows, size_t cols) {
+    AmxMatrix *m = matrix_alloc(rows, cols);
+    if (UNLIKELY(!m)) return NULL;
     
-    memset(m->data, 0, bytes);
+    memset(m->data, 0, rows * m->stride * sizeof(float));
     return m;
 }
 
@@ -285,14 +465,17 @@ void amx_matrix_set(AmxMatrix *m, size_t r, size_t c, float v) { m->data[r * m->
     AMX_LDZ(_zeros, 48); AMX_LDZ(_zeros, 52); AMX_LDZ(_zeros, 56); AMX_LDZ(_zeros, 60); \
 } while(0)
 
+// Zero all 64 Z rows (mixed-precision modes use the whole register file)
+#define AMX_ZERO_Z_ALL() do { \
+    static const float _zeros[16] __attribute__((aligned(64))) = {0}; \
+    for (int _r = 0; _r < 64; ++_r) AMX_LDZ(_zeros, _r); \
+} while(0)
+
 // ============================================================================
 // Pack A into column-major panels for microkernel
 // Panel: 16 rows x K cols, tightly packed (stride 16)
-// Uses NEON for vectorized gather when possible
 // ============================================================================
 
-#include <arm_neon.h>
-
 HOT static void pack_a_panel(
     const float *RESTRICT A,
     float *RESTRICT panel,
@@ -331,7 +514,6 @@ HOT static void pack_a_panel(
         }
     } else {
         // Partial row case - need to zero pad
-        const float32x4_t zeros = vdupq_n_f32(0.0f);
         for (size_t k = 0; k < K; ++k) {
             float *RESTRICT dst = panel + k * 16;
             const float *RESTRICT src = src_base + k;
@@ -340,41 +522,8 @@ HOT static void pack_a_panel(
             for (size_t i = 0; i < rows; ++i) {
                 dst[i] = src[i * a_stride];
             }
-            // Zero remaining using NEON
-            size_t i = rows;
-            for (; i + 4 <= 16; i += 4) {
-                vst1q_f32(dst + i, zeros);
-            }
-            for (; i < 16; ++i) {
-                dst[i] = 0.0f;
-            }
-        }
-    }
-}
-
-// ============================================================================
-// Single-threaded matmul (for small matrices or single tile)
-// ============================================================================
-
-COLD static void matmul_naive(
-    const AmxMatrix *RESTRICT a,
-    const AmxMatrix *RESTRICT b,
-    AmxMatrix *RESTRICT c
-) {
-    const size_t M = a->rows, K = a->cols, N = b->cols;
-    const float *RESTRICT ap = a->data;
-    const float *RESTRICT bp = b->data;
-    float *RESTRICT cp = c->data;
-    const size_t as = a->stride, bs = b->stride, cs = c->stride;
-    
-    memset(cp, 0, M * cs * sizeof(float));
-    
-    for (size_t i = 0; i < M; ++i) {
-        for (size_t k = 0; k < K; ++k) {
-            float aik = ap[i * as + k];
-            for (size_t j = 0; j < N; ++j) {
-                cp[i * cs + j] += aik * bp[k * bs + j];
-            }
+            // Zero remaining
+            memset(dst + rows, 0, (16 - rows) * sizeof(float));
         }
     }
 }
@@ -383,28 +532,13 @@ COLD static void matmul_naive(
 // Multi-threaded AMX Matmul
 // ============================================================================
 
-typedef struct {
-    const float *RESTRICT A;
-    const float *RESTRICT B;
-    float *RESTRICT C;
-    float *RESTRICT a_panel;  // Thread-local packed A panel
-    size_t M, K, N;
-    size_t a_stride, b_stride, c_stride;
-    size_t i_start, i_end;    // Row tile range for this thread
-} MatmulTask;
-
-// Microkernel that works with strided B (original, faster for our case)
-HOT FLATTEN static void microkernel_16x16_strided(
+// Z += A_panel * B over K: the shared inner loop of every f32 microkernel
+ALWAYS_INLINE static void microkernel_accumulate(
     const float *RESTRICT A,    // Column-major panel: 16 rows x K cols, stride 16
     const float *RESTRICT B,    // Row-major: K rows x N cols, stride b_stride
-    float *RESTRICT C,          // Row-major: 16 rows, stride c_stride
     size_t K,
-    size_t b_stride,
-    size_t c_stride
+    size_t b_stride
 ) {
-    // Zero Z registers - C starts at zero so no need to load
-    AMX_ZERO_Z();
-    
     // Process K in chunks of 8 (use all 8 X and Y registers)
     size_t k = 0;
     for (; k + 8 <= K; k += 8) {
@@ -456,255 +590,6673 @@ HOT FLATTEN static void microkernel_16x16_strided(
         AMX_LDX(B + k * b_stride, 0);
         AMX_FMA32(0, 0, 0);
     }
+}
+
+// Tile kernel for blocked drivers: C (mr x nr) = [C +] A_panel * B.
+// load_c continues a previous K block; partial tiles go through a staging row so
+// nothing outside the mr x nr window is read or written.
+HOT FLATTEN static void microkernel_16x16_acc(
+    const float *RESTRICT A,    // Column-major panel: 16 rows x K cols, stride 16
+    const float *RESTRICT B,    // Row-major: K rows, stride b_stride (16 valid lanes)
+    float *RESTRICT C,          // Row-major: mr rows x nr cols, stride c_stride
+    size_t K,
+    size_t b_stride,
+    size_t c_stride,
+    size_t mr,
+    size_t nr,
+    bool load_c
+) {
+    float row[AMX_TILE] ALIGNED(64) = {0};
+    const bool full = (mr == AMX_TILE && nr == AMX_TILE);
     
-    // Store C tile
-    AMX_STZ(C + 0  * c_stride, 0);
-    AMX_STZ(C + 1  * c_stride, 4);
-    AMX_STZ(C + 2  * c_stride, 8);
-    AMX_STZ(C + 3  * c_stride, 12);
-    AMX_STZ(C + 4  * c_stride, 16);
-    AMX_STZ(C + 5  * c_stride, 20);
-    AMX_STZ(C + 6  * c_stride, 24);
-    AMX_STZ(C + 7  * c_stride, 28);
-    AMX_STZ(C + 8  * c_stride, 32);
-    AMX_STZ(C + 9  * c_stride, 36);
-    AMX_STZ(C + 10 * c_stride, 40);
-    AMX_STZ(C + 11 * c_stride, 44);
-    AMX_STZ(C + 12 * c_stride, 48);
-    AMX_STZ(C + 13 * c_stride, 52);
-    AMX_STZ(C + 14 * c_stride, 56);
-    AMX_STZ(C + 15 * c_stride, 60);
-}
-
-HOT static void matmul_thread_func(void *ctx) {
-    MatmulTask *t = (MatmulTask *)ctx;
-    
-    const float *RESTRICT A = t->A;
-    const float *RESTRICT B = t->B;
-    float *RESTRICT C = t->C;
-    float *RESTRICT a_panel = t->a_panel;
-    
-    const size_t K = t->K;
-    const size_t N = t->N;
-    const size_t a_stride = t->a_stride;
-    const size_t b_stride = t->b_stride;
-    const size_t c_stride = t->c_stride;
+    if (!load_c) {
+        AMX_ZERO_Z();
+    } else if (LIKELY(full)) {
+        for (size_t r = 0; r < AMX_TILE; ++r) AMX_LDZ(C + r * c_stride, r * 4);
+    } else {
+        for (size_t r = 0; r < AMX_TILE; ++r) {
+            if (r < mr) memcpy(row, C + r * c_stride, nr * sizeof(float));
+            else memset(row, 0, nr * sizeof(float));
+            AMX_LDZ(row, r * 4);
+        }
+    }
     
-    AMX_SET();
+    microkernel_accumulate(A, B, K, b_stride);
     
-    // Process assigned row tiles
-    for (size_t i = t->i_start; i < t->i_end; i += AMX_TILE) {
-        const size_t i_end = (i + AMX_TILE <= t->i_end) ? i + AMX_TILE : t->i_end;
-        
-        // Pack this row panel of A once (16 rows x K cols -> column-major)
-        pack_a_panel(A, a_panel, i, i_end, K, a_stride);
+    if (LIKELY(full)) {
+        for (size_t r = 0; r < AMX_TILE; ++r) AMX_STZ(C + r * c_stride, r * 4);
+    } else {
+        for (size_t r = 0; r < mr; ++r) {
+            AMX_STZ(row, r * 4);
+            memcpy(C + r * c_stride, row, nr * sizeof(float));
+        }
+    }
+}
+
+// Portable tile kernel with the microkernel_16x16_acc contract. Four rows of
+// accumulators at a time stay in vector registers; the lane loop vectorizes.
+ALWAYS_INLINE static void tile_16x16_generic(
+    const float *RESTRICT A,
+    const float *RESTRICT B,
+    float *RESTRICT C,
+    size_t K,
+    size_t b_stride,
+    size_t c_stride,
+    size_t mr,
+    size_t nr,
+    bool load_c
+) {
+    for (size_t r0 = 0; r0 < mr; r0 += 4) {
+        float acc[4][AMX_TILE] ALIGNED(64) = {{0}};
+        for (size_t k = 0; k < K; ++k) {
+            const float *RESTRICT a = A + k * AMX_TILE + r0;
+            const float *RESTRICT b = B + k * b_stride;
+            for (size_t r = 0; r < 4; ++r) {
+                for (size_t t = 0; t < AMX_TILE; ++t) acc[r][t] += a[r] * b[t];
+            }
+        }
         
-        // Process all column tiles
-        for (size_t j = 0; j < N; j += AMX_TILE) {
-            const size_t j_end = (j + AMX_TILE <= N) ? j + AMX_TILE : N;
-            float *RESTRICT c_tile = C + i * c_stride + j;
-            const float *RESTRICT b_tile = B + j;
-            
-            if (LIKELY(i_end - i == AMX_TILE && j_end - j == AMX_TILE)) {
-                // Full 16x16 tile
-                microkernel_16x16_strided(a_panel, b_tile, c_tile, K, b_stride, c_stride);
+        const size_t rows = (r0 + 4 <= mr) ? 4 : mr - r0;
+        for (size_t r = 0; r < rows; ++r) {
+            float *RESTRICT c_row = C + (r0 + r) * c_stride;
+            if (load_c) {
+                for (size_t t = 0; t < nr; ++t) c_row[t] += acc[r][t];
             } else {
-                // Edge tile - use scalar fallback
-                const size_t mi = i_end - i;
-                const size_t nj = j_end - j;
-                
-                for (size_t ii = 0; ii < mi; ++ii) {
-                    for (size_t kk = 0; kk < K; ++kk) {
-                        float a_val = a_panel[kk * 16 + ii];
-                        const float *RESTRICT b_row = B + kk * b_stride + j;
-                        for (size_t jj = 0; jj < nj; ++jj) {
-                            c_tile[ii * c_stride + jj] += a_val * b_row[jj];
-                        }
-                    }
-                }
+                for (size_t t = 0; t < nr; ++t) c_row[t] = acc[r][t];
             }
         }
     }
-    
-    AMX_CLR();
 }
 
-HOT static void matmul_amx_parallel(
-    const AmxMatrix *RESTRICT a,
-    const AmxMatrix *RESTRICT b,
-    AmxMatrix *RESTRICT c
+static void microkernel_16x16_portable(
+    const float *RESTRICT A, const float *RESTRICT B, float *RESTRICT C,
+    size_t K, size_t b_stride, size_t c_stride, size_t mr, size_t nr, bool load_c
 ) {
-    const size_t M = a->rows;
-    const size_t K = a->cols;
-    const size_t N = b->cols;
-    
-    // Zero output
-    memset(c->data, 0, M * c->stride * sizeof(float));
-    
-    // Determine thread count
-    const size_t m_tiles = (M + AMX_TILE - 1) / AMX_TILE;
-    int num_threads = (int)m_tiles;
-    if (num_threads > g_num_cores) num_threads = g_num_cores;
-    if (num_threads < 1) num_threads = 1;
-    
-    // For small matrices, single-thread is faster (no dispatch overhead)
-    if (M <= 64 || num_threads == 1) {
-        // Allocate panel buffer
-        float *a_panel = alloc_aligned(K * 16 * sizeof(float));
-        if (!a_panel) { 
-            matmul_naive(a, b, c); 
-            return; 
-        }
-        
-        MatmulTask task = {
-            .A = a->data, .B = b->data, .C = c->data,
-            .a_panel = a_panel,
-            .M = M, .K = K, .N = N,
-            .a_stride = a->stride, .b_stride = b->stride, .c_stride = c->stride,
-            .i_start = 0, .i_end = M
-        };
-        matmul_thread_func(&task);
-        free(a_panel);
-        return;
+    tile_16x16_generic(A, B, C, K, b_stride, c_stride, mr, nr, load_c);
+}
+
+#if AMX_X86
+__attribute__((target("avx2,fma")))
+static void microkernel_16x16_avx2(
+    const float *RESTRICT A, const float *RESTRICT B, float *RESTRICT C,
+    size_t K, size_t b_stride, size_t c_stride, size_t mr, size_t nr, bool load_c
+) {
+    tile_16x16_generic(A, B, C, K, b_stride, c_stride, mr, nr, load_c);
+}
+#endif
+
+typedef void (*TileKernel)(const float *A, const float *B, float *C,
+                           size_t K, size_t b_stride, size_t c_stride,
+                           size_t mr, size_t nr, bool load_c);
+
+// Best tile kernel for this machine; the AMX one needs AMX_SET() on the calling thread
+static TileKernel tile_kernel(bool use_amx) {
+    if (use_amx) return microkernel_16x16_acc;
+#if AMX_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return microkernel_16x16_avx2;
+#endif
+    return microkernel_16x16_portable;
+}
+
+// ============================================================================
+// SGEMM Engine
+// ----------------------------------------------------------------------------
+// C = alpha * op(A) * op(B) + beta * C on strided buffers. Transposes are
+// absorbed into packing: an A panel gathers 16 rows of op(A) per k (a
+// contiguous copy when A is transposed); B is read in place when it is not
+// transposed and the tile is full, otherwise one KC x 16 tile is packed and
+// reused by every A panel of the block. alpha is folded into the A panels,
+// beta is applied once per output block. No transposed copy is ever made.
+// An optional epilogue sees each 16x16 output tile right after its last K
+// block, while the tile is still in L1. A triangular C skips every 16x16
+// tile lying wholly on the other side of the diagonal.
+// ============================================================================
+
+#define SGEMM_MC 256
+#define SGEMM_KC 256
+
+// Called on each finished region of C: rows [i0, i1), columns [j0, j1)
+typedef void (*SgemmEpilogue)(const void *ctx, size_t i0, size_t i1, size_t j0, size_t j1);
+
+// Replaces reading A: rows i0..i0+rows of op(A), columns p0..p0+kc, into a
+// 16-row column panel with rows past `rows` zeroed
+typedef void (*SgemmPackA)(const void *ctx, float *panel, size_t i0, size_t rows, size_t p0, size_t kc);
+
+// Which 16x16 tiles of C are computed; tiles straddling the diagonal are done whole
+typedef enum {
+    SGEMM_FULL = 0,
+    SGEMM_LOWER,                // Tiles with any element on or below the diagonal
+    SGEMM_UPPER,                // Tiles with any element on or above the diagonal
+} SgemmTriangle;
+
+typedef struct {
+    const float *A;
+    size_t lda;
+    bool trans_a;
+    const float *B;
+    size_t ldb;
+    bool trans_b;
+    float *C;
+    size_t ldc;
+    size_t M, N, K;
+    float alpha;
+    float beta;
+    SgemmEpilogue epilogue;     // Optional
+    const void *epilogue_ctx;
+    SgemmPackA pack_a;          // Optional; A is not read when set
+    const void *pack_a_ctx;
+    bool serial;                // Stay on the calling thread, e.g. inside a parallel_for task
+    bool whole_rows;            // Each task spans all N columns, so the epilogue call for
+                                // the last column tile sees finished rows
+    SgemmTriangle tri;
+} Sgemm;
+
+// Clip [j0, j1) to the columns computed in the 16-row tile starting at row r
+// (r and j0 on tile boundaries)
+ALWAYS_INLINE static void sgemm_tile_cols(const Sgemm *g, size_t r, size_t *j0, size_t *j1) {
+    if (g->tri == SGEMM_LOWER && *j1 > r + AMX_TILE) *j1 = r + AMX_TILE;
+    if (g->tri == SGEMM_UPPER && *j0 < r) *j0 = r;
+}
+
+// op(B)[k][j]
+ALWAYS_INLINE static float sgemm_b(const Sgemm *g, size_t k, size_t j) {
+    return g->trans_b ? g->B[j * g->ldb + k] : g->B[k * g->ldb + j];
+}
+
+// Rows i0..i0+rows of op(A), columns p0..p0+kc, into a 16-row column panel
+static void sgemm_pack_a(const Sgemm *g, float *RESTRICT panel, size_t i0, size_t rows, size_t p0, size_t kc) {
+    if (g->pack_a) {
+        g->pack_a(g->pack_a_ctx, panel, i0, rows, p0, kc);
+    } else if (!g->trans_a) {
+        pack_a_panel(g->A + p0, panel, i0, i0 + rows, kc, g->lda);
+    } else {
+        for (size_t k = 0; k < kc; ++k) {
+            float *RESTRICT dst = panel + k * AMX_TILE;
+            memcpy(dst, g->A + (p0 + k) * g->lda + i0, rows * sizeof(float));
+            if (rows < AMX_TILE) memset(dst + rows, 0, (AMX_TILE - rows) * sizeof(float));
+        }
     }
-    
-    // Multi-threaded: distribute row tiles across threads
-    MatmulTask *tasks = malloc(num_threads * sizeof(MatmulTask));
-    float **a_panels = malloc(num_threads * sizeof(float *));
-    if (!tasks || !a_panels) {
-        free(tasks); free(a_panels);
-        matmul_naive(a, b, c);
-        return;
+    if (g->alpha != 1.0f) {
+        for (size_t e = 0; e < kc * AMX_TILE; ++e) panel[e] *= g->alpha;
     }
-    
-    // Allocate per-thread panel buffers
-    for (int t = 0; t < num_threads; ++t) {
-        a_panels[t] = alloc_aligned(K * 16 * sizeof(float));
-        if (!a_panels[t]) {
-            for (int i = 0; i < t; ++i) free(a_panels[i]);
-            free(a_panels); free(tasks);
-            matmul_naive(a, b, c);
-            return;
+}
+
+// Rows p0..p0+kc, columns j0..j0+nr of op(B) into a KC x 16 tile, zero padded
+static void sgemm_pack_b(const Sgemm *g, float *RESTRICT tile, size_t j0, size_t nr, size_t p0, size_t kc) {
+    if (!g->trans_b) {
+        for (size_t k = 0; k < kc; ++k) {
+            float *RESTRICT dst = tile + k * AMX_TILE;
+            memcpy(dst, g->B + (p0 + k) * g->ldb + j0, nr * sizeof(float));
+            if (nr < AMX_TILE) memset(dst + nr, 0, (AMX_TILE - nr) * sizeof(float));
+        }
+    } else {
+        for (size_t t = 0; t < AMX_TILE; ++t) {
+            const float *RESTRICT src = g->B + (j0 + t) * g->ldb + p0;
+            for (size_t k = 0; k < kc; ++k) tile[k * AMX_TILE + t] = t < nr ? src[k] : 0.0f;
+        }
+    }
+}
+
+// Scale the block by beta; beta == 0 overwrites so NaNs in C do not propagate
+static void sgemm_apply_beta(const Sgemm *g, size_t i0, size_t i1, size_t j0, size_t j1) {
+    if (g->beta == 1.0f) return;
+    for (size_t i = i0; i < i1; ++i) {
+        float *RESTRICT row = g->C + i * g->ldc;
+        size_t c0 = j0, c1 = j1;
+        sgemm_tile_cols(g, i & ~(size_t)(AMX_TILE - 1), &c0, &c1);
+        if (c0 >= c1) continue;
+        if (g->beta == 0.0f) {
+            memset(row + c0, 0, (c1 - c0) * sizeof(float));
+        } else {
+            for (size_t j = c0; j < c1; ++j) row[j] *= g->beta;
         }
     }
+}
+
+// Beta and epilogue only, per row tile, for products that contribute nothing
+static void sgemm_no_product(const Sgemm *g, size_t i0, size_t i1, size_t j0, size_t j1) {
+    for (size_t i = i0; i < i1; i += AMX_TILE) {
+        const size_t ie = (i + AMX_TILE <= i1) ? i + AMX_TILE : i1;
+        size_t c0 = j0, c1 = j1;
+        sgemm_tile_cols(g, i, &c0, &c1);
+        if (c0 >= c1) continue;
+        sgemm_apply_beta(g, i, ie, c0, c1);
+        if (g->epilogue) g->epilogue(g->epilogue_ctx, i, ie, c0, c1);
+    }
+}
+
+// Used when the block buffers cannot be allocated; packs A through a 16x16 stack panel
+COLD static void sgemm_block_naive(const Sgemm *g, size_t i0, size_t i1, size_t j0, size_t j1) {
+    float panel[AMX_TILE * AMX_TILE] ALIGNED(64);
+    sgemm_apply_beta(g, i0, i1, j0, j1);
+    for (size_t i = i0; i < i1; i += AMX_TILE) {
+        const size_t rows = (i + AMX_TILE <= i1) ? AMX_TILE : i1 - i;
+        size_t c0 = j0, c1 = j1;
+        sgemm_tile_cols(g, i, &c0, &c1);
+        if (c0 >= c1) continue;
+        for (size_t p = 0; p < g->K; p += AMX_TILE) {
+            const size_t kc = (p + AMX_TILE <= g->K) ? AMX_TILE : g->K - p;
+            sgemm_pack_a(g, panel, i, rows, p, kc);
+            for (size_t r = 0; r < rows; ++r) {
+                float *RESTRICT c_row = g->C + (i + r) * g->ldc;
+                for (size_t k = 0; k < kc; ++k) {
+                    const float a = panel[k * AMX_TILE + r];
+                    for (size_t j = c0; j < c1; ++j) c_row[j] += a * sgemm_b(g, p + k, j);
+                }
+            }
+        }
+        if (g->epilogue) g->epilogue(g->epilogue_ctx, i, i + rows, c0, c1);
+    }
+}
+
+HOT static void sgemm_block(
+    const Sgemm *RESTRICT g,
+    size_t i0, size_t i1,
+    size_t j0, size_t j1,
+    float *RESTRICT a_block,    // SGEMM_MC x SGEMM_KC, as 16-row column panels
+    float *RESTRICT b_tile,     // SGEMM_KC x 16
+    bool use_amx
+) {
+    const TileKernel kernel = tile_kernel(use_amx);
     
-    // Distribute work
-    size_t rows_per_thread = ((M + AMX_TILE - 1) / AMX_TILE / num_threads) * AMX_TILE;
-    if (rows_per_thread < AMX_TILE) rows_per_thread = AMX_TILE;
+    // With beta != 0 the first K block accumulates onto the pre-scaled C
+    const bool keep_c = g->beta != 0.0f;
+    if (keep_c) sgemm_apply_beta(g, i0, i1, j0, j1);
+    const SgemmEpilogue epilogue = g->epilogue;
     
-    for (int t = 0; t < num_threads; ++t) {
-        tasks[t] = (MatmulTask){
-            .A = a->data, .B = b->data, .C = c->data,
-            .a_panel = a_panels[t],
-            .M = M, .K = K, .N = N,
-            .a_stride = a->stride, .b_stride = b->stride, .c_stride = c->stride,
-            .i_start = t * rows_per_thread,
-            .i_end = (t == num_threads - 1) ? M : (t + 1) * rows_per_thread
-        };
-        if (tasks[t].i_start >= M) tasks[t].i_start = tasks[t].i_end = M;
-    }
+    if (use_amx) AMX_SET();
     
-    // Dispatch using GCD
-    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_USER_INTERACTIVE, 0);
-    dispatch_apply(num_threads, queue, ^(size_t t) {
-        if (tasks[t].i_start < tasks[t].i_end) {
-            matmul_thread_func(&tasks[t]);
+    for (size_t ic = i0; ic < i1; ic += SGEMM_MC) {
+        const size_t mc = (ic + SGEMM_MC <= i1) ? SGEMM_MC : i1 - ic;
+        
+        for (size_t pc = 0; pc < g->K; pc += SGEMM_KC) {
+            const size_t kc = (pc + SGEMM_KC <= g->K) ? SGEMM_KC : g->K - pc;
+            const bool last_k = pc + kc == g->K;
+            
+            for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                const size_t rows = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                sgemm_pack_a(g, a_block + ii * kc, ic + ii, rows, pc, kc);
+            }
+            
+            for (size_t j = j0; j < j1; j += AMX_TILE) {
+                const size_t nr = (j + AMX_TILE <= j1) ? AMX_TILE : j1 - j;
+                
+                // Row tiles of this block that compute column tile j
+                size_t ii0 = 0, ii1 = mc;
+                if (g->tri == SGEMM_LOWER && j > ic) ii0 = j - ic;
+                if (g->tri == SGEMM_UPPER) ii1 = (j < ic) ? 0 : (j - ic + AMX_TILE < mc ? j - ic + AMX_TILE : mc);
+                if (ii0 >= ii1) continue;
+                
+                const float *RESTRICT b_ptr = b_tile;
+                size_t b_stride = AMX_TILE;
+                if (!g->trans_b && nr == AMX_TILE) {
+                    b_ptr = g->B + pc * g->ldb + j;
+                    b_stride = g->ldb;
+                } else {
+                    sgemm_pack_b(g, b_tile, j, nr, pc, kc);
+                }
+                
+                for (size_t ii = ii0; ii < ii1; ii += AMX_TILE) {
+                    const size_t mr = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                    kernel(a_block + ii * kc, b_ptr, g->C + (ic + ii) * g->ldc + j,
+                           kc, b_stride, g->ldc, mr, nr, keep_c || pc > 0);
+                    if (epilogue && last_k) epilogue(g->epilogue_ctx, ic + ii, ic + ii + mr, j, j + nr);
+                }
+            }
         }
-    });
+    }
     
-    // Cleanup
-    for (int t = 0; t < num_threads; ++t) free(a_panels[t]);
-    free(a_panels);
-    free(tasks);
+    if (use_amx) AMX_CLR();
 }
 
-// ============================================================================
-// Public API
-// ============================================================================
+typedef struct {
+    const Sgemm *g;
+    size_t rows_per_task, cols_per_task;
+    size_t col_parts;
+    bool use_amx;
+} SgemmJob;
 
-AmxMatrix *amx_matrix_matmul(const AmxMatrix *a, const AmxMatrix *b) {
-    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+static void sgemm_task_body(void *ctx, size_t t) {
+    const SgemmJob *job = (const SgemmJob *)ctx;
+    const Sgemm *g = job->g;
+    size_t i0 = (t / job->col_parts) * job->rows_per_task;
+    size_t j0 = (t % job->col_parts) * job->cols_per_task;
+    if (i0 >= g->M || j0 >= g->N) return;
+    size_t i1 = (i0 + job->rows_per_task < g->M) ? i0 + job->rows_per_task : g->M;
+    size_t j1 = (j0 + job->cols_per_task < g->N) ? j0 + job->cols_per_task : g->N;
     
-    AmxMatrix *c = amx_matrix_zeros(a->rows, b->cols);
-    if (UNLIKELY(!c)) return NULL;
+    // Trim a triangular C's region to the tiles it computes
+    if (g->tri == SGEMM_LOWER) {
+        if (j1 > round_up(i1, AMX_TILE)) j1 = round_up(i1, AMX_TILE);
+        if (i0 < j0) i0 = j0;
+    } else if (g->tri == SGEMM_UPPER) {
+        if (i1 > round_up(j1, AMX_TILE)) i1 = round_up(j1, AMX_TILE);
+        if (j0 < i0) j0 = i0;
+    }
+    if (i0 >= i1 || j0 >= j1) return;
     
-    if (LIKELY(amx_is_available() && a->rows >= AMX_TILE && b->cols >= AMX_TILE)) {
-        matmul_amx_parallel(a, b, c);
+    float *a_block = alloc_aligned(SGEMM_MC * SGEMM_KC * sizeof(float));
+    float *b_tile = alloc_aligned(SGEMM_KC * AMX_TILE * sizeof(float));
+    if (LIKELY(a_block && b_tile)) {
+        sgemm_block(g, i0, i1, j0, j1, a_block, b_tile, job->use_amx);
     } else {
-        matmul_naive(a, b, c);
+        sgemm_block_naive(g, i0, i1, j0, j1);
     }
-    
-    return c;
+    free(a_block);
+    free(b_tile);
 }
 
-AmxMatrix *amx_matrix_transpose(const AmxMatrix *m) {
-    if (UNLIKELY(!m)) return NULL;
-    
-    AmxMatrix *r = amx_matrix_zeros(m->cols, m->rows);
-    if (UNLIKELY(!r)) return NULL;
+static void sgemm_run(const Sgemm *g) {
+    if (g->M == 0 || g->N == 0) return;
+    if (g->K == 0 || g->alpha == 0.0f) {
+        if (g->tri == SGEMM_FULL) {
+            sgemm_apply_beta(g, 0, g->M, 0, g->N);
+            if (g->epilogue) g->epilogue(g->epilogue_ctx, 0, g->M, 0, g->N);
+        } else {
+            sgemm_no_product(g, 0, g->M, 0, g->N);
+        }
+        return;
+    }
     
-    const float *RESTRICT s = m->data;
-    float *RESTRICT d = r->data;
-    const size_t ss = m->stride, ds = r->stride;
+    // Whole 16-row tiles per task; split columns too when rows run out. A
+    // triangle's tasks differ in size, so it is cut finer for the pool to balance.
+    const size_t workers = (size_t)num_workers() * (g->tri == SGEMM_FULL ? 1 : 4);
+    const size_t m_tiles = (g->M + AMX_TILE - 1) / AMX_TILE;
+    const size_t n_tiles = (g->N + AMX_TILE - 1) / AMX_TILE;
+    size_t row_parts = m_tiles < workers ? m_tiles : workers;
+    size_t col_parts = workers / row_parts;
+    if (col_parts > n_tiles) col_parts = n_tiles;
+    if (col_parts < 1 || g->whole_rows) col_parts = 1;
+    if (g->serial || (double)g->M * g->N * g->K < 64.0 * 64.0 * 64.0) row_parts = col_parts = 1;
     
-    for (size_t i = 0; i < m->rows; ++i) {
-        for (size_t j = 0; j < m->cols; ++j) {
-            d[j * ds + i] = s[i * ss + j];
-        }
+    SgemmJob job = {
+        .g = g,
+        .rows_per_task = ((m_tiles + row_parts - 1) / row_parts) * AMX_TILE,
+        .cols_per_task = ((n_tiles + col_parts - 1) / col_parts) * AMX_TILE,
+        .col_parts = col_parts,
+        .use_amx = amx_is_available()
+    };
+    parallel_for(row_parts * col_parts, &job, sgemm_task_body);
+}
+
+// ============================================================================
+// Transpose
+// ----------------------------------------------------------------------------
+// Cache-oblivious recursion halves the longer side until a block fits in L1
+// for both source and destination, then 16x16 blocks are moved as 4x4
+// register transposes. Large matrices are split into column strips (rows of
+// the destination) so threads never share output cache lines.
+// ============================================================================
+
+#define TRANSPOSE_LEAF 64
+#define TRANSPOSE_PARALLEL_MIN (512 * 512)
+
+// dst[c][r] = src[r][c] for a 4x4 block
+ALWAYS_INLINE static void transpose_4x4(const float *RESTRICT src, size_t ss, float *RESTRICT dst, size_t ds) {
+#if defined(__aarch64__)
+    const float32x4_t r0 = vld1q_f32(src), r1 = vld1q_f32(src + ss);
+    const float32x4_t r2 = vld1q_f32(src + 2 * ss), r3 = vld1q_f32(src + 3 * ss);
+    const float64x2_t t0 = vreinterpretq_f64_f32(vtrn1q_f32(r0, r1));
+    const float64x2_t t1 = vreinterpretq_f64_f32(vtrn2q_f32(r0, r1));
+    const float64x2_t t2 = vreinterpretq_f64_f32(vtrn1q_f32(r2, r3));
+    const float64x2_t t3 = vreinterpretq_f64_f32(vtrn2q_f32(r2, r3));
+    vst1q_f32(dst, vreinterpretq_f32_f64(vtrn1q_f64(t0, t2)));
+    vst1q_f32(dst + ds, vreinterpretq_f32_f64(vtrn1q_f64(t1, t3)));
+    vst1q_f32(dst + 2 * ds, vreinterpretq_f32_f64(vtrn2q_f64(t0, t2)));
+    vst1q_f32(dst + 3 * ds, vreinterpretq_f32_f64(vtrn2q_f64(t1, t3)));
+#elif AMX_X86
+    __m128 r0 = _mm_loadu_ps(src), r1 = _mm_loadu_ps(src + ss);
+    __m128 r2 = _mm_loadu_ps(src + 2 * ss), r3 = _mm_loadu_ps(src + 3 * ss);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + ds, r1);
+    _mm_storeu_ps(dst + 2 * ds, r2);
+    _mm_storeu_ps(dst + 3 * ds, r3);
+#else
+    for (size_t r = 0; r < 4; ++r) {
+        for (size_t c = 0; c < 4; ++c) dst[c * ds + r] = src[r * ss + c];
     }
-    return r;
+#endif
 }
 
-AmxMatrix *amx_matrix_add(const AmxMatrix *a, const AmxMatrix *b) {
-    if (UNLIKELY(!a || !b || a->rows != b->rows || a->cols != b->cols)) return NULL;
-    
-    AmxMatrix *c = amx_matrix_zeros(a->rows, a->cols);
-    if (UNLIKELY(!c)) return NULL;
-    
-    const float *RESTRICT ap = a->data, *RESTRICT bp = b->data;
-    float *RESTRICT cp = c->data;
-    const size_t as = a->stride, bs = b->stride, cs = c->stride;
-    
-    for (size_t i = 0; i < a->rows; ++i) {
-        for (size_t j = 0; j < a->cols; ++j) {
-            cp[i * cs + j] = ap[i * as + j] + bp[i * bs + j];
+HOT static void transpose_leaf(
+    const float *RESTRICT src, size_t ss,
+    float *RESTRICT dst, size_t ds,
+    size_t rows, size_t cols
+) {
+    for (size_t ib = 0; ib < rows; ib += AMX_TILE) {
+        const size_t ie = (ib + AMX_TILE <= rows) ? ib + AMX_TILE : rows;
+        for (size_t jb = 0; jb < cols; jb += AMX_TILE) {
+            const size_t je = (jb + AMX_TILE <= cols) ? jb + AMX_TILE : cols;
+            
+            size_t i = ib;
+            for (; i + 4 <= ie; i += 4) {
+                size_t j = jb;
+                for (; j + 4 <= je; j += 4) {
+                    transpose_4x4(src + i * ss + j, ss, dst + j * ds + i, ds);
+                }
+                for (; j < je; ++j) {
+                    for (size_t r = 0; r < 4; ++r) dst[j * ds + i + r] = src[(i + r) * ss + j];
+                }
+            }
+            for (; i < ie; ++i) {
+                for (size_t j = jb; j < je; ++j) dst[j * ds + i] = src[i * ss + j];
+            }
         }
     }
-    return c;
 }
 
-AmxMatrix *amx_matrix_sub(const AmxMatrix *a, const AmxMatrix *b) {
-    if (UNLIKELY(!a || !b || a->rows != b->rows || a->cols != b->cols)) return NULL;
-    
-    AmxMatrix *c = amx_matrix_zeros(a->rows, a->cols);
-    if (UNLIKELY(!c)) return NULL;
-    
-    const float *RESTRICT ap = a->data, *RESTRICT bp = b->data;
-    float *RESTRICT cp = c->data;
-    const size_t as = a->stride, bs = b->stride, cs = c->stride;
+static void transpose_rec(
+    const float *RESTRICT src, size_t ss,
+    float *RESTRICT dst, size_t ds,
+    size_t rows, size_t cols
+) {
+    if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF) {
+        transpose_leaf(src, ss, dst, ds, rows, cols);
+        return;
+    }
     
-    for (size_t i = 0; i < a->rows; ++i) {
-        for (size_t j = 0; j < a->cols; ++j) {
-            cp[i * cs + j] = ap[i * as + j] - bp[i * bs + j];
-        }
+    // Split the longer side on a 16-element boundary
+    if (rows >= cols) {
+        const size_t h = round_up(rows / 2, AMX_TILE);
+        transpose_rec(src, ss, dst, ds, h, cols);
+        transpose_rec(src + h * ss, ss, dst + h, ds, rows - h, cols);
+    } else {
+        const size_t h = round_up(cols / 2, AMX_TILE);
+        transpose_rec(src, ss, dst, ds, rows, h);
+        transpose_rec(src + h, ss, dst + h * ds, ds, rows, cols - h);
     }
-    return c;
 }
 
-AmxMatrix *amx_matrix_scale(const AmxMatrix *m, float s) {
-    if (UNLIKELY(!m)) return NULL;
-    
-    AmxMatrix *r = amx_matrix_zeros(m->rows, m->cols);
-    if (UNLIKELY(!r)) return NULL;
-    
-    const float *RESTRICT sp = m->data;
-    float *RESTRICT dp = r->data;
-    const size_t ss = m->stride, ds = r->stride;
+typedef struct {
+    const float *src;
+    float *dst;
+    size_t ss, ds;
+    size_t rows, cols;
+    size_t strip;            // Source columns per task, multiple of 16
+} TransposeTask;
+
+static void transpose_task_body(void *ctx, size_t t) {
+    const TransposeTask *task = (const TransposeTask *)ctx;
+    const size_t j0 = t * task->strip;
+    if (j0 >= task->cols) return;
+    const size_t n = (j0 + task->strip <= task->cols) ? task->strip : task->cols - j0;
+    transpose_rec(task->src + j0, task->ss, task->dst + j0 * task->ds, task->ds, task->rows, n);
+}
+
+void amx_transpose_f32(
+    const float *src, size_t src_stride,
+    float *dst, size_t dst_stride,
+    size_t rows, size_t cols
+) {
+    if (UNLIKELY(!src || !dst || !rows || !cols)) return;
     
-    for (size_t i = 0; i < m->rows; ++i) {
-        for (size_t j = 0; j < m->cols; ++j) {
-            dp[i * ds + j] = sp[i * ss + j] * s;
-        }
+    const size_t workers = (size_t)num_workers();
+    if (rows * cols < TRANSPOSE_PARALLEL_MIN || workers == 1) {
+        transpose_rec(src, src_stride, dst, dst_stride, rows, cols);
+        return;
     }
-    return r;
+    
+    // A few strips per worker balance uneven leaves
+    const size_t tasks = 4 * workers;
+    TransposeTask task = {
+        .src = src, .dst = dst, .ss = src_stride, .ds = dst_stride,
+        .rows = rows, .cols = cols,
+        .strip = round_up((cols + tasks - 1) / tasks, AMX_TILE)
+    };
+    parallel_for((cols + task.strip - 1) / task.strip, &task, transpose_task_body);
+}
+
+// ============================================================================
+// Elementwise
+// ----------------------------------------------------------------------------
+// Matrices with equal column counts share a stride, so a run of rows is one
+// contiguous span at the same offset in every operand and is streamed as
+// 16-float vectors with no tail. Each vector is read from every operand
+// before the result is stored, so the output may alias an input.
+// ============================================================================
+
+#define EW_PARALLEL_MIN (256 * 1024)     // Floats; below this one thread is faster
+
+// One padded-row chunk; rows are 64-byte aligned so plain dereferences are safe
+typedef float v16f __attribute__((vector_size(64), may_alias));
+#define EW_VEC(p) (*(v16f *)(p))
+
+typedef struct {
+    float *out;
+    const float *src[AMX_LINCOMB_MAX];
+    float coeff[AMX_LINCOMB_MAX];
+    size_t n;
+    float bias;
+    bool accumulate;            // out += ... instead of out = ...
+    size_t rows, cols, stride;
+    size_t rows_per_task;
+} Lincomb;
+
+// Elements [k0, k1) of the flat padded storage, k0 and k1 multiples of 16
+HOT static void lincomb_span(const Lincomb *l, size_t k0, size_t k1) {
+    const v16f bias = (v16f){0} + l->bias;
+    float *o = l->out;
+    
+    if (l->accumulate) {
+        for (size_t k = k0; k < k1; k += AMX_TILE) {
+            v16f acc = EW_VEC(o + k) + bias;
+            for (size_t s = 0; s < l->n; ++s) acc += l->coeff[s] * EW_VEC(l->src[s] + k);
+            EW_VEC(o + k) = acc;
+        }
+        return;
+    }
+    
+    switch (l->n) {
+    case 0:
+        for (size_t k = k0; k < k1; k += AMX_TILE) EW_VEC(o + k) = bias;
+        break;
+    case 1: {
+        const float *x = l->src[0];
+        const float a = l->coeff[0];
+        for (size_t k = k0; k < k1; k += AMX_TILE) EW_VEC(o + k) = a * EW_VEC(x + k) + bias;
+        break;
+    }
+    case 2: {
+        const float *x = l->src[0], *y = l->src[1];
+        const float a = l->coeff[0], b = l->coeff[1];
+        for (size_t k = k0; k < k1; k += AMX_TILE) {
+            EW_VEC(o + k) = a * EW_VEC(x + k) + b * EW_VEC(y + k) + bias;
+        }
+        break;
+    }
+    default:
+        for (size_t k = k0; k < k1; k += AMX_TILE) {
+            v16f acc = bias;
+            for (size_t s = 0; s < l->n; ++s) acc += l->coeff[s] * EW_VEC(l->src[s] + k);
+            EW_VEC(o + k) = acc;
+        }
+        break;
+    }
+}
+
+// Zero the padding lanes of rows [i0, i1)
+static void lincomb_clear_padding(const Lincomb *l, size_t i0, size_t i1) {
+    if (l->cols == l->stride) return;
+    for (size_t i = i0; i < i1; ++i) {
+        memset(l->out + i * l->stride + l->cols, 0, (l->stride - l->cols) * sizeof(float));
+    }
+}
+
+// Whole rows [i0, i1) are one contiguous span. Zero padding maps to zero
+// only for finite coefficients and no bias, so it is always cleared after
+static void lincomb_rows(const Lincomb *l, size_t i0, size_t i1) {
+    lincomb_span(l, i0 * l->stride, i1 * l->stride);
+    lincomb_clear_padding(l, i0, i1);
+}
+
+// SgemmEpilogue form; j0 is tile aligned and the last tile runs into the
+// padding, which GEMM leaves untouched and is cleared here
+static void lincomb_epilogue(const void *ctx, size_t i0, size_t i1, size_t j0, size_t j1) {
+    const Lincomb *l = (const Lincomb *)ctx;
+    const size_t width = round_up(j1 - j0, AMX_TILE);
+    for (size_t i = i0; i < i1; ++i) lincomb_span(l, i * l->stride + j0, i * l->stride + j0 + width);
+    if (j1 == l->cols) lincomb_clear_padding(l, i0, i1);
+}
+
+static void lincomb_task_body(void *ctx, size_t t) {
+    const Lincomb *l = (const Lincomb *)ctx;
+    const size_t i0 = t * l->rows_per_task;
+    if (i0 >= l->rows) return;
+    const size_t i1 = (i0 + l->rows_per_task <= l->rows) ? i0 + l->rows_per_task : l->rows;
+    lincomb_rows(l, i0, i1);
+}
+
+static void lincomb_run(Lincomb *l) {
+    const size_t workers = (size_t)num_workers();
+    if (l->rows * l->stride < EW_PARALLEL_MIN || workers == 1 || l->rows == 1) {
+        lincomb_rows(l, 0, l->rows);
+        return;
+    }
+    
+    l->rows_per_task = (l->rows + workers - 1) / workers;
+    parallel_for((l->rows + l->rows_per_task - 1) / l->rows_per_task, l, lincomb_task_body);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+AmxMatrix *amx_matrix_matmul(const AmxMatrix *a, const AmxMatrix *b) {
+    return amx_matrix_matmul_t(a, AMX_NO_TRANS, b, AMX_NO_TRANS);
+}
+
+// Logical shape of op(m)
+ALWAYS_INLINE static size_t op_rows(const AmxMatrix *m, AmxTranspose t) { return t == AMX_TRANS ? m->cols : m->rows; }
+ALWAYS_INLINE static size_t op_cols(const AmxMatrix *m, AmxTranspose t) { return t == AMX_TRANS ? m->rows : m->cols; }
+
+AmxMatrix *amx_matrix_matmul_t(const AmxMatrix *a, AmxTranspose trans_a, const AmxMatrix *b, AmxTranspose trans_b) {
+    if (UNLIKELY(!a || !b || op_cols(a, trans_a) != op_rows(b, trans_b))) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(op_rows(a, trans_a), op_cols(b, trans_b));
+    if (UNLIKELY(!c)) return NULL;
+    
+    amx_matrix_gemm(trans_a, trans_b, 1.0f, a, b, 0.0f, c);
+    return c;
+}
+
+bool amx_matrix_gemm(
+    AmxTranspose trans_a, AmxTranspose trans_b,
+    float alpha, const AmxMatrix *a, const AmxMatrix *b,
+    float beta, AmxMatrix *c
+) {
+    if (UNLIKELY(!a || !b || !c)) return false;
+    if (UNLIKELY(op_cols(a, trans_a) != op_rows(b, trans_b) ||
+                 c->rows != op_rows(a, trans_a) || c->cols != op_cols(b, trans_b))) return false;
+    
+    const Sgemm g = {
+        .A = a->data, .lda = a->stride, .trans_a = trans_a == AMX_TRANS,
+        .B = b->data, .ldb = b->stride, .trans_b = trans_b == AMX_TRANS,
+        .C = c->data, .ldc = c->stride,
+        .M = c->rows, .N = c->cols, .K = op_cols(a, trans_a),
+        .alpha = alpha, .beta = beta
+    };
+    sgemm_run(&g);
+    return true;
+}
+
+AmxMatrix *amx_matrix_transpose(const AmxMatrix *m) {
+    if (UNLIKELY(!m)) return NULL;
+    
+    AmxMatrix *r = amx_matrix_zeros(m->cols, m->rows);
+    if (UNLIKELY(!r)) return NULL;
+    
+    amx_transpose_f32(m->data, m->stride, r->data, r->stride, m->rows, m->cols);
+    return r;
+}
+
+bool amx_matrix_lincomb(
+    AmxMatrix *out, size_t n, const float *coeffs,
+    const AmxMatrix *const *mats, float bias
+) {
+    if (UNLIKELY(!out || n > AMX_LINCOMB_MAX || (n && (!coeffs || !mats)))) return false;
+    
+    Lincomb l = {
+        .out = out->data, .n = n, .bias = bias,
+        .rows = out->rows, .cols = out->cols, .stride = out->stride
+    };
+    for (size_t s = 0; s < n; ++s) {
+        const AmxMatrix *m = mats[s];
+        if (UNLIKELY(!m || m->rows != out->rows || m->cols != out->cols)) return false;
+        l.src[s] = m->data;
+        l.coeff[s] = coeffs[s];
+    }
+    lincomb_run(&l);
+    return true;
+}
+
+// Fresh result of a lincomb; every lane is written so no zeroing is needed
+static AmxMatrix *lincomb_new(size_t n, const float *coeffs, const AmxMatrix *const *mats) {
+    AmxMatrix *c = matrix_alloc(mats[0]->rows, mats[0]->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    if (UNLIKELY(!amx_matrix_lincomb(c, n, coeffs, mats, 0.0f))) {
+        amx_matrix_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+AmxMatrix *amx_matrix_add(const AmxMatrix *a, const AmxMatrix *b) {
+    if (UNLIKELY(!a || !b || a->rows != b->rows || a->cols != b->cols)) return NULL;
+    return lincomb_new(2, (const float[]){ 1.0f, 1.0f }, (const AmxMatrix *const[]){ a, b });
+}
+
+AmxMatrix *amx_matrix_sub(const AmxMatrix *a, const AmxMatrix *b) {
+    if (UNLIKELY(!a || !b || a->rows != b->rows || a->cols != b->cols)) return NULL;
+    return lincomb_new(2, (const float[]){ 1.0f, -1.0f }, (const AmxMatrix *const[]){ a, b });
+}
+
+AmxMatrix *amx_matrix_scale(const AmxMatrix *m, float s) {
+    if (UNLIKELY(!m)) return NULL;
+    return lincomb_new(1, &s, &m);
+}
+
+bool amx_matrix_add_inplace(AmxMatrix *a, const AmxMatrix *b) {
+    return amx_matrix_axpy(1.0f, b, a);
+}
+
+bool amx_matrix_axpy(float alpha, const AmxMatrix *x, AmxMatrix *y) {
+    if (UNLIKELY(!x || !y)) return false;
+    return amx_matrix_lincomb(y, 2, (const float[]){ 1.0f, alpha }, (const AmxMatrix *const[]){ y, x }, 0.0f);
+}
+
+void amx_matrix_scale_inplace(AmxMatrix *m, float s) {
+    if (UNLIKELY(!m)) return;
+    const AmxMatrix *src = m;
+    amx_matrix_lincomb(m, 1, &s, &src, 0.0f);
+}
+
+// ============================================================================
+// Deferred Expressions
+// ----------------------------------------------------------------------------
+// Builders only record a DAG. Evaluation first counts consumers of every
+// node, then computes the root: linear chains whose intermediates have a
+// single consumer are flattened into one lincomb of terminal terms (inputs,
+// matmuls, shared nodes). If a terminal matmul is used only there it is the
+// pass itself: one term may become GEMM's beta * C and the rest run in the
+// tile epilogue. Otherwise the terms stream through lincomb once. A term
+// buffer whose last consumer is the current node becomes its output, and
+// dead intermediates go to a small pool for later nodes of the same shape.
+// ============================================================================
+
+#define EXPR_POOL 8
+
+typedef enum { EXPR_INPUT, EXPR_MATMUL, EXPR_LINCOMB } ExprKind;
+
+struct AmxExpr {
+    ExprKind kind;
+    size_t refs;
+    size_t rows, cols;
+    const AmxMatrix *input;
+    AmxExpr *args[AMX_LINCOMB_MAX];     // EXPR_MATMUL uses args[0] * args[1]
+    float coeff[AMX_LINCOMB_MAX];
+    size_t n;
+    float bias;
+    
+    // Evaluation state, reset after every amx_expr_eval
+    size_t uses;                        // Unconsumed edges into this node
+    AmxMatrix *value;
+    bool owned;                         // value was allocated by the evaluator
+};
+
+typedef struct {
+    AmxExpr **visited;
+    size_t n_visited, cap_visited;
+    AmxMatrix *pool[EXPR_POOL];
+    size_t n_pool;
+    bool failed;
+} ExprEval;
+
+// Flattened sum(coeff[i] * node[i]) + bias
+typedef struct {
+    AmxExpr *node[AMX_LINCOMB_MAX];
+    float coeff[AMX_LINCOMB_MAX];
+    size_t edges[AMX_LINCOMB_MAX];      // Edges from this sum into node[i]
+    size_t n;
+    float bias;
+} ExprTerms;
+
+static AmxExpr *expr_new(ExprKind kind, size_t rows, size_t cols) {
+    AmxExpr *e = calloc(1, sizeof(AmxExpr));
+    if (UNLIKELY(!e)) return NULL;
+    e->kind = kind;
+    e->refs = 1;
+    e->rows = rows;
+    e->cols = cols;
+    return e;
+}
+
+AmxExpr *amx_expr_retain(AmxExpr *e) {
+    if (e) ++e->refs;
+    return e;
+}
+
+void amx_expr_release(AmxExpr *e) {
+    if (!e || --e->refs > 0) return;
+    for (size_t s = 0; s < e->n; ++s) amx_expr_release(e->args[s]);
+    free(e);
+}
+
+AmxExpr *amx_expr_input(const AmxMatrix *m) {
+    if (UNLIKELY(!m)) return NULL;
+    AmxExpr *e = expr_new(EXPR_INPUT, m->rows, m->cols);
+    if (LIKELY(e)) e->input = m;
+    return e;
+}
+
+AmxExpr *amx_expr_matmul(AmxExpr *a, AmxExpr *b) {
+    AmxExpr *e = NULL;
+    if (LIKELY(a && b && a->cols == b->rows)) e = expr_new(EXPR_MATMUL, a->rows, b->cols);
+    if (UNLIKELY(!e)) {
+        amx_expr_release(a);
+        amx_expr_release(b);
+        return NULL;
+    }
+    e->args[0] = a;
+    e->args[1] = b;
+    e->n = 2;
+    return e;
+}
+
+AmxExpr *amx_expr_lincomb(size_t n, const float *coeffs, AmxExpr *const *args, float bias) {
+    if (UNLIKELY(!args)) return NULL;
+    
+    bool ok = n >= 1 && n <= AMX_LINCOMB_MAX && coeffs;
+    for (size_t s = 0; ok && s < n; ++s) {
+        ok = args[s] && args[s]->rows == args[0]->rows && args[s]->cols == args[0]->cols;
+    }
+    AmxExpr *e = ok ? expr_new(EXPR_LINCOMB, args[0]->rows, args[0]->cols) : NULL;
+    if (UNLIKELY(!e)) {
+        for (size_t s = 0; s < n; ++s) amx_expr_release(args[s]);
+        return NULL;
+    }
+    
+    for (size_t s = 0; s < n; ++s) {
+        e->args[s] = args[s];
+        e->coeff[s] = coeffs[s];
+    }
+    e->n = n;
+    e->bias = bias;
+    return e;
+}
+
+AmxExpr *amx_expr_add(AmxExpr *a, AmxExpr *b) {
+    return amx_expr_lincomb(2, (const float[]){ 1.0f, 1.0f }, (AmxExpr *const[]){ a, b }, 0.0f);
+}
+
+AmxExpr *amx_expr_sub(AmxExpr *a, AmxExpr *b) {
+    return amx_expr_lincomb(2, (const float[]){ 1.0f, -1.0f }, (AmxExpr *const[]){ a, b }, 0.0f);
+}
+
+AmxExpr *amx_expr_scale(AmxExpr *a, float s) {
+    return amx_expr_lincomb(1, &s, &a, 0.0f);
+}
+
+// Count incoming edges; each node is recorded once for the final reset
+static void expr_count(ExprEval *ev, AmxExpr *e) {
+    if (e->uses++ > 0) return;
+    
+    if (ev->n_visited == ev->cap_visited) {
+        const size_t cap = ev->cap_visited ? 2 * ev->cap_visited : 16;
+        AmxExpr **v = realloc(ev->visited, cap * sizeof(AmxExpr *));
+        if (UNLIKELY(!v)) { --e->uses; ev->failed = true; return; }
+        ev->visited = v;
+        ev->cap_visited = cap;
+    }
+    ev->visited[ev->n_visited++] = e;
+    for (size_t s = 0; s < e->n; ++s) expr_count(ev, e->args[s]);
+}
+
+static AmxMatrix *expr_pool_take(ExprEval *ev, size_t rows, size_t cols) {
+    for (size_t p = 0; p < ev->n_pool; ++p) {
+        AmxMatrix *m = ev->pool[p];
+        if (m->rows == rows && m->cols == cols) {
+            ev->pool[p] = ev->pool[--ev->n_pool];
+            return m;
+        }
+    }
+    return matrix_alloc(rows, cols);
+}
+
+static void expr_pool_put(ExprEval *ev, AmxMatrix *m) {
+    if (ev->n_pool < EXPR_POOL) ev->pool[ev->n_pool++] = m;
+    else amx_matrix_free(m);
+}
+
+// Consume k edges into e; an intermediate nobody else reads is recycled
+static void expr_drop(ExprEval *ev, AmxExpr *e, size_t k) {
+    e->uses -= k;
+    if (e->uses == 0 && e->owned) {
+        expr_pool_put(ev, e->value);
+        e->value = NULL;
+        e->owned = false;
+    }
+}
+
+static bool expr_add_term(ExprTerms *t, AmxExpr *e, float c) {
+    for (size_t i = 0; i < t->n; ++i) {
+        if (t->node[i] == e) {
+            t->coeff[i] += c;
+            ++t->edges[i];
+            return true;
+        }
+    }
+    if (t->n == AMX_LINCOMB_MAX) return false;
+    t->node[t->n] = e;
+    t->coeff[t->n] = c;
+    t->edges[t->n] = 1;
+    ++t->n;
+    return true;
+}
+
+// Add c * e's operands to t, inlining unshared lincomb children only while
+// the remaining operands still fit, so the top level never overflows
+static bool expr_flatten(ExprTerms *t, const AmxExpr *e, float c) {
+    t->bias += c * e->bias;
+    for (size_t s = 0; s < e->n; ++s) {
+        AmxExpr *a = e->args[s];
+        const float ca = c * e->coeff[s];
+        if (a->kind == EXPR_LINCOMB && a->uses == 1 && !a->value) {
+            const ExprTerms saved = *t;
+            if (expr_flatten(t, a, ca) && t->n + (e->n - s - 1) <= AMX_LINCOMB_MAX) continue;
+            *t = saved;
+        }
+        if (!expr_add_term(t, a, ca)) return false;
+    }
+    return true;
+}
+
+static AmxMatrix *expr_value(ExprEval *ev, AmxExpr *e);
+
+static AmxMatrix *expr_compute(ExprEval *ev, AmxExpr *e) {
+    ExprTerms t = {0};
+    AmxExpr *mm = NULL;
+    float alpha = 1.0f;
+    
+    if (e->kind == EXPR_MATMUL) {
+        mm = e;
+    } else {
+        expr_flatten(&t, e, 1.0f);      // Cannot overflow: e has at most AMX_LINCOMB_MAX operands
+        for (size_t i = 0; i < t.n; ++i) {
+            AmxExpr *c = t.node[i];
+            if (c->kind == EXPR_MATMUL && !c->value && c->uses == t.edges[i]) {
+                mm = c;
+                alpha = t.coeff[i];
+                --t.n;
+                for (size_t k = i; k < t.n; ++k) {
+                    t.node[k] = t.node[k + 1];
+                    t.coeff[k] = t.coeff[k + 1];
+                    t.edges[k] = t.edges[k + 1];
+                }
+                break;
+            }
+        }
+    }
+    
+    AmxMatrix *a = NULL, *b = NULL;
+    if (mm) {
+        a = expr_value(ev, mm->args[0]);
+        b = expr_value(ev, mm->args[1]);
+        if (UNLIKELY(!a || !b)) return NULL;
+    }
+    AmxMatrix *src[AMX_LINCOMB_MAX];
+    for (size_t i = 0; i < t.n; ++i) {
+        src[i] = expr_value(ev, t.node[i]);
+        if (UNLIKELY(!src[i])) return NULL;
+    }
+    
+    // Write over a term this node is the last reader of, GEMM operands excepted
+    AmxMatrix *out = NULL;
+    size_t reuse = t.n;
+    for (size_t i = 0; i < t.n; ++i) {
+        AmxExpr *c = t.node[i];
+        if (c->owned && c->uses == t.edges[i] && src[i] != a && src[i] != b) {
+            out = src[i];
+            reuse = i;
+            c->value = NULL;
+            c->owned = false;
+            break;
+        }
+    }
+    if (!out) out = expr_pool_take(ev, e->rows, e->cols);
+    if (UNLIKELY(!out)) return NULL;
+    
+    Lincomb l = {
+        .out = out->data, .bias = t.bias, .accumulate = mm != NULL,
+        .rows = out->rows, .cols = out->cols, .stride = out->stride
+    };
+    for (size_t i = 0; i < t.n; ++i) {
+        if (mm && i == reuse) continue;
+        l.src[l.n] = src[i]->data;
+        l.coeff[l.n] = t.coeff[i];
+        ++l.n;
+    }
+    
+    if (mm) {
+        const Sgemm g = {
+            .A = a->data, .lda = a->stride, .trans_a = false,
+            .B = b->data, .ldb = b->stride, .trans_b = false,
+            .C = out->data, .ldc = out->stride,
+            .M = a->rows, .N = b->cols, .K = a->cols,
+            .alpha = alpha, .beta = reuse < t.n ? t.coeff[reuse] : 0.0f,
+            .epilogue = lincomb_epilogue, .epilogue_ctx = &l
+        };
+        sgemm_run(&g);
+        expr_drop(ev, mm->args[0], 1);
+        expr_drop(ev, mm->args[1], 1);
+    } else {
+        lincomb_run(&l);
+    }
+    
+    for (size_t i = 0; i < t.n; ++i) expr_drop(ev, t.node[i], t.edges[i]);
+    return out;
+}
+
+static AmxMatrix *expr_value(ExprEval *ev, AmxExpr *e) {
+    if (e->value) return e->value;
+    if (e->kind == EXPR_INPUT) {
+        e->value = (AmxMatrix *)e->input;
+        return e->value;
+    }
+    e->value = expr_compute(ev, e);
+    e->owned = e->value != NULL;
+    return e->value;
+}
+
+AmxMatrix *amx_expr_eval(AmxExpr *e) {
+    if (UNLIKELY(!e)) return NULL;
+    
+    ExprEval ev = {0};
+    expr_count(&ev, e);
+    AmxMatrix *result = NULL;
+    if (LIKELY(!ev.failed)) {
+        AmxMatrix *v = expr_value(&ev, e);
+        if (v && e->owned) {
+            result = v;
+            e->value = NULL;
+            e->owned = false;
+        } else if (v) {
+            result = amx_matrix_clone(v);
+        }
+    }
+    
+    for (size_t i = 0; i < ev.n_visited; ++i) {
+        AmxExpr *x = ev.visited[i];
+        if (x->owned) amx_matrix_free(x->value);
+        x->uses = 0;
+        x->value = NULL;
+        x->owned = false;
+    }
+    for (size_t p = 0; p < ev.n_pool; ++p) amx_matrix_free(ev.pool[p]);
+    free(ev.visited);
+    return result;
+}
+
+// ============================================================================
+// Reductions
+// ----------------------------------------------------------------------------
+// Rows are reduced over their full padded stride: padding lanes are zero and
+// add nothing to sums or maxima. FAST keeps 32 independent float lanes;
+// PAIRWISE sums 256-element leaves and combines them as a tree; KAHAN carries
+// a compensation term per lane. Per-row results are combined in double.
+// Column sums walk 256-column strips down the rows with the same modes, or
+// run as a ones-vector GEMV through the SGEMM engine on AMX in FAST mode.
+// ============================================================================
+
+#define REDUCE_LEAF 256             // Floats summed directly by pairwise mode
+#define COLSUM_STRIP 256            // Columns per column-sum task
+#define COLSUM_LEAF 32              // Rows summed directly by pairwise column sums
+
+typedef enum { REDUCE_SUM, REDUCE_SUMSQ, REDUCE_MAXABS } ReduceOp;
+
+typedef uint32_t v16u __attribute__((vector_size(64), may_alias));
+
+// Tree sum of 16 lanes
+ALWAYS_INLINE static float hsum16(const float *lanes) {
+    float v[AMX_TILE];
+    memcpy(v, lanes, sizeof(v));
+    for (size_t w = AMX_TILE / 2; w > 0; w /= 2) {
+        for (size_t l = 0; l < w; ++l) v[l] += v[l + w];
+    }
+    return v[0];
+}
+
+// Sum (or sum of squares) of n floats, n a multiple of 16, on two accumulators
+ALWAYS_INLINE static float reduce_fast(const float *p, size_t n, ReduceOp op) {
+    const bool square = op == REDUCE_SUMSQ;
+    v16f a0 = {0}, a1 = {0};
+    size_t k = 0;
+    for (; k + 2 * AMX_TILE <= n; k += 2 * AMX_TILE) {
+        v16f x0 = EW_VEC(p + k), x1 = EW_VEC(p + k + AMX_TILE);
+        if (square) { x0 *= x0; x1 *= x1; }
+        a0 += x0;
+        a1 += x1;
+    }
+    if (k < n) {
+        v16f x = EW_VEC(p + k);
+        if (square) x *= x;
+        a0 += x;
+    }
+    a0 += a1;
+    return hsum16((const float *)&a0);
+}
+
+static float reduce_pairwise(const float *p, size_t n, ReduceOp op) {
+    if (n <= REDUCE_LEAF) return reduce_fast(p, n, op);
+    const size_t h = round_up(n / 2, AMX_TILE);
+    return reduce_pairwise(p, h, op) + reduce_pairwise(p + h, n - h, op);
+}
+
+static double reduce_kahan(const float *p, size_t n, ReduceOp op) {
+    v16f sum = {0}, comp = {0};
+    for (size_t k = 0; k < n; k += AMX_TILE) {
+        v16f x = EW_VEC(p + k);
+        if (op == REDUCE_SUMSQ) x *= x;
+        const v16f y = x - comp;
+        const v16f t = sum + y;
+        comp = (t - sum) - y;
+        sum = t;
+    }
+    double r = 0.0;
+    for (size_t l = 0; l < AMX_TILE; ++l) r += (double)sum[l] - (double)comp[l];
+    return r;
+}
+
+static float reduce_maxabs(const float *p, size_t n) {
+    // |x| as bits orders like the value and sorts NaN above infinity
+    const v16u mask = (v16u){0} + 0x7fffffffu;
+    v16u mx = {0};
+    for (size_t k = 0; k < n; k += AMX_TILE) {
+        const v16u a = *(const v16u *)(p + k) & mask;
+        const v16u gt = (v16u)(a > mx);
+        mx = (a & gt) | (mx & ~gt);
+    }
+    uint32_t best = 0;
+    for (size_t l = 0; l < AMX_TILE; ++l) best = mx[l] > best ? mx[l] : best;
+    float r;
+    memcpy(&r, &best, sizeof(r));
+    return r;
+}
+
+static float reduce_row(const float *p, size_t n, ReduceOp op, AmxReduceMode mode) {
+    if (op == REDUCE_MAXABS) return reduce_maxabs(p, n);
+    switch (mode) {
+    case AMX_REDUCE_PAIRWISE: return reduce_pairwise(p, n, op);
+    case AMX_REDUCE_KAHAN:    return (float)reduce_kahan(p, n, op);
+    default:                  return reduce_fast(p, n, op);
+    }
+}
+
+typedef struct {
+    const AmxMatrix *m;
+    float *out;                 // One value per row
+    ReduceOp op;
+    AmxReduceMode mode;
+    bool root;                  // Store sqrt of the result
+    size_t rows_per_task;
+} RowReduce;
+
+static void row_reduce_task_body(void *ctx, size_t t) {
+    const RowReduce *r = (const RowReduce *)ctx;
+    const AmxMatrix *m = r->m;
+    const size_t i0 = t * r->rows_per_task;
+    if (i0 >= m->rows) return;
+    const size_t i1 = (i0 + r->rows_per_task <= m->rows) ? i0 + r->rows_per_task : m->rows;
+    
+    for (size_t i = i0; i < i1; ++i) {
+        const float v = reduce_row(m->data + i * m->stride, m->stride, r->op, r->mode);
+        r->out[i] = r->root ? sqrtf(v) : v;
+    }
+}
+
+static void row_reduce_run(const AmxMatrix *m, float *out, ReduceOp op, AmxReduceMode mode, bool root) {
+    RowReduce r = { .m = m, .out = out, .op = op, .mode = mode, .root = root, .rows_per_task = m->rows };
+    const size_t workers = (size_t)num_workers();
+    if (m->rows * m->stride < EW_PARALLEL_MIN || workers == 1 || m->rows == 1) {
+        row_reduce_task_body(&r, 0);
+        return;
+    }
+    r.rows_per_task = (m->rows + workers - 1) / workers;
+    parallel_for((m->rows + r.rows_per_task - 1) / r.rows_per_task, &r, row_reduce_task_body);
+}
+
+ALWAYS_INLINE static double reduce_combine(double acc, double v, ReduceOp op) {
+    if (op != REDUCE_MAXABS) return acc + v;
+    return (v > acc || isnan(v)) ? v : acc;
+}
+
+// Per-row partials of the whole matrix, combined in double
+static double reduce_all(const AmxMatrix *m, ReduceOp op, AmxReduceMode mode) {
+    double acc = 0.0;
+    float *rows = malloc(m->rows * sizeof(float));
+    if (UNLIKELY(!rows)) {
+        for (size_t i = 0; i < m->rows; ++i) {
+            acc = reduce_combine(acc, reduce_row(m->data + i * m->stride, m->stride, op, mode), op);
+        }
+        return acc;
+    }
+    
+    row_reduce_run(m, rows, op, mode, false);
+    for (size_t i = 0; i < m->rows; ++i) acc = reduce_combine(acc, rows[i], op);
+    free(rows);
+    return acc;
+}
+
+// ---- Column sums ----
+
+typedef struct {
+    const AmxMatrix *m;
+    float *out;
+    AmxReduceMode mode;
+} ColSum;
+
+// acc[0..width) = sum of rows [i0, i1) over columns j0.., width a multiple of 16
+static void colsum_pairwise(const AmxMatrix *m, size_t i0, size_t i1, size_t j0, size_t width, float *RESTRICT acc) {
+    if (i1 - i0 <= COLSUM_LEAF) {
+        memset(acc, 0, width * sizeof(float));
+        for (size_t i = i0; i < i1; ++i) {
+            const float *row = m->data + i * m->stride + j0;
+            for (size_t k = 0; k < width; k += AMX_TILE) EW_VEC(acc + k) += EW_VEC(row + k);
+        }
+        return;
+    }
+    
+    float upper[COLSUM_STRIP] ALIGNED(64);
+    const size_t h = i0 + (i1 - i0) / 2;
+    colsum_pairwise(m, i0, h, j0, width, acc);
+    colsum_pairwise(m, h, i1, j0, width, upper);
+    for (size_t k = 0; k < width; k += AMX_TILE) EW_VEC(acc + k) += EW_VEC(upper + k);
+}
+
+static void colsum_task_body(void *ctx, size_t t) {
+    const ColSum *c = (const ColSum *)ctx;
+    const AmxMatrix *m = c->m;
+    const size_t j0 = t * COLSUM_STRIP;
+    const size_t n = (j0 + COLSUM_STRIP <= m->cols) ? COLSUM_STRIP : m->cols - j0;
+    const size_t width = round_up(n, AMX_TILE);
+    float acc[COLSUM_STRIP] ALIGNED(64) = {0};
+    
+    if (c->mode == AMX_REDUCE_PAIRWISE) {
+        colsum_pairwise(m, 0, m->rows, j0, width, acc);
+    } else if (c->mode == AMX_REDUCE_KAHAN) {
+        float comp[COLSUM_STRIP] ALIGNED(64) = {0};
+        for (size_t i = 0; i < m->rows; ++i) {
+            const float *row = m->data + i * m->stride + j0;
+            for (size_t k = 0; k < width; k += AMX_TILE) {
+                const v16f y = EW_VEC(row + k) - EW_VEC(comp + k);
+                const v16f s = EW_VEC(acc + k) + y;
+                EW_VEC(comp + k) = (s - EW_VEC(acc + k)) - y;
+                EW_VEC(acc + k) = s;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < m->rows; ++i) {
+            const float *row = m->data + i * m->stride + j0;
+            for (size_t k = 0; k < width; k += AMX_TILE) EW_VEC(acc + k) += EW_VEC(row + k);
+        }
+    }
+    memcpy(c->out + j0, acc, n * sizeof(float));
+}
+
+// 1 x rows ones vector times m through the SGEMM engine
+static bool colsum_gemv(const AmxMatrix *m, float *out) {
+    float *ones = malloc(m->rows * sizeof(float));
+    if (UNLIKELY(!ones)) return false;
+    for (size_t i = 0; i < m->rows; ++i) ones[i] = 1.0f;
+    
+    const Sgemm g = {
+        .A = ones, .lda = m->rows, .trans_a = false,
+        .B = m->data, .ldb = m->stride, .trans_b = false,
+        .C = out, .ldc = m->cols,
+        .M = 1, .N = m->cols, .K = m->rows,
+        .alpha = 1.0f, .beta = 0.0f
+    };
+    sgemm_run(&g);
+    free(ones);
+    return true;
+}
+
+// ---- Public ----
+
+bool amx_matrix_row_sums(const AmxMatrix *m, float *out, AmxReduceMode mode) {
+    if (UNLIKELY(!m || !out)) return false;
+    row_reduce_run(m, out, REDUCE_SUM, mode, false);
+    return true;
+}
+
+bool amx_matrix_row_norms(const AmxMatrix *m, float *out, AmxReduceMode mode) {
+    if (UNLIKELY(!m || !out)) return false;
+    row_reduce_run(m, out, REDUCE_SUMSQ, mode, true);
+    return true;
+}
+
+bool amx_matrix_col_sums(const AmxMatrix *m, float *out, AmxReduceMode mode) {
+    if (UNLIKELY(!m || !out)) return false;
+    if (mode == AMX_REDUCE_FAST && amx_is_available() && colsum_gemv(m, out)) return true;
+    
+    ColSum c = { .m = m, .out = out, .mode = mode };
+    const size_t strips = (m->cols + COLSUM_STRIP - 1) / COLSUM_STRIP;
+    if (m->rows * m->stride < EW_PARALLEL_MIN) {
+        for (size_t t = 0; t < strips; ++t) colsum_task_body(&c, t);
+    } else {
+        parallel_for(strips, &c, colsum_task_body);
+    }
+    return true;
+}
+
+float amx_matrix_max_abs(const AmxMatrix *m) {
+    if (UNLIKELY(!m)) return 0.0f;
+    return (float)reduce_all(m, REDUCE_MAXABS, AMX_REDUCE_FAST);
+}
+
+float amx_matrix_frobenius_norm(const AmxMatrix *m, AmxReduceMode mode) {
+    if (UNLIKELY(!m)) return 0.0f;
+    return (float)sqrt(reduce_all(m, REDUCE_SUMSQ, mode));
+}
+
+// ============================================================================
+// Convolution
+// ----------------------------------------------------------------------------
+// NHWC conv2d as implicit GEMM, one SGEMM per group:
+//   C[pixel][oc] = sum over (kh, kw, c) of patch[pixel][(kh, kw, c)] * W[(kh, kw, c)][oc]
+// The HWIO filter is already that K x OC matrix, and NHWC output is C. The
+// patch matrix is never built: the engine's A packer gathers each 16-pixel
+// panel straight from the input, copying runs of contiguous channels per
+// tap and zero-filling taps that fall in the padding. Bias and activation
+// run in the GEMM epilogue.
+//
+// Two shapes skip the gather. A 1x1, stride 1, unpadded conv reads the NHWC
+// input in place as the pixels x in_c A matrix. Depthwise convs (one input
+// and one output channel per group) have no reduction over channels, so
+// they run as vector multiply-adds across blocks of 64 channels, with each
+// block's taps staying in L1 along an output row.
+// ============================================================================
+
+#define DW_CB 64                    // Channels per depthwise block
+
+typedef struct {
+    const float *input;
+    size_t in_h, in_w, in_c;
+    size_t out_h, out_w;
+    size_t kernel_w;
+    size_t stride_h, stride_w;
+    size_t pad_h, pad_w;
+    size_t dilation_h, dilation_w;
+    size_t group_c;             // Input channels per group
+    size_t c0;                  // First input channel of the current group
+} ConvPatch;
+
+typedef struct {
+    float *out;                 // Output at the group's first channel
+    size_t ldo;
+    const float *bias;          // At the group's first channel, or NULL
+    AmxActivation act;
+} ConvEpilogue;
+
+ALWAYS_INLINE static float apply_activation(float v, AmxActivation act) {
+    switch (act) {
+    case AMX_ACT_RELU:  return v > 0.0f ? v : 0.0f;
+    case AMX_ACT_RELU6: return v > 0.0f ? (v < 6.0f ? v : 6.0f) : 0.0f;
+    default:            return v;
+    }
+}
+
+// SgemmPackA: output pixels i0..i0+rows, patch elements p0..p0+kc
+static void conv_pack_a(const void *ctx, float *RESTRICT panel, size_t i0, size_t rows, size_t p0, size_t kc) {
+    const ConvPatch *c = (const ConvPatch *)ctx;
+    const size_t plane = c->out_h * c->out_w;
+    
+    for (size_t r = 0; r < rows; ++r) {
+        const size_t m = i0 + r;
+        const size_t n = m / plane, oh = (m % plane) / c->out_w, ow = m % c->out_w;
+        const ptrdiff_t ih0 = (ptrdiff_t)(oh * c->stride_h) - (ptrdiff_t)c->pad_h;
+        const ptrdiff_t iw0 = (ptrdiff_t)(ow * c->stride_w) - (ptrdiff_t)c->pad_w;
+        const float *image = c->input + n * c->in_h * c->in_w * c->in_c + c->c0;
+        
+        // One run per filter tap: channels are contiguous in NHWC
+        for (size_t k = p0; k < p0 + kc;) {
+            const size_t tap = k / c->group_c, ch = k % c->group_c;
+            const size_t run = (c->group_c - ch < p0 + kc - k) ? c->group_c - ch : p0 + kc - k;
+            const ptrdiff_t ih = ih0 + (ptrdiff_t)((tap / c->kernel_w) * c->dilation_h);
+            const ptrdiff_t iw = iw0 + (ptrdiff_t)((tap % c->kernel_w) * c->dilation_w);
+            float *RESTRICT dst = panel + (k - p0) * AMX_TILE + r;
+            
+            if (ih >= 0 && ih < (ptrdiff_t)c->in_h && iw >= 0 && iw < (ptrdiff_t)c->in_w) {
+                const float *RESTRICT src = image + ((size_t)ih * c->in_w + (size_t)iw) * c->in_c + ch;
+                for (size_t t = 0; t < run; ++t) dst[t * AMX_TILE] = src[t];
+            } else {
+                for (size_t t = 0; t < run; ++t) dst[t * AMX_TILE] = 0.0f;
+            }
+            k += run;
+        }
+    }
+    
+    if (rows < AMX_TILE) {
+        for (size_t k = 0; k < kc; ++k) memset(panel + k * AMX_TILE + rows, 0, (AMX_TILE - rows) * sizeof(float));
+    }
+}
+
+static void conv_epilogue(const void *ctx, size_t i0, size_t i1, size_t j0, size_t j1) {
+    const ConvEpilogue *e = (const ConvEpilogue *)ctx;
+    for (size_t i = i0; i < i1; ++i) {
+        float *RESTRICT row = e->out + i * e->ldo;
+        for (size_t j = j0; j < j1; ++j) {
+            const float v = e->bias ? row[j] + e->bias[j] : row[j];
+            row[j] = apply_activation(v, e->act);
+        }
+    }
+}
+
+// Zero stride, dilation or groups mean 1
+ALWAYS_INLINE static size_t conv_param(size_t v) { return v ? v : 1; }
+
+bool amx_conv2d_output_size(const AmxConv2dParams *p, size_t *out_h, size_t *out_w) {
+    if (UNLIKELY(!p || !p->kernel_h || !p->kernel_w)) return false;
+    
+    const size_t eff_h = conv_param(p->dilation_h) * (p->kernel_h - 1) + 1;
+    const size_t eff_w = conv_param(p->dilation_w) * (p->kernel_w - 1) + 1;
+    if (p->in_h + 2 * p->pad_h < eff_h || p->in_w + 2 * p->pad_w < eff_w) return false;
+    
+    if (out_h) *out_h = (p->in_h + 2 * p->pad_h - eff_h) / conv_param(p->stride_h) + 1;
+    if (out_w) *out_w = (p->in_w + 2 * p->pad_w - eff_w) / conv_param(p->stride_w) + 1;
+    return true;
+}
+
+// 1x1 conv per group with the input read in place: A = input + c0, lda = in_c
+static void conv_pointwise(
+    const float *input, size_t pixels, size_t in_c, size_t out_c, size_t groups,
+    const float *filter, const float *bias, AmxActivation act, float *output
+) {
+    const size_t group_c = in_c / groups, group_oc = out_c / groups;
+    for (size_t g = 0; g < groups; ++g) {
+        const ConvEpilogue epi = {
+            .out = output + g * group_oc, .ldo = out_c,
+            .bias = bias ? bias + g * group_oc : NULL, .act = act
+        };
+        const Sgemm gemm = {
+            .A = input + g * group_c, .lda = in_c, .trans_a = false,
+            .B = filter + g * group_oc, .ldb = out_c, .trans_b = false,
+            .C = output + g * group_oc, .ldc = out_c,
+            .M = pixels, .N = group_oc, .K = group_c,
+            .alpha = 1.0f, .beta = 0.0f,
+            .epilogue = (bias || act != AMX_ACT_NONE) ? conv_epilogue : NULL, .epilogue_ctx = &epi
+        };
+        sgemm_run(&gemm);
+    }
+}
+
+typedef struct {
+    const ConvPatch *patch;
+    const float *filter;
+    const float *bias;
+    AmxActivation act;
+    float *output;
+    size_t kernel_h;
+    size_t rows;                // batch * out_h
+    size_t rows_per_task;
+} DepthwiseTask;
+
+// Output rows (n, oh) in [row0, row1); channel c reads input channel c and filter column c
+HOT static void conv_depthwise_rows(const DepthwiseTask *t, size_t row0, size_t row1) {
+    const ConvPatch *c = t->patch;
+    const size_t channels = c->in_c;
+    
+    for (size_t row = row0; row < row1; ++row) {
+        const size_t n = row / c->out_h, oh = row % c->out_h;
+        const float *image = c->input + n * c->in_h * c->in_w * channels;
+        float *out_row = t->output + row * c->out_w * channels;
+        
+        for (size_t cb = 0; cb < channels; cb += DW_CB) {
+            const size_t width = (cb + DW_CB <= channels) ? DW_CB : channels - cb;
+            
+            for (size_t ow = 0; ow < c->out_w; ++ow) {
+                float acc[DW_CB] ALIGNED(64);
+                for (size_t k = 0; k < width; ++k) acc[k] = t->bias ? t->bias[cb + k] : 0.0f;
+                
+                for (size_t kh = 0; kh < t->kernel_h; ++kh) {
+                    const ptrdiff_t ih = (ptrdiff_t)(oh * c->stride_h + kh * c->dilation_h) - (ptrdiff_t)c->pad_h;
+                    if (ih < 0 || ih >= (ptrdiff_t)c->in_h) continue;
+                    for (size_t kw = 0; kw < c->kernel_w; ++kw) {
+                        const ptrdiff_t iw = (ptrdiff_t)(ow * c->stride_w + kw * c->dilation_w) - (ptrdiff_t)c->pad_w;
+                        if (iw < 0 || iw >= (ptrdiff_t)c->in_w) continue;
+                        
+                        const float *RESTRICT src = image + ((size_t)ih * c->in_w + (size_t)iw) * channels + cb;
+                        const float *RESTRICT w = t->filter + (kh * c->kernel_w + kw) * channels + cb;
+                        for (size_t k = 0; k < width; ++k) acc[k] += src[k] * w[k];
+                    }
+                }
+                
+                float *RESTRICT dst = out_row + ow * channels + cb;
+                for (size_t k = 0; k < width; ++k) dst[k] = apply_activation(acc[k], t->act);
+            }
+        }
+    }
+}
+
+static void conv_depthwise_task_body(void *ctx, size_t i) {
+    const DepthwiseTask *t = (const DepthwiseTask *)ctx;
+    const size_t row0 = i * t->rows_per_task;
+    if (row0 >= t->rows) return;
+    const size_t row1 = (row0 + t->rows_per_task <= t->rows) ? row0 + t->rows_per_task : t->rows;
+    conv_depthwise_rows(t, row0, row1);
+}
+
+static void conv_depthwise(const AmxConv2dParams *p, const ConvPatch *patch, const float *filter,
+                           const float *bias, AmxActivation act, float *output) {
+    DepthwiseTask task = {
+        .patch = patch, .filter = filter, .bias = bias, .act = act, .output = output,
+        .kernel_h = p->kernel_h, .rows = p->batch * patch->out_h
+    };
+    const size_t workers = (size_t)num_workers();
+    const size_t work = task.rows * patch->out_w * patch->in_c * p->kernel_h * p->kernel_w;
+    if (work < EW_PARALLEL_MIN || workers == 1) {
+        conv_depthwise_rows(&task, 0, task.rows);
+        return;
+    }
+    task.rows_per_task = (task.rows + workers - 1) / workers;
+    parallel_for((task.rows + task.rows_per_task - 1) / task.rows_per_task, &task, conv_depthwise_task_body);
+}
+
+bool amx_conv1x1_f32(
+    const float *input, size_t pixels, size_t in_c,
+    const float *filter, size_t out_c,
+    const float *bias, AmxActivation act, float *output
+) {
+    if (UNLIKELY(!input || !filter || !output || !pixels || !in_c || !out_c)) return false;
+    conv_pointwise(input, pixels, in_c, out_c, 1, filter, bias, act, output);
+    return true;
+}
+
+bool amx_conv2d_f32(
+    const AmxConv2dParams *p,
+    const float *input,
+    const float *filter,
+    const float *bias,
+    AmxActivation act,
+    float *output
+) {
+    size_t out_h, out_w;
+    if (UNLIKELY(!input || !filter || !output || !amx_conv2d_output_size(p, &out_h, &out_w))) return false;
+    const size_t groups = conv_param(p->groups);
+    if (UNLIKELY(!p->batch || !p->in_c || !p->out_c || p->in_c % groups || p->out_c % groups)) return false;
+    
+    const size_t group_c = p->in_c / groups, group_oc = p->out_c / groups;
+    ConvPatch patch = {
+        .input = input,
+        .in_h = p->in_h, .in_w = p->in_w, .in_c = p->in_c,
+        .out_h = out_h, .out_w = out_w,
+        .kernel_w = p->kernel_w,
+        .stride_h = conv_param(p->stride_h), .stride_w = conv_param(p->stride_w),
+        .pad_h = p->pad_h, .pad_w = p->pad_w,
+        .dilation_h = conv_param(p->dilation_h), .dilation_w = conv_param(p->dilation_w),
+        .group_c = group_c
+    };
+    
+    if (group_c == 1 && group_oc == 1) {
+        conv_depthwise(p, &patch, filter, bias, act, output);
+        return true;
+    }
+    if (p->kernel_h == 1 && p->kernel_w == 1 && patch.stride_h == 1 && patch.stride_w == 1 && !p->pad_h && !p->pad_w) {
+        conv_pointwise(input, p->batch * out_h * out_w, p->in_c, p->out_c, groups, filter, bias, act, output);
+        return true;
+    }
+    
+    for (size_t g = 0; g < groups; ++g) {
+        patch.c0 = g * group_c;
+        const ConvEpilogue epi = {
+            .out = output + g * group_oc, .ldo = p->out_c,
+            .bias = bias ? bias + g * group_oc : NULL, .act = act
+        };
+        const Sgemm gemm = {
+            .B = filter + g * group_oc, .ldb = p->out_c, .trans_b = false,
+            .C = output + g * group_oc, .ldc = p->out_c,
+            .M = p->batch * out_h * out_w, .N = group_oc, .K = p->kernel_h * p->kernel_w * group_c,
+            .alpha = 1.0f, .beta = 0.0f,
+            .epilogue = (bias || act != AMX_ACT_NONE) ? conv_epilogue : NULL, .epilogue_ctx = &epi,
+            .pack_a = conv_pack_a, .pack_a_ctx = &patch
+        };
+        sgemm_run(&gemm);
+    }
+    return true;
+}
+
+// ============================================================================
+// Attention
+// ----------------------------------------------------------------------------
+// softmax(scale * Q K^T) V one (batch, head, ATTN_BR query rows) block per
+// task, flash-attention style: K and V are streamed in ATTN_BC-key blocks,
+// each row keeps a running max and sum, and the output accumulator is
+// rescaled whenever the max grows. Scores only ever exist as one BR x BC
+// tile, so memory traffic is linear in sequence length.
+//
+// Both products run on the GEMM tile kernels: the scaled Q block is packed
+// once as A panels against a transposed K block; the probabilities are
+// packed as A panels against V read in place.
+// ============================================================================
+
+#define ATTN_BR 64                  // Query rows per task
+#define ATTN_BC 64                  // Keys per block
+
+// e^x to about 2 ulp for x in [-87.3, 88]: 2^n * p(r) with r = x - n ln2
+// in [-ln2/2, ln2/2]. Below that range, where e^x is under FLT_MIN, the
+// result is flushed to 0; above it, x is clamped to 88. exp_quad below is
+// the same computation on a 4-float vector.
+ALWAYS_INLINE static float exp_approx(float x) {
+    if (x < -87.3f) return 0.0f;
+    if (isnan(x)) return x;     // NaN must not reach the int conversion
+    x = x > 88.0f ? 88.0f : x;
+    const float n = floorf(x * 1.44269504f + 0.5f);
+    const float r = x - n * 0.693359375f + n * 2.12194440e-4f;
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+    const uint32_t bits = (uint32_t)((int32_t)n + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// 128-bit lanes for compares and selects, which every target lowers natively
+typedef float v4f __attribute__((vector_size(16), may_alias));
+typedef int32_t v4i __attribute__((vector_size(16), may_alias));
+
+// x[0..4) = e^(x - sub) in place, exp_approx on one vector. The rounding
+// adds 1.5 * 2^23 so the low bits of t hold n for the exponent.
+ALWAYS_INLINE static void exp_quad(float *x, float sub) {
+    v4f v = *(v4f *)x - sub;
+    const v4f lo = (v4f){0} - 87.3f, hi = (v4f){0} + 88.0f;
+    const v4i below = v < lo, above = v > hi;
+    v = (v4f)(((v4i)v & ~below) | ((v4i)lo & below));
+    v = (v4f)(((v4i)v & ~above) | ((v4i)hi & above));
+    
+    const v4f t = v * 1.44269504f + 12582912.0f;
+    const v4f n = t - 12582912.0f;
+    const v4f r = v - n * 0.693359375f + n * 2.12194440e-4f;
+    v4f p = (v4f){0} + 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+    const v4i bits = ((v4i)t - 0x4B400000 + 127) << 23;
+    // Below lo e^x is under FLT_MIN: flush so e^-inf is exactly 0
+    *(v4f *)x = (v4f)((v4i)(p * (v4f)bits) & ~below);
+}
+
+// Largest of n floats at a 64-byte aligned x; -inf when n == 0
+static float max_floats(const float *x, size_t n) {
+    const size_t nv = n & ~(size_t)(AMX_TILE - 1);
+    float m = -INFINITY;
+    if (nv) {
+        // Four independent running maxima, one per 4-float quarter of each chunk
+        v4f mx[4];
+        memcpy(mx, x, sizeof(mx));
+        for (size_t k = AMX_TILE; k < nv; k += AMX_TILE) {
+            for (size_t q = 0; q < 4; ++q) {
+                const v4f v = *(const v4f *)(x + k + 4 * q);
+                const v4i gt = v > mx[q];
+                mx[q] = (v4f)(((v4i)v & gt) | ((v4i)mx[q] & ~gt));
+            }
+        }
+        for (size_t q = 0; q < 4; ++q) {
+            for (size_t l = 0; l < 4; ++l) m = mx[q][l] > m ? mx[q][l] : m;
+        }
+    }
+    for (size_t k = nv; k < n; ++k) m = x[k] > m ? x[k] : m;
+    return m;
+}
+
+// x[k] = e^(x[k] - sub) for n floats at a 64-byte aligned x; returns their sum
+static float exp_floats(float *x, size_t n, float sub) {
+    const size_t nv = n & ~(size_t)(AMX_TILE - 1);
+    v16f acc = {0};
+    for (size_t k = 0; k < nv; k += AMX_TILE) {
+        for (size_t q = 0; q < AMX_TILE; q += 4) exp_quad(x + k + q, sub);
+        acc += EW_VEC(x + k);
+    }
+    float sum = hsum16((const float *)&acc);
+    for (size_t k = nv; k < n; ++k) {
+        x[k] = exp_approx(x[k] - sub);
+        sum += x[k];
+    }
+    return sum;
+}
+
+typedef struct {
+    const AmxAttentionParams *p;
+    const float *q, *k, *v;
+    float *out;
+    size_t q_blocks;
+    size_t group;               // Query heads per KV head
+    float scale;
+    bool use_amx;
+} Attention;
+
+// Used when the block buffers cannot be allocated: one row and one key at a
+// time, accumulating straight into the output row
+COLD static void attention_rows_naive(
+    const Attention *at, const float *q, const float *k, const float *v, float *out,
+    size_t q0, size_t rows, size_t qs, size_t kvs
+) {
+    const AmxAttentionParams *p = at->p;
+    const ptrdiff_t shift = (ptrdiff_t)p->kv_len - (ptrdiff_t)p->q_len;
+    
+    for (size_t r = 0; r < rows; ++r) {
+        const float *RESTRICT qr = q + r * qs;
+        float *RESTRICT dst = out + r * qs;
+        memset(dst, 0, p->head_dim * sizeof(float));
+        
+        size_t visible = p->kv_len;
+        if (p->causal) {
+            const ptrdiff_t lim = (ptrdiff_t)(q0 + r + 1) + shift;
+            visible = lim <= 0 ? 0 : ((size_t)lim < visible ? (size_t)lim : visible);
+        }
+        
+        float m = -INFINITY, sum = 0.0f;
+        for (size_t j = 0; j < visible; ++j) {
+            const float *RESTRICT kj = k + j * kvs;
+            const float *RESTRICT vj = v + j * kvs;
+            float sc = 0.0f;
+            for (size_t e = 0; e < p->head_dim; ++e) sc += qr[e] * kj[e];
+            sc *= at->scale;
+            if (sc > m) {
+                const float corr = m == -INFINITY ? 0.0f : exp_approx(m - sc);
+                for (size_t e = 0; e < p->head_dim; ++e) dst[e] *= corr;
+                sum *= corr;
+                m = sc;
+            }
+            const float w = exp_approx(sc - m);
+            sum += w;
+            for (size_t e = 0; e < p->head_dim; ++e) dst[e] += w * vj[e];
+        }
+        
+        const float inv = sum > 0.0f ? 1.0f / sum : 0.0f;
+        for (size_t e = 0; e < p->head_dim; ++e) dst[e] *= inv;
+    }
+}
+
+static void attention_task_body(void *ctx, size_t t) {
+    const Attention *at = (const Attention *)ctx;
+    const AmxAttentionParams *p = at->p;
+    const size_t d = p->head_dim, dp = round_up(d, AMX_TILE);
+    const size_t heads = p->heads, kv_heads = heads / at->group;
+    
+    // Causal blocks near the end of the sequence are the largest; hand them out first
+    const size_t qb = at->q_blocks - 1 - t % at->q_blocks;
+    const size_t bh = t / at->q_blocks;
+    const size_t b = bh / heads, h = bh % heads;
+    const size_t q0 = qb * ATTN_BR;
+    const size_t rows = (q0 + ATTN_BR <= p->q_len) ? ATTN_BR : p->q_len - q0;
+    
+    const size_t qs = heads * d, kvs = kv_heads * d;
+    const float *q = at->q + (b * p->q_len + q0) * qs + h * d;
+    const float *k = at->k + b * p->kv_len * kvs + (h / at->group) * d;
+    const float *v = at->v + b * p->kv_len * kvs + (h / at->group) * d;
+    float *out = at->out + (b * p->q_len + q0) * qs + h * d;
+    
+    // Keys visible to the block's rows: causal row i sees keys < i + 1 + kv_len - q_len
+    const ptrdiff_t shift = (ptrdiff_t)p->kv_len - (ptrdiff_t)p->q_len;
+    size_t kv_end = p->kv_len;
+    if (p->causal) {
+        const ptrdiff_t last = (ptrdiff_t)(q0 + rows) + shift;
+        kv_end = last <= 0 ? 0 : ((size_t)last < kv_end ? (size_t)last : kv_end);
+    }
+    
+    float *buf = alloc_aligned((ATTN_BR * d + d * ATTN_BC + 2 * ATTN_BR * ATTN_BC +
+                                ATTN_BR * dp + ATTN_BC * AMX_TILE + 2 * ATTN_BR) * sizeof(float));
+    if (UNLIKELY(!buf)) {
+        attention_rows_naive(at, q, k, v, out, q0, rows, qs, kvs);
+        return;
+    }
+    float *q_panels = buf;                          // ATTN_BR / 16 panels of 16 x d
+    float *kt = q_panels + ATTN_BR * d;             // d x ATTN_BC
+    float *s = kt + d * ATTN_BC;                    // ATTN_BR x ATTN_BC scores
+    float *pp = s + ATTN_BR * ATTN_BC;              // Probabilities as A panels
+    float *o = pp + ATTN_BR * ATTN_BC;              // ATTN_BR x dp accumulator
+    float *v_tile = o + ATTN_BR * dp;               // ATTN_BC x 16, partial V tiles
+    float *row_max = v_tile + ATTN_BC * AMX_TILE;
+    float *row_sum = row_max + ATTN_BR;
+    
+    const TileKernel kernel = tile_kernel(at->use_amx);
+    if (at->use_amx) AMX_SET();
+    
+    for (size_t ii = 0; ii < rows; ii += AMX_TILE) {
+        const size_t mr = (ii + AMX_TILE <= rows) ? AMX_TILE : rows - ii;
+        float *panel = q_panels + ii * d;
+        pack_a_panel(q, panel, ii, ii + mr, d, qs);
+        for (size_t e = 0; e < d * AMX_TILE; ++e) panel[e] *= at->scale;
+    }
+    memset(o, 0, ATTN_BR * dp * sizeof(float));
+    for (size_t r = 0; r < rows; ++r) { row_max[r] = -INFINITY; row_sum[r] = 0.0f; }
+    
+    for (size_t j0 = 0; j0 < kv_end; j0 += ATTN_BC) {
+        const size_t keys = (j0 + ATTN_BC <= kv_end) ? ATTN_BC : kv_end - j0;
+        const size_t keys_pad = round_up(keys, AMX_TILE);
+        
+        // K block transposed; padding columns are zeroed so their scores are finite
+        transpose_leaf(k + j0 * kvs, kvs, kt, ATTN_BC, keys, d);
+        if (keys < keys_pad) {
+            for (size_t e = 0; e < d; ++e) memset(kt + e * ATTN_BC + keys, 0, (keys_pad - keys) * sizeof(float));
+        }
+        
+        // S = (scale * Q) K^T
+        for (size_t ii = 0; ii < rows; ii += AMX_TILE) {
+            const size_t mr = (ii + AMX_TILE <= rows) ? AMX_TILE : rows - ii;
+            for (size_t jj = 0; jj < keys; jj += AMX_TILE) {
+                const size_t nr = (jj + AMX_TILE <= keys) ? AMX_TILE : keys - jj;
+                kernel(q_panels + ii * d, kt + jj, s + ii * ATTN_BC + jj, d, ATTN_BC, ATTN_BC, mr, nr, false);
+            }
+        }
+        
+        // Online softmax: fold this block into each row's running max and sum
+        for (size_t r = 0; r < rows; ++r) {
+            float *RESTRICT sr = s + r * ATTN_BC;
+            size_t visible = keys;
+            if (p->causal) {
+                const ptrdiff_t lim = (ptrdiff_t)(q0 + r + 1) + shift - (ptrdiff_t)j0;
+                visible = lim <= 0 ? 0 : ((size_t)lim < keys ? (size_t)lim : keys);
+            }
+            if (visible == 0) {
+                memset(sr, 0, keys * sizeof(float));
+                continue;
+            }
+            
+            const float block_max = max_floats(sr, visible);
+            const float m = block_max > row_max[r] ? block_max : row_max[r];
+            const float sum = exp_floats(sr, visible, m);
+            for (size_t c = visible; c < keys; ++c) sr[c] = 0.0f;
+            
+            if (m != row_max[r]) {
+                const float corr = row_max[r] == -INFINITY ? 0.0f : exp_approx(row_max[r] - m);
+                float *RESTRICT orow = o + r * dp;
+                for (size_t e = 0; e < d; ++e) orow[e] *= corr;
+                row_sum[r] *= corr;
+                row_max[r] = m;
+            }
+            row_sum[r] += sum;
+        }
+        
+        // O += P V
+        const float *vb = v + j0 * kvs;
+        for (size_t ii = 0; ii < rows; ii += AMX_TILE) {
+            const size_t mr = (ii + AMX_TILE <= rows) ? AMX_TILE : rows - ii;
+            pack_a_panel(s, pp + ii * ATTN_BC, ii, ii + mr, keys, ATTN_BC);
+        }
+        for (size_t e0 = 0; e0 < d; e0 += AMX_TILE) {
+            const size_t nr = (e0 + AMX_TILE <= d) ? AMX_TILE : d - e0;
+            const float *b_ptr = vb + e0;
+            size_t b_stride = kvs;
+            if (nr < AMX_TILE) {
+                for (size_t c = 0; c < keys; ++c) {
+                    memcpy(v_tile + c * AMX_TILE, vb + c * kvs + e0, nr * sizeof(float));
+                    memset(v_tile + c * AMX_TILE + nr, 0, (AMX_TILE - nr) * sizeof(float));
+                }
+                b_ptr = v_tile;
+                b_stride = AMX_TILE;
+            }
+            for (size_t ii = 0; ii < rows; ii += AMX_TILE) {
+                const size_t mr = (ii + AMX_TILE <= rows) ? AMX_TILE : rows - ii;
+                kernel(pp + ii * ATTN_BC, b_ptr, o + ii * dp + e0, keys, b_stride, dp, mr, nr, true);
+            }
+        }
+    }
+    
+    if (at->use_amx) AMX_CLR();
+    
+    // Rows that see no key at all produce zeros
+    for (size_t r = 0; r < rows; ++r) {
+        const float inv = row_sum[r] > 0.0f ? 1.0f / row_sum[r] : 0.0f;
+        const float *RESTRICT orow = o + r * dp;
+        float *RESTRICT dst = out + r * qs;
+        for (size_t e = 0; e < d; ++e) dst[e] = orow[e] * inv;
+    }
+    free(buf);
+}
+
+bool amx_attention_f32(const AmxAttentionParams *p, const float *q, const float *k,
+                       const float *v, float *out) {
+    if (UNLIKELY(!p || !q || !k || !v || !out)) return false;
+    if (UNLIKELY(!p->batch || !p->heads || !p->q_len || !p->kv_len || !p->head_dim)) return false;
+    
+    const size_t kv_heads = p->kv_heads ? p->kv_heads : p->heads;
+    if (UNLIKELY(p->heads % kv_heads)) return false;
+    
+    Attention at = {
+        .p = p, .q = q, .k = k, .v = v, .out = out,
+        .q_blocks = (p->q_len + ATTN_BR - 1) / ATTN_BR,
+        .group = p->heads / kv_heads,
+        .scale = p->scale != 0.0f ? p->scale : 1.0f / sqrtf((float)p->head_dim),
+        .use_amx = amx_is_available()
+    };
+    parallel_for(p->batch * p->heads * at.q_blocks, &at, attention_task_body);
+    return true;
+}
+
+// ============================================================================
+// Row Normalization
+// ----------------------------------------------------------------------------
+// Softmax, layernorm and RMSNorm over each row, on 16-float vectors with a
+// scalar tail so the zero padding lanes are neither read into a statistic
+// nor written. Layernorm takes mean and variance in one pass over values
+// shifted by the row's first element, which keeps the variance exact for
+// rows far from zero; scale and shift are fused into the single write pass.
+// The same row routine runs across the pool on a whole matrix, or as a
+// SGEMM epilogue on rows whose last column tile has just been produced.
+// ============================================================================
+
+#define ROW_OP_EPS 1e-5f
+
+typedef struct {
+    AmxRowOpKind kind;
+    const float *gamma, *beta;  // NULL means 1 and 0
+    float eps;
+    float *data;
+    size_t rows, cols, stride;
+    size_t rows_per_task;
+} RowOp;
+
+// Rows whose max is infinite take the limit instead of exp(inf - inf): all
+// -inf becomes zeros, like an empty causal row in attention, and +inf
+// entries share the row evenly. A NaN still makes the whole row NaN.
+HOT static void row_softmax(float *RESTRICT x, size_t n) {
+    const float m = max_floats(x, n);
+    if (m == -INFINITY || m == INFINITY) {
+        size_t count = 0;
+        bool nan = false;
+        for (size_t k = 0; k < n; ++k) {
+            count += x[k] == INFINITY;
+            nan |= isnan(x[k]);
+        }
+        const float rest = nan ? NAN : 0.0f;
+        const float share = nan ? NAN : 1.0f / (float)count;
+        for (size_t k = 0; k < n; ++k) x[k] = x[k] == INFINITY ? share : rest;
+        return;
+    }
+    const float inv = 1.0f / exp_floats(x, n, m);
+    for (size_t k = 0; k < n; ++k) x[k] *= inv;
+}
+
+HOT static void row_layernorm(const RowOp *r, float *RESTRICT x, size_t n) {
+    const size_t nv = n & ~(size_t)(AMX_TILE - 1);
+    const float shift = x[0];
+    
+    v16f s = {0}, ss = {0};
+    for (size_t k = 0; k < nv; k += AMX_TILE) {
+        const v16f d = EW_VEC(x + k) - shift;
+        s += d;
+        ss += d * d;
+    }
+    float sum = hsum16((const float *)&s), sumsq = hsum16((const float *)&ss);
+    for (size_t k = nv; k < n; ++k) {
+        const float d = x[k] - shift;
+        sum += d;
+        sumsq += d * d;
+    }
+    
+    const float dm = sum / (float)n;
+    const float var = sumsq / (float)n - dm * dm;
+    const float mean = shift + dm;
+    const float rstd = 1.0f / sqrtf((var > 0.0f ? var : 0.0f) + r->eps);
+    
+    const float *RESTRICT gamma = r->gamma, *RESTRICT beta = r->beta;
+    if (gamma && beta) {
+        for (size_t k = 0; k < n; ++k) x[k] = (x[k] - mean) * rstd * gamma[k] + beta[k];
+    } else if (gamma) {
+        for (size_t k = 0; k < n; ++k) x[k] = (x[k] - mean) * rstd * gamma[k];
+    } else if (beta) {
+        for (size_t k = 0; k < n; ++k) x[k] = (x[k] - mean) * rstd + beta[k];
+    } else {
+        for (size_t k = 0; k < n; ++k) x[k] = (x[k] - mean) * rstd;
+    }
+}
+
+// Padding lanes are zero, so the sum of squares runs over the whole stride
+HOT static void row_rmsnorm(const RowOp *r, float *RESTRICT x, size_t n, size_t stride) {
+    const float rstd = 1.0f / sqrtf(reduce_fast(x, stride, REDUCE_SUMSQ) / (float)n + r->eps);
+    
+    const float *RESTRICT gamma = r->gamma;
+    if (gamma) {
+        for (size_t k = 0; k < n; ++k) x[k] *= rstd * gamma[k];
+    } else {
+        for (size_t k = 0; k < n; ++k) x[k] *= rstd;
+    }
+}
+
+static void row_op_rows(const RowOp *r, size_t i0, size_t i1) {
+    for (size_t i = i0; i < i1; ++i) {
+        float *x = r->data + i * r->stride;
+        switch (r->kind) {
+        case AMX_ROW_SOFTMAX:   row_softmax(x, r->cols); break;
+        case AMX_ROW_LAYERNORM: row_layernorm(r, x, r->cols); break;
+        case AMX_ROW_RMSNORM:   row_rmsnorm(r, x, r->cols, r->stride); break;
+        }
+    }
+}
+
+// SgemmEpilogue form for a whole-row SGEMM: the tile ending at the last
+// column completes its rows
+static void row_op_epilogue(const void *ctx, size_t i0, size_t i1, size_t j0, size_t j1) {
+    (void)j0;
+    const RowOp *r = (const RowOp *)ctx;
+    if (j1 == r->cols) row_op_rows(r, i0, i1);
+}
+
+static void row_op_task_body(void *ctx, size_t t) {
+    const RowOp *r = (const RowOp *)ctx;
+    const size_t i0 = t * r->rows_per_task;
+    if (i0 >= r->rows) return;
+    const size_t i1 = (i0 + r->rows_per_task <= r->rows) ? i0 + r->rows_per_task : r->rows;
+    row_op_rows(r, i0, i1);
+}
+
+// Validate op and bind it to m's storage
+static bool row_op_init(RowOp *r, const AmxRowOp *op, AmxMatrix *m) {
+    if (UNLIKELY(!op || (unsigned)op->kind > AMX_ROW_RMSNORM)) return false;
+    *r = (RowOp){
+        .kind = op->kind, .gamma = op->gamma, .beta = op->beta,
+        .eps = op->eps > 0.0f ? op->eps : ROW_OP_EPS,
+        .data = m->data, .rows = m->rows, .cols = m->cols, .stride = m->stride
+    };
+    return true;
+}
+
+bool amx_matrix_row_op(AmxMatrix *m, const AmxRowOp *op) {
+    RowOp r;
+    if (UNLIKELY(!m || !row_op_init(&r, op, m))) return false;
+    
+    const size_t workers = (size_t)num_workers();
+    if (m->rows * m->stride < EW_PARALLEL_MIN || workers == 1 || m->rows == 1) {
+        row_op_rows(&r, 0, m->rows);
+        return true;
+    }
+    
+    r.rows_per_task = (m->rows + workers - 1) / workers;
+    parallel_for((m->rows + r.rows_per_task - 1) / r.rows_per_task, &r, row_op_task_body);
+    return true;
+}
+
+AmxMatrix *amx_matrix_matmul_row_op(const AmxMatrix *a, const AmxMatrix *b, const AmxRowOp *op) {
+    if (UNLIKELY(!a || !b || !op || a->cols != b->rows)) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    RowOp r;
+    if (UNLIKELY(!row_op_init(&r, op, c))) {
+        amx_matrix_free(c);
+        return NULL;
+    }
+    
+    const Sgemm g = {
+        .A = a->data, .lda = a->stride, .trans_a = false,
+        .B = b->data, .ldb = b->stride, .trans_b = false,
+        .C = c->data, .ldc = c->stride,
+        .M = c->rows, .N = c->cols, .K = a->cols,
+        .alpha = 1.0f, .beta = 0.0f,
+        .epilogue = row_op_epilogue, .epilogue_ctx = &r,
+        .whole_rows = true
+    };
+    sgemm_run(&g);
+    return c;
+}
+
+bool amx_matrix_softmax(AmxMatrix *m) {
+    const AmxRowOp op = { .kind = AMX_ROW_SOFTMAX };
+    return amx_matrix_row_op(m, &op);
+}
+
+bool amx_matrix_layernorm(AmxMatrix *m, const float *gamma, const float *beta, float eps) {
+    const AmxRowOp op = { .kind = AMX_ROW_LAYERNORM, .gamma = gamma, .beta = beta, .eps = eps };
+    return amx_matrix_row_op(m, &op);
+}
+
+bool amx_matrix_rmsnorm(AmxMatrix *m, const float *gamma, float eps) {
+    const AmxRowOp op = { .kind = AMX_ROW_RMSNORM, .gamma = gamma, .eps = eps };
+    return amx_matrix_row_op(m, &op);
+}
+
+// ============================================================================
+// Triangular Solves
+// ----------------------------------------------------------------------------
+// op(T) * X = B in place for triangular n x n T and n x nrhs B. Blocks of
+// TRSM_NB rows are solved by substitution, each row update vectorized across
+// the right-hand sides; the update of the remaining rows is one SGEMM, with
+// T^T read in place through the engine's transposed-A path.
+//
+// X * op(T) = B runs the same blocking over columns of B. Right-hand sides
+// are independent, so large B is also split into strips (columns on the
+// left, rows on the right) that are solved in parallel with serial GEMMs.
+// ============================================================================
+
+#define TRSM_NB 128
+#define TRSM_STRIP_MIN 64           // Minimum right-hand sides per parallel strip
+
+// op(T)[i][p]
+ALWAYS_INLINE static float trsm_elem(const float *t, size_t ldt, bool trans, size_t i, size_t p) {
+    return trans ? t[p * ldt + i] : t[i * ldt + p];
+}
+
+// Substitution on an n x n diagonal block; forward when op(T) is lower
+static void trsm_diag_block(
+    const float *t, size_t ldt, size_t n, bool forward, bool trans, bool unit,
+    float *b, size_t ldb, size_t nrhs
+) {
+    for (size_t s = 0; s < n; ++s) {
+        const size_t i = forward ? s : n - 1 - s;
+        float *RESTRICT bi = b + i * ldb;
+        for (size_t q = 0; q < s; ++q) {
+            const size_t p = forward ? q : n - 1 - q;
+            const float tip = trsm_elem(t, ldt, trans, i, p);
+            const float *RESTRICT bp = b + p * ldb;
+            for (size_t j = 0; j < nrhs; ++j) bi[j] -= tip * bp[j];
+        }
+        if (!unit) {
+            const float inv = 1.0f / t[i * ldt + i];
+            for (size_t j = 0; j < nrhs; ++j) bi[j] *= inv;
+        }
+    }
+}
+
+static void trsm_left(
+    const float *t, size_t ldt, size_t n, bool upper, bool trans, bool unit,
+    float *b, size_t ldb, size_t nrhs, bool serial
+) {
+    const bool forward = upper == trans;    // op(T) is lower triangular
+    const size_t blocks = (n + TRSM_NB - 1) / TRSM_NB;
+    
+    for (size_t s = 0; s < blocks; ++s) {
+        const size_t k = (forward ? s : blocks - 1 - s) * TRSM_NB;
+        const size_t nb = (k + TRSM_NB <= n) ? TRSM_NB : n - k;
+        trsm_diag_block(t + k * ldt + k, ldt, nb, forward, trans, unit, b + k * ldb, ldb, nrhs);
+        
+        // Rows still to solve: below the block going forward, above it going back
+        const size_t r0 = forward ? k + nb : 0;
+        const size_t rows = forward ? n - k - nb : k;
+        if (rows == 0) continue;
+        
+        // B[r0:r0+rows] -= op(T)[r0:r0+rows, k:k+nb] * X[k:k+nb]
+        const Sgemm g = {
+            .A = trans ? t + k * ldt + r0 : t + r0 * ldt + k, .lda = ldt, .trans_a = trans,
+            .B = b + k * ldb, .ldb = ldb, .trans_b = false,
+            .C = b + r0 * ldb, .ldc = ldb,
+            .M = rows, .N = nrhs, .K = nb,
+            .alpha = -1.0f, .beta = 1.0f,
+            .serial = serial
+        };
+        sgemm_run(&g);
+    }
+}
+
+// Row-wise substitution for X * op(T) = B on an n x n diagonal block; forward
+// when op(T) is upper. Each row of B is an independent right-hand side: with
+// T as stored the solved entry is pushed along a contiguous row of T, with
+// T^T the next entry is a dot product along a contiguous row of T.
+static void trsm_diag_block_right(
+    const float *t, size_t ldt, size_t n, bool forward, bool trans, bool unit,
+    float *b, size_t ldb, size_t m
+) {
+    for (size_t r = 0; r < m; ++r) {
+        float *RESTRICT x = b + r * ldb;
+        for (size_t s = 0; s < n; ++s) {
+            const size_t j = forward ? s : n - 1 - s;
+            const float *RESTRICT t_j = t + j * ldt;
+            if (trans) {
+                // x[j] -= sum over solved p of x[p] * T[j][p]
+                float v = x[j];
+                if (forward) {
+                    for (size_t p = 0; p < j; ++p) v -= x[p] * t_j[p];
+                } else {
+                    for (size_t p = j + 1; p < n; ++p) v -= x[p] * t_j[p];
+                }
+                x[j] = unit ? v : v / t_j[j];
+            } else {
+                // Entries of this row were updated as earlier ones were solved
+                if (!unit) x[j] /= t_j[j];
+                const float xj = x[j];
+                if (forward) {
+                    for (size_t q = j + 1; q < n; ++q) x[q] -= xj * t_j[q];
+                } else {
+                    for (size_t q = 0; q < j; ++q) x[q] -= xj * t_j[q];
+                }
+            }
+        }
+    }
+}
+
+static void trsm_right(
+    const float *t, size_t ldt, size_t n, bool upper, bool trans, bool unit,
+    float *b, size_t ldb, size_t m, bool serial
+) {
+    const bool forward = upper != trans;    // op(T) is upper triangular
+    const size_t blocks = (n + TRSM_NB - 1) / TRSM_NB;
+    
+    for (size_t s = 0; s < blocks; ++s) {
+        const size_t k = (forward ? s : blocks - 1 - s) * TRSM_NB;
+        const size_t nb = (k + TRSM_NB <= n) ? TRSM_NB : n - k;
+        trsm_diag_block_right(t + k * ldt + k, ldt, nb, forward, trans, unit, b + k, ldb, m);
+        
+        // Columns still to solve: right of the block going forward, left of it going back
+        const size_t c0 = forward ? k + nb : 0;
+        const size_t cols = forward ? n - k - nb : k;
+        if (cols == 0) continue;
+        
+        // B[:, c0:c0+cols] -= X[:, k:k+nb] * op(T)[k:k+nb, c0:c0+cols]
+        const Sgemm g = {
+            .A = b + k, .lda = ldb, .trans_a = false,
+            .B = trans ? t + c0 * ldt + k : t + k * ldt + c0, .ldb = ldt, .trans_b = trans,
+            .C = b + c0, .ldc = ldb,
+            .M = m, .N = cols, .K = nb,
+            .alpha = -1.0f, .beta = 1.0f,
+            .serial = serial
+        };
+        sgemm_run(&g);
+    }
+}
+
+typedef struct {
+    const float *t;
+    size_t ldt, n;
+    bool right, upper, trans, unit;
+    float *b;
+    size_t ldb;
+    size_t count;               // Right-hand sides: columns of B on the left, rows on the right
+    size_t strip;
+} TrsmStrips;
+
+static void trsm_strip_task_body(void *ctx, size_t s) {
+    const TrsmStrips *job = (const TrsmStrips *)ctx;
+    const size_t r0 = s * job->strip;
+    const size_t count = (r0 + job->strip <= job->count) ? job->strip : job->count - r0;
+    
+    if (job->right) trsm_right(job->t, job->ldt, job->n, job->upper, job->trans, job->unit, job->b + r0 * job->ldb, job->ldb, count, true);
+    else trsm_left(job->t, job->ldt, job->n, job->upper, job->trans, job->unit, job->b + r0, job->ldb, count, true);
+}
+
+// Solve with the right-hand sides split across workers when there are enough
+// of them; otherwise one solve whose GEMM updates parallelize internally.
+static void trsm_run(
+    bool right, const float *t, size_t ldt, size_t n, bool upper, bool trans, bool unit,
+    float *b, size_t ldb, size_t count
+) {
+    size_t strips = count / TRSM_STRIP_MIN;
+    const size_t workers = (size_t)num_workers();
+    if (strips > workers) strips = workers;
+    
+    if (strips <= 1) {
+        if (right) trsm_right(t, ldt, n, upper, trans, unit, b, ldb, count, false);
+        else trsm_left(t, ldt, n, upper, trans, unit, b, ldb, count, false);
+        return;
+    }
+    
+    // Column strips stay a whole number of 16-float tiles wide
+    size_t strip = (count + strips - 1) / strips;
+    if (!right) strip = round_up(strip, 16);
+    TrsmStrips job = {
+        .t = t, .ldt = ldt, .n = n,
+        .right = right, .upper = upper, .trans = trans, .unit = unit,
+        .b = b, .ldb = ldb, .count = count, .strip = strip
+    };
+    parallel_for((count + strip - 1) / strip, &job, trsm_strip_task_body);
+}
+
+bool amx_matrix_trsm(AmxSide side, AmxTriangle uplo, AmxTranspose trans, AmxDiag diag,
+                     const AmxMatrix *t, AmxMatrix *b) {
+    if (UNLIKELY(!t || !b || t->rows != t->cols)) return false;
+    
+    const bool right = side == AMX_RIGHT;
+    const size_t n = t->rows;
+    if (UNLIKELY((right ? b->cols : b->rows) != n)) return false;
+    
+    const size_t count = right ? b->rows : b->cols;
+    if (n == 0 || count == 0) return true;
+    
+    trsm_run(right, t->data, t->stride, n, uplo == AMX_UPPER, trans == AMX_TRANS, diag == AMX_UNIT,
+             b->data, b->stride, count);
+    return true;
+}
+
+// ============================================================================
+// Symmetric Rank-k Update
+// ----------------------------------------------------------------------------
+// C = alpha * A * A^T + beta * C (or A^T * A) as one SGEMM over a triangular
+// C: both operands are views of the same buffer, and tiles past the diagonal
+// are never scheduled. Mirroring copies the computed triangle across with the
+// transpose kernels, one destination row block per task.
+// ============================================================================
+
+typedef struct {
+    float *c;
+    size_t ldc, n;
+    bool from_lower;            // Source triangle
+} SymMirror;
+
+static void sym_mirror_task_body(void *ctx, size_t b) {
+    const SymMirror *m = (const SymMirror *)ctx;
+    const size_t n = m->n, ldc = m->ldc;
+    const size_t i0 = b * TRANSPOSE_LEAF;
+    const size_t i1 = (i0 + TRANSPOSE_LEAF <= n) ? i0 + TRANSPOSE_LEAF : n;
+    
+    // Off-diagonal blocks of destination rows [i0, i1) come from columns [i0, i1)
+    const size_t j_begin = m->from_lower ? i1 : 0;
+    const size_t j_end = m->from_lower ? n : i0;
+    for (size_t j0 = j_begin; j0 < j_end; j0 += TRANSPOSE_LEAF) {
+        const size_t j1 = (j0 + TRANSPOSE_LEAF <= j_end) ? j0 + TRANSPOSE_LEAF : j_end;
+        transpose_leaf(m->c + j0 * ldc + i0, ldc, m->c + i0 * ldc + j0, ldc, j1 - j0, i1 - i0);
+    }
+    
+    for (size_t i = i0; i < i1; ++i) {
+        float *RESTRICT row = m->c + i * ldc;
+        if (m->from_lower) {
+            for (size_t j = i + 1; j < i1; ++j) row[j] = m->c[j * ldc + i];
+        } else {
+            for (size_t j = i0; j < i; ++j) row[j] = m->c[j * ldc + i];
+        }
+    }
+}
+
+// Copy one strict triangle of the n x n matrix at c onto the other
+static void sym_mirror(float *c, size_t ldc, size_t n, bool from_lower) {
+    SymMirror m = { .c = c, .ldc = ldc, .n = n, .from_lower = from_lower };
+    const size_t blocks = (n + TRANSPOSE_LEAF - 1) / TRANSPOSE_LEAF;
+    if (n * n < TRANSPOSE_PARALLEL_MIN) {
+        for (size_t b = 0; b < blocks; ++b) sym_mirror_task_body(&m, b);
+    } else {
+        parallel_for(blocks, &m, sym_mirror_task_body);
+    }
+}
+
+bool amx_matrix_syrk(AmxTriangle uplo, AmxTranspose trans, float alpha, const AmxMatrix *a,
+                     float beta, AmxMatrix *c, bool mirror) {
+    if (UNLIKELY(!a || !c)) return false;
+    
+    const bool t = trans == AMX_TRANS;
+    const size_t n = t ? a->cols : a->rows;
+    if (UNLIKELY(c->rows != n || c->cols != n)) return false;
+    
+    // op(A) * op(A)^T: with A as given the second operand is read transposed in place
+    const Sgemm g = {
+        .A = a->data, .lda = a->stride, .trans_a = t,
+        .B = a->data, .ldb = a->stride, .trans_b = !t,
+        .C = c->data, .ldc = c->stride,
+        .M = n, .N = n, .K = t ? a->rows : a->cols,
+        .alpha = alpha, .beta = beta,
+        .tri = uplo == AMX_UPPER ? SGEMM_UPPER : SGEMM_LOWER
+    };
+    sgemm_run(&g);
+    
+    if (mirror) sym_mirror(c->data, c->stride, n, uplo == AMX_LOWER);
+    return true;
+}
+
+AmxMatrix *amx_matrix_gram(const AmxMatrix *a, AmxTranspose trans) {
+    if (UNLIKELY(!a)) return NULL;
+    
+    const size_t n = trans == AMX_TRANS ? a->cols : a->rows;
+    AmxMatrix *c = amx_matrix_zeros(n, n);
+    if (UNLIKELY(!c)) return NULL;
+    
+    amx_matrix_syrk(AMX_LOWER, trans, 1.0f, a, 0.0f, c, true);
+    return c;
+}
+
+// ============================================================================
+// Cholesky Factorization
+// ----------------------------------------------------------------------------
+// Right-looking blocked A = L * L^T, in place on the lower triangle. Each
+// step factors a CHOL_NB diagonal block with a small scalar kernel (double
+// accumulation), solves the panel below it row by row across workers, and
+// updates the lower tile triangle of the trailing matrix with one SGEMM on
+// strided views:
+//   A22 -= L21 * L21^T
+// ============================================================================
+
+#define CHOL_NB 128
+#define CHOL_PANEL_ROWS 64          // Panel rows per task
+
+// Unblocked factor of the n x n block at a; returns 0 or the failing column + 1
+static size_t chol_factor_block(float *a, size_t lda, size_t n) {
+    for (size_t j = 0; j < n; ++j) {
+        float *RESTRICT row_j = a + j * lda;
+        double d = row_j[j];
+        for (size_t p = 0; p < j; ++p) d -= (double)row_j[p] * row_j[p];
+        if (!(d > 0.0)) return j + 1;
+        
+        const float ljj = (float)sqrt(d);
+        row_j[j] = ljj;
+        for (size_t i = j + 1; i < n; ++i) {
+            float *RESTRICT row_i = a + i * lda;
+            double v = row_i[j];
+            for (size_t p = 0; p < j; ++p) v -= (double)row_i[p] * row_j[p];
+            row_i[j] = (float)(v / ljj);
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    const float *l11;           // Factored diagonal block
+    float *panel;               // Rows below it, same columns
+    size_t lda;
+    size_t rows, nb;
+} CholPanel;
+
+// panel := panel * L11^-T, one row at a time: x[j] = (a[j] - x[0..j) . L11[j][0..j)) / L11[j][j]
+static void chol_panel_task_body(void *ctx, size_t t) {
+    const CholPanel *c = (const CholPanel *)ctx;
+    const size_t i0 = t * CHOL_PANEL_ROWS;
+    const size_t i1 = (i0 + CHOL_PANEL_ROWS <= c->rows) ? i0 + CHOL_PANEL_ROWS : c->rows;
+    
+    for (size_t i = i0; i < i1; ++i) {
+        float *RESTRICT x = c->panel + i * c->lda;
+        for (size_t j = 0; j < c->nb; ++j) {
+            const float *RESTRICT l_j = c->l11 + j * c->lda;
+            float v = x[j];
+            for (size_t p = 0; p < j; ++p) v -= x[p] * l_j[p];
+            x[j] = v / l_j[j];
+        }
+    }
+}
+
+int amx_matrix_cholesky(AmxMatrix *a) {
+    if (UNLIKELY(!a || a->rows != a->cols)) return -1;
+    
+    const size_t n = a->rows, lda = a->stride;
+    float *base = a->data;
+    
+    for (size_t k = 0; k < n; k += CHOL_NB) {
+        const size_t nb = (k + CHOL_NB <= n) ? CHOL_NB : n - k;
+        float *a11 = base + k * lda + k;
+        
+        const size_t fail = chol_factor_block(a11, lda, nb);
+        if (fail) return (int)(k + fail);
+        
+        const size_t rest = n - k - nb;
+        if (rest == 0) break;
+        
+        CholPanel panel = { .l11 = a11, .panel = a11 + nb * lda, .lda = lda, .rows = rest, .nb = nb };
+        const size_t tasks = (rest + CHOL_PANEL_ROWS - 1) / CHOL_PANEL_ROWS;
+        if (tasks == 1) chol_panel_task_body(&panel, 0);
+        else parallel_for(tasks, &panel, chol_panel_task_body);
+        
+        const Sgemm g = {
+            .A = panel.panel, .lda = lda, .trans_a = false,
+            .B = panel.panel, .ldb = lda, .trans_b = true,
+            .C = a11 + nb * lda + nb, .ldc = lda,
+            .M = rest, .N = rest, .K = nb,
+            .alpha = -1.0f, .beta = 1.0f,
+            .tri = SGEMM_LOWER
+        };
+        sgemm_run(&g);
+    }
+    
+    // The trailing updates also touched the upper triangle; leave exactly L
+    for (size_t i = 0; i < n; ++i) memset(base + i * lda + i + 1, 0, (n - i - 1) * sizeof(float));
+    return 0;
+}
+
+bool amx_matrix_cholesky_solve(const AmxMatrix *l, AmxMatrix *b) {
+    if (UNLIKELY(!l || !b || l->rows != l->cols || b->rows != l->rows)) return false;
+    
+    trsm_run(false, l->data, l->stride, l->rows, false, false, false, b->data, b->stride, b->cols);
+    trsm_run(false, l->data, l->stride, l->rows, false, true, false, b->data, b->stride, b->cols);
+    return true;
+}
+
+// ============================================================================
+// LU Factorization
+// ----------------------------------------------------------------------------
+// Right-looking blocked P * A = L * U with partial pivoting. Each LU_NB-wide
+// panel is factored recursively: the left half, then its row swaps and a
+// unit-lower solve on the right half, an SGEMM update of the rest of the
+// panel, the right half, and finally its swaps on the left half. Narrow
+// panels drop to a column-by-column kernel. Outside the panel, row swaps run
+// in column strips across workers, U12 comes from a triangular solve and the
+// trailing update A22 -= L21 * U12 is one SGEMM, which carries nearly all
+// the FLOPs for large matrices.
+// ============================================================================
+
+#define LU_NB 128
+#define LU_LEAF 16                  // Panel width factored column by column
+#define LU_SWAP_STRIP 256           // Columns per row-swap task
+
+typedef struct {
+    float *a;
+    size_t lda;
+    size_t c0, c1;              // Columns to permute
+    size_t r0, r1;              // Pivot rows to apply, in order
+    const size_t *pivots;
+} LuSwap;
+
+static void lu_swap_cols(const LuSwap *w, size_t c0, size_t c1) {
+    for (size_t r = w->r0; r < w->r1; ++r) {
+        const size_t p = w->pivots[r];
+        if (p == r) continue;
+        float *RESTRICT x = w->a + r * w->lda, *RESTRICT y = w->a + p * w->lda;
+        for (size_t j = c0; j < c1; ++j) {
+            const float t = x[j];
+            x[j] = y[j];
+            y[j] = t;
+        }
+    }
+}
+
+static void lu_swap_task_body(void *ctx, size_t t) {
+    const LuSwap *w = (const LuSwap *)ctx;
+    const size_t c0 = w->c0 + t * LU_SWAP_STRIP;
+    const size_t c1 = (c0 + LU_SWAP_STRIP <= w->c1) ? c0 + LU_SWAP_STRIP : w->c1;
+    lu_swap_cols(w, c0, c1);
+}
+
+// Apply pivots[r0..r1) to columns [c0, c1)
+static void lu_swap(float *a, size_t lda, size_t c0, size_t c1, size_t r0, size_t r1, const size_t *pivots) {
+    if (c0 >= c1) return;
+    const LuSwap w = { .a = a, .lda = lda, .c0 = c0, .c1 = c1, .r0 = r0, .r1 = r1, .pivots = pivots };
+    const size_t strips = (c1 - c0 + LU_SWAP_STRIP - 1) / LU_SWAP_STRIP;
+    if (strips == 1) lu_swap_cols(&w, c0, c1);
+    else parallel_for(strips, (void *)&w, lu_swap_task_body);
+}
+
+// Column-by-column factor of rows [c0, m), columns [c0, c1); swaps stay inside the panel
+static void lu_panel_leaf(float *a, size_t lda, size_t m, size_t c0, size_t c1, size_t *pivots, size_t *info) {
+    for (size_t j = c0; j < c1; ++j) {
+        size_t p = j;
+        float best = fabsf(a[j * lda + j]);
+        for (size_t i = j + 1; i < m; ++i) {
+            const float v = fabsf(a[i * lda + j]);
+            if (v > best) { best = v; p = i; }
+        }
+        pivots[j] = p;
+        
+        if (p != j) {
+            float *RESTRICT x = a + j * lda, *RESTRICT y = a + p * lda;
+            for (size_t c = c0; c < c1; ++c) {
+                const float t = x[c];
+                x[c] = y[c];
+                y[c] = t;
+            }
+        }
+        
+        const float *RESTRICT row_j = a + j * lda;
+        const float pivot = row_j[j];
+        if (pivot == 0.0f) {
+            if (!*info) *info = j + 1;
+            continue;
+        }
+        
+        const float inv = 1.0f / pivot;
+        for (size_t i = j + 1; i < m; ++i) {
+            float *RESTRICT row_i = a + i * lda;
+            const float l = row_i[j] *= inv;
+            for (size_t c = j + 1; c < c1; ++c) row_i[c] -= l * row_j[c];
+        }
+    }
+}
+
+static void lu_panel(float *a, size_t lda, size_t m, size_t c0, size_t c1, size_t *pivots, size_t *info) {
+    if (c1 - c0 <= LU_LEAF) {
+        lu_panel_leaf(a, lda, m, c0, c1, pivots, info);
+        return;
+    }
+    
+    const size_t h = c0 + (c1 - c0) / 2;
+    lu_panel(a, lda, m, c0, h, pivots, info);
+    
+    // Right half: swaps from the left, U12 = L11^-1 A12, A22 -= L21 * U12
+    lu_swap(a, lda, h, c1, c0, h, pivots);
+    trsm_left(a + c0 * lda + c0, lda, h - c0, false, false, true, a + c0 * lda + h, lda, c1 - h, false);
+    const Sgemm g = {
+        .A = a + h * lda + c0, .lda = lda, .trans_a = false,
+        .B = a + c0 * lda + h, .ldb = lda, .trans_b = false,
+        .C = a + h * lda + h, .ldc = lda,
+        .M = m - h, .N = c1 - h, .K = h - c0,
+        .alpha = -1.0f, .beta = 1.0f
+    };
+    sgemm_run(&g);
+    
+    lu_panel(a, lda, m, h, c1, pivots, info);
+    lu_swap(a, lda, c0, h, h, c1, pivots);
+}
+
+int amx_matrix_lu(AmxMatrix *a, size_t *pivots) {
+    if (UNLIKELY(!a || !pivots)) return -1;
+    
+    const size_t m = a->rows, n = a->cols, lda = a->stride;
+    const size_t kmax = m < n ? m : n;
+    float *base = a->data;
+    size_t info = 0;
+    
+    for (size_t k = 0; k < kmax; k += LU_NB) {
+        const size_t nb = (k + LU_NB <= kmax) ? LU_NB : kmax - k;
+        lu_panel(base, lda, m, k, k + nb, pivots, &info);
+        
+        // Panel swaps on the columns left and right of it
+        lu_swap(base, lda, 0, k, k, k + nb, pivots);
+        lu_swap(base, lda, k + nb, n, k, k + nb, pivots);
+        if (k + nb >= n) continue;
+        
+        trsm_left(base + k * lda + k, lda, nb, false, false, true, base + k * lda + k + nb, lda, n - k - nb, false);
+        if (k + nb < m) {
+            const Sgemm g = {
+                .A = base + (k + nb) * lda + k, .lda = lda, .trans_a = false,
+                .B = base + k * lda + k + nb, .ldb = lda, .trans_b = false,
+                .C = base + (k + nb) * lda + k + nb, .ldc = lda,
+                .M = m - k - nb, .N = n - k - nb, .K = nb,
+                .alpha = -1.0f, .beta = 1.0f
+            };
+            sgemm_run(&g);
+        }
+    }
+    return (int)info;
+}
+
+bool amx_matrix_lu_solve(const AmxMatrix *lu, const size_t *pivots, AmxMatrix *b) {
+    if (UNLIKELY(!lu || !pivots || !b || lu->rows != lu->cols || b->rows != lu->rows)) return false;
+    
+    const size_t n = lu->rows;
+    lu_swap(b->data, b->stride, 0, b->cols, 0, n, pivots);
+    trsm_run(false, lu->data, lu->stride, n, false, false, true, b->data, b->stride, b->cols);
+    trsm_run(false, lu->data, lu->stride, n, true, false, false, b->data, b->stride, b->cols);
+    return true;
+}
+
+AmxMatrix *amx_matrix_solve(const AmxMatrix *a, const AmxMatrix *b) {
+    if (UNLIKELY(!a || !b || a->rows != a->cols || b->rows != a->rows)) return NULL;
+    
+    AmxMatrix *lu = amx_matrix_clone(a);
+    AmxMatrix *x = amx_matrix_clone(b);
+    size_t *pivots = malloc(a->rows * sizeof(size_t));
+    bool ok = lu && x && pivots && amx_matrix_lu(lu, pivots) == 0 && amx_matrix_lu_solve(lu, pivots, x);
+    
+    free(pivots);
+    amx_matrix_free(lu);
+    if (UNLIKELY(!ok)) {
+        amx_matrix_free(x);
+        return NULL;
+    }
+    return x;
+}
+
+// ============================================================================
+// QR Factorization
+// ----------------------------------------------------------------------------
+// Blocked Householder QR. A QR_NB-wide panel is factored column by column;
+// its reflectors H_i = I - tau_i * v_i * v_i^T are then combined into the
+// compact WY form H_1 ... H_nb = I - V * T * V^T (T upper triangular, built
+// from the Gram matrix V^T * V), and the trailing columns get
+//   C -= V * (T^T * (V^T * C))
+// as three SGEMMs. Forming Q runs the same block update backwards.
+//
+// TSQR splits a tall matrix into row blocks factored independently across
+// workers (their GEMMs stay on the worker thread), stacks the small R
+// factors and factors the stack once more. Least squares runs this on
+// [A | B], whose R holds both R and the first n rows of Q^T * B.
+// ============================================================================
+
+#define QR_NB 32
+#define TSQR_MIN_ROWS 4             // Row blocks have at least this many rows per column
+
+// Unblocked QR of an m x nb panel; w holds nb floats
+static void qr_panel(float *a, size_t lda, size_t m, size_t nb, float *tau, float *w) {
+    for (size_t j = 0; j < nb && j < m; ++j) {
+        float *RESTRICT row_j = a + j * lda;
+        const double alpha = row_j[j];
+        double xnorm = 0.0;
+        for (size_t i = j + 1; i < m; ++i) xnorm += (double)a[i * lda + j] * a[i * lda + j];
+        if (xnorm == 0.0) {
+            tau[j] = 0.0f;
+            continue;
+        }
+        
+        const double beta = -copysign(sqrt(alpha * alpha + xnorm), alpha);
+        const float t = (float)((beta - alpha) / beta);
+        const float scale = (float)(1.0 / (alpha - beta));
+        tau[j] = t;
+        row_j[j] = (float)beta;
+        for (size_t i = j + 1; i < m; ++i) a[i * lda + j] *= scale;
+        
+        // Columns right of j in the panel: A -= tau * v * (v^T * A), with v[j] = 1
+        const size_t c0 = j + 1;
+        if (c0 == nb) continue;
+        for (size_t c = c0; c < nb; ++c) w[c] = row_j[c];
+        for (size_t i = j + 1; i < m; ++i) {
+            const float *RESTRICT row_i = a + i * lda;
+            const float v = row_i[j];
+            for (size_t c = c0; c < nb; ++c) w[c] += v * row_i[c];
+        }
+        for (size_t c = c0; c < nb; ++c) {
+            w[c] *= t;
+            row_j[c] -= w[c];
+        }
+        for (size_t i = j + 1; i < m; ++i) {
+            float *RESTRICT row_i = a + i * lda;
+            const float v = row_i[j];
+            for (size_t c = c0; c < nb; ++c) row_i[c] -= v * w[c];
+        }
+    }
+}
+
+typedef struct {
+    float *v;                   // m x QR_NB explicit reflectors (unit diagonal, zeros above)
+    float *t;                   // QR_NB x QR_NB
+    float *gram;                // QR_NB x QR_NB
+    float *w, *w2;              // QR_NB x n
+} QrWork;
+
+static bool qr_work_alloc(QrWork *q, size_t m, size_t n) {
+    q->v = malloc(m * QR_NB * sizeof(float));
+    q->t = malloc(QR_NB * QR_NB * sizeof(float));
+    q->gram = malloc(QR_NB * QR_NB * sizeof(float));
+    q->w = malloc(QR_NB * n * sizeof(float));
+    q->w2 = malloc(QR_NB * n * sizeof(float));
+    return q->v && q->t && q->gram && q->w && q->w2;
+}
+
+static void qr_work_free(QrWork *q) {
+    free(q->v);
+    free(q->t);
+    free(q->gram);
+    free(q->w);
+    free(q->w2);
+}
+
+// Copy the panel's reflectors into q->v and build T with H_1 ... H_nb = I - V T V^T
+static void qr_block_reflector(QrWork *q, const float *a, size_t lda, size_t m, size_t nb, const float *tau, bool serial) {
+    for (size_t r = 0; r < m; ++r) {
+        float *RESTRICT dst = q->v + r * nb;
+        for (size_t c = 0; c < nb; ++c) dst[c] = r > c ? a[r * lda + c] : (r == c ? 1.0f : 0.0f);
+    }
+    
+    const Sgemm g = {
+        .A = q->v, .lda = nb, .trans_a = true,
+        .B = q->v, .ldb = nb, .trans_b = false,
+        .C = q->gram, .ldc = nb,
+        .M = nb, .N = nb, .K = m,
+        .alpha = 1.0f, .beta = 0.0f, .serial = serial
+    };
+    sgemm_run(&g);
+    
+    // T[0:i, i] = -tau_i * T[0:i, 0:i] * (V[:, 0:i]^T * v_i)
+    float *t = q->t;
+    memset(t, 0, nb * nb * sizeof(float));
+    for (size_t i = 0; i < nb; ++i) {
+        t[i * nb + i] = tau[i];
+        for (size_t r = 0; r < i; ++r) {
+            float acc = 0.0f;
+            for (size_t p = r; p < i; ++p) acc += t[r * nb + p] * q->gram[p * nb + i];
+            t[r * nb + i] = -tau[i] * acc;
+        }
+    }
+}
+
+// C := (I - V T V^T) C, or with T^T when trans (applying Q^T); C is m x nc
+static void qr_apply_block(const QrWork *q, size_t m, size_t nb, bool trans, float *c, size_t ldc, size_t nc, bool serial) {
+    const Sgemm vt_c = {
+        .A = q->v, .lda = nb, .trans_a = true,
+        .B = c, .ldb = ldc, .trans_b = false,
+        .C = q->w, .ldc = nc,
+        .M = nb, .N = nc, .K = m,
+        .alpha = 1.0f, .beta = 0.0f, .serial = serial
+    };
+    sgemm_run(&vt_c);
+    
+    const Sgemm t_w = {
+        .A = q->t, .lda = nb, .trans_a = trans,
+        .B = q->w, .ldb = nc, .trans_b = false,
+        .C = q->w2, .ldc = nc,
+        .M = nb, .N = nc, .K = nb,
+        .alpha = 1.0f, .beta = 0.0f, .serial = serial
+    };
+    sgemm_run(&t_w);
+    
+    const Sgemm update = {
+        .A = q->v, .lda = nb, .trans_a = false,
+        .B = q->w2, .ldb = nc, .trans_b = false,
+        .C = c, .ldc = ldc,
+        .M = m, .N = nc, .K = nb,
+        .alpha = -1.0f, .beta = 1.0f, .serial = serial
+    };
+    sgemm_run(&update);
+}
+
+// In-place blocked QR of an m x n buffer; tau gets min(m, n) entries
+static bool qr_factor(float *a, size_t lda, size_t m, size_t n, float *tau, bool serial) {
+    QrWork q;
+    if (UNLIKELY(!qr_work_alloc(&q, m, n))) {
+        qr_work_free(&q);
+        return false;
+    }
+    
+    const size_t kmax = m < n ? m : n;
+    for (size_t k = 0; k < kmax; k += QR_NB) {
+        const size_t nb = (k + QR_NB <= kmax) ? QR_NB : kmax - k;
+        float *panel = a + k * lda + k;
+        qr_panel(panel, lda, m - k, nb, tau + k, q.w);
+        if (k + nb == n) continue;
+        
+        qr_block_reflector(&q, panel, lda, m - k, nb, tau + k, serial);
+        qr_apply_block(&q, m - k, nb, true, panel + nb, lda, n - k - nb, serial);
+    }
+    
+    qr_work_free(&q);
+    return true;
+}
+
+// New min(m, n) x n matrix holding the upper triangle of a factored buffer
+static AmxMatrix *qr_extract_r(const float *a, size_t lda, size_t m, size_t n) {
+    const size_t k = m < n ? m : n;
+    AmxMatrix *r = amx_matrix_zeros(k, n);
+    if (UNLIKELY(!r)) return NULL;
+    for (size_t i = 0; i < k; ++i) memcpy(r->data + i * r->stride + i, a + i * lda + i, (n - i) * sizeof(float));
+    return r;
+}
+
+typedef struct {
+    float *a;
+    size_t lda, m, n;
+    size_t rows_per_block;      // The last block also takes the remainder
+    size_t blocks;
+    float *tau;                 // n per block
+    atomic_bool failed;
+} TsqrJob;
+
+static void tsqr_task_body(void *ctx, size_t t) {
+    TsqrJob *job = (TsqrJob *)ctx;
+    const size_t i0 = t * job->rows_per_block;
+    const size_t rows = (t + 1 < job->blocks) ? job->rows_per_block : job->m - i0;
+    if (!qr_factor(job->a + i0 * job->lda, job->lda, rows, job->n, job->tau + t * job->n, true)) {
+        atomic_store_explicit(&job->failed, true, memory_order_relaxed);
+    }
+}
+
+// R factor of an m x n buffer, overwriting it
+static AmxMatrix *tsqr_r(float *a, size_t lda, size_t m, size_t n) {
+    const size_t workers = (size_t)num_workers();
+    size_t blocks = m / (TSQR_MIN_ROWS * n);
+    if (blocks > workers) blocks = workers;
+    
+    if (blocks < 2) {
+        float *tau = malloc(n * sizeof(float));
+        AmxMatrix *r = (tau && qr_factor(a, lda, m, n, tau, false)) ? qr_extract_r(a, lda, m, n) : NULL;
+        free(tau);
+        return r;
+    }
+    
+    TsqrJob job = { .a = a, .lda = lda, .m = m, .n = n, .rows_per_block = m / blocks, .blocks = blocks };
+    job.tau = malloc(blocks * n * sizeof(float));
+    if (UNLIKELY(!job.tau)) return NULL;
+    atomic_init(&job.failed, false);
+    parallel_for(blocks, &job, tsqr_task_body);
+    free(job.tau);
+    if (UNLIKELY(atomic_load_explicit(&job.failed, memory_order_relaxed))) return NULL;
+    
+    // Stack the block R factors and factor the stack
+    AmxMatrix *stack = amx_matrix_zeros(blocks * n, n);
+    if (UNLIKELY(!stack)) return NULL;
+    for (size_t b = 0; b < blocks; ++b) {
+        const float *block = a + b * job.rows_per_block * lda;
+        for (size_t i = 0; i < n; ++i) {
+            memcpy(stack->data + (b * n + i) * stack->stride + i, block + i * lda + i, (n - i) * sizeof(float));
+        }
+    }
+    AmxMatrix *r = tsqr_r(stack->data, stack->stride, stack->rows, n);
+    amx_matrix_free(stack);
+    return r;
+}
+
+bool amx_matrix_qr(AmxMatrix *a, float *tau) {
+    if (UNLIKELY(!a || !tau)) return false;
+    return qr_factor(a->data, a->stride, a->rows, a->cols, tau, false);
+}
+
+AmxMatrix *amx_matrix_qr_q(const AmxMatrix *qr, const float *tau) {
+    if (UNLIKELY(!qr || !tau)) return NULL;
+    
+    const size_t m = qr->rows, kmax = m < qr->cols ? m : qr->cols;
+    AmxMatrix *q = amx_matrix_zeros(m, kmax);
+    QrWork work = {0};
+    if (UNLIKELY(!q || !qr_work_alloc(&work, m, kmax))) {
+        amx_matrix_free(q);
+        qr_work_free(&work);
+        return NULL;
+    }
+    for (size_t i = 0; i < kmax; ++i) q->data[i * q->stride + i] = 1.0f;
+    
+    // Q = H_1 ... H_k * [I; 0]: blocks applied last to first, each to Q[k:, k:]
+    const size_t blocks = (kmax + QR_NB - 1) / QR_NB;
+    for (size_t b = blocks; b-- > 0;) {
+        const size_t k = b * QR_NB;
+        const size_t nb = (k + QR_NB <= kmax) ? QR_NB : kmax - k;
+        qr_block_reflector(&work, qr->data + k * qr->stride + k, qr->stride, m - k, nb, tau + k, false);
+        qr_apply_block(&work, m - k, nb, false, q->data + k * q->stride + k, q->stride, kmax - k, false);
+    }
+    
+    qr_work_free(&work);
+    return q;
+}
+
+AmxMatrix *amx_matrix_tsqr_r(const AmxMatrix *a) {
+    if (UNLIKELY(!a)) return NULL;
+    AmxMatrix *work = amx_matrix_clone(a);
+    if (UNLIKELY(!work)) return NULL;
+    AmxMatrix *r = tsqr_r(work->data, work->stride, work->rows, work->cols);
+    amx_matrix_free(work);
+    return r;
+}
+
+AmxMatrix *amx_matrix_lstsq(const AmxMatrix *a, const AmxMatrix *b) {
+    if (UNLIKELY(!a || !b || a->rows != b->rows || a->rows < a->cols)) return NULL;
+    
+    // Factor [A | B]; the top rows of its R are [R  Q^T B]
+    const size_t m = a->rows, n = a->cols, nrhs = b->cols;
+    AmxMatrix *aug = amx_matrix_zeros(m, n + nrhs);
+    if (UNLIKELY(!aug)) return NULL;
+    for (size_t i = 0; i < m; ++i) {
+        memcpy(aug->data + i * aug->stride, a->data + i * a->stride, n * sizeof(float));
+        memcpy(aug->data + i * aug->stride + n, b->data + i * b->stride, nrhs * sizeof(float));
+    }
+    AmxMatrix *r = tsqr_r(aug->data, aug->stride, m, n + nrhs);
+    amx_matrix_free(aug);
+    if (UNLIKELY(!r)) return NULL;
+    
+    // Rounding leaves a dependent column a tiny diagonal rather than an exact
+    // zero, so compare against the largest one
+    float rmax = 0.0f;
+    for (size_t i = 0; i < n; ++i) rmax = fmaxf(rmax, fabsf(r->data[i * r->stride + i]));
+    const float tol = (float)m * FLT_EPSILON * rmax;
+    
+    AmxMatrix *x = amx_matrix_zeros(n, nrhs);
+    bool ok = x != NULL;
+    for (size_t i = 0; ok && i < n; ++i) ok = fabsf(r->data[i * r->stride + i]) > tol;
+    if (LIKELY(ok)) {
+        for (size_t i = 0; i < n; ++i) memcpy(x->data + i * x->stride, r->data + i * r->stride + n, nrhs * sizeof(float));
+        trsm_run(false, r->data, r->stride, n, true, false, false, x->data, x->stride, nrhs);
+    }
+    amx_matrix_free(r);
+    if (UNLIKELY(!ok)) {
+        amx_matrix_free(x);
+        return NULL;
+    }
+    return x;
+}
+
+// ============================================================================
+// Half Precision (f16)
+// ============================================================================
+
+#define AMX_TILE_F16  32          // 32 halves = 64 bytes
+
+ALWAYS_INLINE static uint32_t f32_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+ALWAYS_INLINE static float f32_from_bits(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Branch-light scalar conversions (round to nearest even, NaN/Inf/subnormal
+// preserved). The float arithmetic does the rounding for us.
+static uint16_t f16_from_f32_scalar(float f) {
+    float base = (__builtin_fabsf(f) * 0x1.0p+112f) * 0x1.0p-110f;
+    const uint32_t w = f32_bits(f);
+    const uint32_t shl1_w = w + w;
+    const uint32_t sign = w & 0x80000000u;
+    uint32_t bias = shl1_w & 0xFF000000u;
+    if (bias < 0x71000000u) bias = 0x71000000u;
+    
+    base = f32_from_bits((bias >> 1) + 0x07800000u) + base;
+    const uint32_t bits = f32_bits(base);
+    const uint32_t exp_bits = (bits >> 13) & 0x00007C00u;
+    const uint32_t mantissa_bits = bits & 0x00000FFFu;
+    const uint32_t nonsign = exp_bits + mantissa_bits;
+    return (uint16_t)((sign >> 16) | (shl1_w > 0xFF000000u ? 0x7E00u : nonsign));
+}
+
+static float f16_to_f32_scalar(uint16_t h) {
+    const uint32_t w = (uint32_t)h << 16;
+    const uint32_t sign = w & 0x80000000u;
+    const uint32_t two_w = w + w;
+    
+    const float normalized = f32_from_bits((two_w >> 4) + (0xE0u << 23)) * 0x1.0p-112f;
+    const float denormalized = f32_from_bits((two_w >> 17) | (126u << 23)) - 0.5f;
+    
+    return f32_from_bits(sign | (two_w < (1u << 27) ? f32_bits(denormalized) : f32_bits(normalized)));
+}
+
+#if AMX_X86
+__attribute__((target("f16c,avx")))
+static void f32_to_f16_f16c(const float *RESTRICT src, uint16_t *RESTRICT dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128((__m128i *)(dst + i), h);
+    }
+    for (; i < n; ++i) dst[i] = f16_from_f32_scalar(src[i]);
+}
+
+__attribute__((target("f16c,avx")))
+static void f16_to_f32_f16c(const uint16_t *RESTRICT src, float *RESTRICT dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+    for (; i < n; ++i) dst[i] = f16_to_f32_scalar(src[i]);
+}
+#endif
+
+void amx_f32_to_f16(const float *RESTRICT src, uint16_t *RESTRICT dst, size_t n) {
+    size_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 8 <= n; i += 8) {
+        float16x8_t h = vcombine_f16(vcvt_f16_f32(vld1q_f32(src + i)),
+                                     vcvt_f16_f32(vld1q_f32(src + i + 4)));
+        vst1q_u16(dst + i, vreinterpretq_u16_f16(h));
+    }
+#elif AMX_X86
+    if (LIKELY(__builtin_cpu_supports("f16c"))) {
+        f32_to_f16_f16c(src, dst, n);
+        return;
+    }
+#endif
+    for (; i < n; ++i) dst[i] = f16_from_f32_scalar(src[i]);
+}
+
+void amx_f16_to_f32(const uint16_t *RESTRICT src, float *RESTRICT dst, size_t n) {
+    size_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 8 <= n; i += 8) {
+        float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(src + i));
+        vst1q_f32(dst + i, vcvt_f32_f16(vget_low_f16(h)));
+        vst1q_f32(dst + i + 4, vcvt_high_f32_f16(h));
+    }
+#elif AMX_X86
+    if (LIKELY(__builtin_cpu_supports("f16c"))) {
+        f16_to_f32_f16c(src, dst, n);
+        return;
+    }
+#endif
+    for (; i < n; ++i) dst[i] = f16_to_f32_scalar(src[i]);
+}
+
+struct AmxMatrixF16 {
+    uint16_t *RESTRICT data; // 64-byte aligned, row-major with padded stride
+    size_t rows;
+    size_t cols;
+    size_t stride;           // >= cols, multiple of 32
+};
+
+AmxMatrixF16 *amx_matrix_f16_zeros(size_t rows, size_t cols) {
+    if (UNLIKELY(!rows || !cols)) return NULL;
+    
+    AmxMatrixF16 *m = malloc(sizeof(AmxMatrixF16));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = round_up(cols, AMX_TILE_F16);
+    
+    size_t bytes = rows * m->stride * sizeof(uint16_t);
+    m->data = alloc_aligned(bytes);
+    if (UNLIKELY(!m->data)) { free(m); return NULL; }
+    
+    memset(m->data, 0, bytes);
+    return m;
+}
+
+AmxMatrixF16 *amx_matrix_f16_from_data(size_t rows, size_t cols, const uint16_t *RESTRICT data) {
+    if (UNLIKELY(!data)) return NULL;
+    
+    AmxMatrixF16 *m = amx_matrix_f16_zeros(rows, cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < rows; ++i) {
+        memcpy(m->data + i * m->stride, data + i * cols, cols * sizeof(uint16_t));
+    }
+    return m;
+}
+
+AmxMatrixF16 *amx_matrix_f16_from_f32(const AmxMatrix *m) {
+    if (UNLIKELY(!m)) return NULL;
+    
+    AmxMatrixF16 *h = amx_matrix_f16_zeros(m->rows, m->cols);
+    if (UNLIKELY(!h)) return NULL;
+    
+    for (size_t i = 0; i < m->rows; ++i) {
+        amx_f32_to_f16(m->data + i * m->stride, h->data + i * h->stride, m->cols);
+    }
+    return h;
+}
+
+AmxMatrix *amx_matrix_f16_to_f32(const AmxMatrixF16 *h) {
+    if (UNLIKELY(!h)) return NULL;
+    
+    AmxMatrix *m = amx_matrix_zeros(h->rows, h->cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < h->rows; ++i) {
+        amx_f16_to_f32(h->data + i * h->stride, m->data + i * m->stride, h->cols);
+    }
+    return m;
+}
+
+void amx_matrix_f16_free(AmxMatrixF16 *m) {
+    if (m) { free(m->data); free(m); }
+}
+
+size_t amx_matrix_f16_rows(const AmxMatrixF16 *m) { return m ? m->rows : 0; }
+size_t amx_matrix_f16_cols(const AmxMatrixF16 *m) { return m ? m->cols : 0; }
+size_t amx_matrix_f16_stride(const AmxMatrixF16 *m) { return m ? m->stride : 0; }
+const uint16_t *amx_matrix_f16_data(const AmxMatrixF16 *m) { return m ? m->data : NULL; }
+uint16_t *amx_matrix_f16_data_mut(AmxMatrixF16 *m) { return m ? m->data : NULL; }
+float amx_matrix_f16_get(const AmxMatrixF16 *m, size_t r, size_t c) { return f16_to_f32_scalar(m->data[r * m->stride + c]); }
+void amx_matrix_f16_set(AmxMatrixF16 *m, size_t r, size_t c, float v) { m->data[r * m->stride + c] = f16_from_f32_scalar(v); }
+
+// Pack 32 rows of f16 A into a column-major panel (32 halves = one Y register per k)
+HOT static void pack_a_panel_f16(
+    const uint16_t *RESTRICT A,
+    uint16_t *RESTRICT panel,
+    size_t M_start,
+    size_t M_end,
+    size_t K,
+    size_t a_stride
+) {
+    const size_t rows = M_end - M_start;
+    const uint16_t *RESTRICT src_base = A + M_start * a_stride;
+    
+    for (size_t k = 0; k < K; ++k) {
+        uint16_t *RESTRICT dst = panel + k * AMX_TILE_F16;
+        const uint16_t *RESTRICT src = src_base + k;
+        for (size_t i = 0; i < rows; ++i) {
+            dst[i] = src[i * a_stride];
+        }
+        if (rows < AMX_TILE_F16) {
+            memset(dst + rows, 0, (AMX_TILE_F16 - rows) * sizeof(uint16_t));
+        }
+    }
+}
+
+// 32x32 f32 output tile from f16 operands. B rows are loaded straight from the
+// matrix: lanes past the last column only feed output columns that are never stored.
+HOT FLATTEN static void microkernel_f16_32x32(
+    const uint16_t *RESTRICT A,  // Column-major panel: 32 rows x K cols, stride 32
+    const uint16_t *RESTRICT B,  // Row-major: K rows, stride b_stride halves
+    float *RESTRICT C,           // Row-major f32: mr rows x nr cols, stride c_stride
+    size_t K,
+    size_t b_stride,
+    size_t c_stride,
+    size_t mr,
+    size_t nr
+) {
+    AMX_ZERO_Z_ALL();
+    
+    size_t k = 0;
+    for (; k + 8 <= K; k += 8) {
+        const uint16_t *RESTRICT a_ptr = A + k * AMX_TILE_F16;
+        const uint16_t *RESTRICT b_ptr = B + k * b_stride;
+        
+        PREFETCH_R(a_ptr + 8 * AMX_TILE_F16);
+        PREFETCH_R(b_ptr + 8 * b_stride);
+        
+        AMX_LDY(a_ptr + 0 * AMX_TILE_F16, 0);
+        AMX_LDY(a_ptr + 1 * AMX_TILE_F16, 1);
+        AMX_LDY(a_ptr + 2 * AMX_TILE_F16, 2);
+        AMX_LDY(a_ptr + 3 * AMX_TILE_F16, 3);
+        AMX_LDY(a_ptr + 4 * AMX_TILE_F16, 4);
+        AMX_LDY(a_ptr + 5 * AMX_TILE_F16, 5);
+        AMX_LDY(a_ptr + 6 * AMX_TILE_F16, 6);
+        AMX_LDY(a_ptr + 7 * AMX_TILE_F16, 7);
+        
+        AMX_LDX(b_ptr + 0 * b_stride, 0);
+        AMX_LDX(b_ptr + 1 * b_stride, 1);
+        AMX_FMA16_F32(0 * 64, 0 * 64, 0);
+        
+        AMX_LDX(b_ptr + 2 * b_stride, 2);
+        AMX_FMA16_F32(1 * 64, 1 * 64, 0);
+        
+        AMX_LDX(b_ptr + 3 * b_stride, 3);
+        AMX_FMA16_F32(2 * 64, 2 * 64, 0);
+        
+        AMX_LDX(b_ptr + 4 * b_stride, 4);
+        AMX_FMA16_F32(3 * 64, 3 * 64, 0);
+        
+        AMX_LDX(b_ptr + 5 * b_stride, 5);
+        AMX_FMA16_F32(4 * 64, 4 * 64, 0);
+        
+        AMX_LDX(b_ptr + 6 * b_stride, 6);
+        AMX_FMA16_F32(5 * 64, 5 * 64, 0);
+        
+        AMX_LDX(b_ptr + 7 * b_stride, 7);
+        AMX_FMA16_F32(6 * 64, 6 * 64, 0);
+        AMX_FMA16_F32(7 * 64, 7 * 64, 0);
+    }
+    
+    for (; k < K; ++k) {
+        AMX_LDY(A + k * AMX_TILE_F16, 0);
+        AMX_LDX(B + k * b_stride, 0);
+        AMX_FMA16_F32(0, 0, 0);
+    }
+    
+    // Z row 2r holds the even columns of C row r, row 2r+1 the odd ones
+    float lanes[2 * AMX_TILE] ALIGNED(64) = {0};
+    for (size_t r = 0; r < mr; ++r) {
+        AMX_STZ(lanes, 2 * r);
+        AMX_STZ(lanes + AMX_TILE, 2 * r + 1);
+        float *RESTRICT c_row = C + r * c_stride;
+        for (size_t t = 0; t < nr; ++t) {
+            c_row[t] = lanes[(t & 1) * AMX_TILE + (t >> 1)];
+        }
+    }
+}
+
+HOT static void matmul_f16_rows_amx(
+    const AmxMatrixF16 *RESTRICT a,
+    const AmxMatrixF16 *RESTRICT b,
+    AmxMatrix *RESTRICT c,
+    size_t i_start,
+    size_t i_end,
+    uint16_t *RESTRICT a_panel
+) {
+    const size_t K = a->cols, N = b->cols;
+    
+    AMX_SET();
+    
+    for (size_t i = i_start; i < i_end; i += AMX_TILE_F16) {
+        const size_t mr = (i + AMX_TILE_F16 <= i_end) ? AMX_TILE_F16 : i_end - i;
+        pack_a_panel_f16(a->data, a_panel, i, i + mr, K, a->stride);
+        
+        for (size_t j = 0; j < N; j += AMX_TILE_F16) {
+            const size_t nr = (j + AMX_TILE_F16 <= N) ? AMX_TILE_F16 : N - j;
+            microkernel_f16_32x32(a_panel, b->data + j, c->data + i * c->stride + j,
+                                  K, b->stride, c->stride, mr, nr);
+        }
+    }
+    
+    AMX_CLR();
+}
+
+typedef void (*WidenFn)(const uint16_t *src, float *dst, size_t n);
+
+// Portable path for 16-bit storage types: widen a KC x NC block of B and one
+// row slice of A at a time, then run a straight axpy loop the compiler
+// vectorizes. Buffers live on the stack so worker threads need no allocation.
+HOT static void matmul_widening_rows(
+    const uint16_t *RESTRICT A, size_t a_stride,
+    const uint16_t *RESTRICT B, size_t b_stride,
+    float *RESTRICT C, size_t c_stride,
+    size_t K,
+    size_t N,
+    size_t i_start,
+    size_t i_end,
+    WidenFn widen
+) {
+    enum { KC = 128, NC = 64 };
+    float a_buf[KC] ALIGNED(64);
+    float b_buf[KC * NC] ALIGNED(64);
+    
+    for (size_t jc = 0; jc < N; jc += NC) {
+        const size_t nc = (jc + NC <= N) ? NC : N - jc;
+        for (size_t pc = 0; pc < K; pc += KC) {
+            const size_t kc = (pc + KC <= K) ? KC : K - pc;
+            for (size_t k = 0; k < kc; ++k) {
+                widen(B + (pc + k) * b_stride + jc, b_buf + k * NC, nc);
+            }
+            
+            for (size_t i = i_start; i < i_end; ++i) {
+                widen(A + i * a_stride + pc, a_buf, kc);
+                float *RESTRICT c_row = C + i * c_stride + jc;
+                for (size_t k = 0; k < kc; ++k) {
+                    const float a_val = a_buf[k];
+                    const float *RESTRICT b_row = b_buf + k * NC;
+                    for (size_t j = 0; j < nc; ++j) {
+                        c_row[j] += a_val * b_row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    const AmxMatrixF16 *a;
+    const AmxMatrixF16 *b;
+    AmxMatrix *c;
+    size_t i_start, i_end;   // Row range for this thread
+    bool use_amx;
+} MatmulF16Task;
+
+static void matmul_f16_task_body(void *ctx, size_t t) {
+    MatmulF16Task *task = &((MatmulF16Task *)ctx)[t];
+    if (task->i_start >= task->i_end) return;
+    
+    if (task->use_amx) {
+        uint16_t *a_panel = alloc_aligned(task->a->cols * AMX_TILE_F16 * sizeof(uint16_t));
+        if (LIKELY(a_panel)) {
+            matmul_f16_rows_amx(task->a, task->b, task->c, task->i_start, task->i_end, a_panel);
+            free(a_panel);
+            return;
+        }
+    }
+    matmul_widening_rows(task->a->data, task->a->stride, task->b->data, task->b->stride,
+                         task->c->data, task->c->stride, task->a->cols, task->b->cols,
+                         task->i_start, task->i_end, amx_f16_to_f32);
+}
+
+AmxMatrix *amx_matrix_f16_matmul(const AmxMatrixF16 *a, const AmxMatrixF16 *b) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    const size_t M = a->rows;
+    const size_t m_tiles = (M + AMX_TILE_F16 - 1) / AMX_TILE_F16;
+    size_t num_threads = m_tiles < (size_t)num_workers() ? m_tiles : (size_t)num_workers();
+    if (M <= 64) num_threads = 1;
+    
+    // Distribute whole 32-row tiles across threads
+    const size_t rows_per_thread = ((m_tiles + num_threads - 1) / num_threads) * AMX_TILE_F16;
+    MatmulF16Task tasks[AMX_MAX_THREADS];
+    for (size_t t = 0; t < num_threads; ++t) {
+        size_t start = t * rows_per_thread;
+        size_t end = start + rows_per_thread;
+        if (start > M) start = M;
+        if (end > M) end = M;
+        tasks[t] = (MatmulF16Task){
+            .a = a, .b = b, .c = c,
+            .i_start = start, .i_end = end,
+            .use_amx = amx_is_available()
+        };
+    }
+    
+    parallel_for(num_threads, tasks, matmul_f16_task_body);
+    return c;
+}
+
+// ============================================================================
+// Brain Float (bf16)
+// ============================================================================
+
+// bf16 is the top half of an f32: widening is a shift, narrowing rounds the
+// low 16 bits to nearest even. NaNs stay NaN (quiet bit forced).
+ALWAYS_INLINE static uint16_t bf16_from_f32_scalar(float f) {
+    uint32_t u = f32_bits(f);
+    if ((u & 0x7FFFFFFFu) > 0x7F800000u) return (uint16_t)((u >> 16) | 0x0040u);
+    u += 0x7FFFu + ((u >> 16) & 1u);
+    return (uint16_t)(u >> 16);
+}
+
+ALWAYS_INLINE static float bf16_to_f32_scalar(uint16_t h) {
+    return f32_from_bits((uint32_t)h << 16);
+}
+
+#if AMX_X86
+static bool cpu_has_avx512_bf16(void) {
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bf16");
+}
+#endif
+
+// Branch-free bodies the compiler vectorizes on every target. (vcvtneps2bf16
+// is not used: it flushes subnormals, which would make results backend-dependent.)
+void amx_f32_to_bf16(const float *RESTRICT src, uint16_t *RESTRICT dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] = bf16_from_f32_scalar(src[i]);
+}
+
+void amx_bf16_to_f32(const uint16_t *RESTRICT src, float *RESTRICT dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] = bf16_to_f32_scalar(src[i]);
+}
+
+struct AmxMatrixBF16 {
+    uint16_t *RESTRICT data; // 64-byte aligned, row-major with padded stride
+    size_t rows;
+    size_t cols;
+    size_t stride;           // >= cols, multiple of 32
+};
+
+AmxMatrixBF16 *amx_matrix_bf16_zeros(size_t rows, size_t cols) {
+    if (UNLIKELY(!rows || !cols)) return NULL;
+    
+    AmxMatrixBF16 *m = malloc(sizeof(AmxMatrixBF16));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = round_up(cols, AMX_TILE_F16);
+    
+    size_t bytes = rows * m->stride * sizeof(uint16_t);
+    m->data = alloc_aligned(bytes);
+    if (UNLIKELY(!m->data)) { free(m); return NULL; }
+    
+    memset(m->data, 0, bytes);
+    return m;
+}
+
+AmxMatrixBF16 *amx_matrix_bf16_from_data(size_t rows, size_t cols, const uint16_t *RESTRICT data) {
+    if (UNLIKELY(!data)) return NULL;
+    
+    AmxMatrixBF16 *m = amx_matrix_bf16_zeros(rows, cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < rows; ++i) {
+        memcpy(m->data + i * m->stride, data + i * cols, cols * sizeof(uint16_t));
+    }
+    return m;
+}
+
+AmxMatrixBF16 *amx_matrix_bf16_from_f32(const AmxMatrix *m) {
+    if (UNLIKELY(!m)) return NULL;
+    
+    AmxMatrixBF16 *h = amx_matrix_bf16_zeros(m->rows, m->cols);
+    if (UNLIKELY(!h)) return NULL;
+    
+    for (size_t i = 0; i < m->rows; ++i) {
+        amx_f32_to_bf16(m->data + i * m->stride, h->data + i * h->stride, m->cols);
+    }
+    return h;
+}
+
+AmxMatrix *amx_matrix_bf16_to_f32(const AmxMatrixBF16 *h) {
+    if (UNLIKELY(!h)) return NULL;
+    
+    AmxMatrix *m = amx_matrix_zeros(h->rows, h->cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < h->rows; ++i) {
+        amx_bf16_to_f32(h->data + i * h->stride, m->data + i * m->stride, h->cols);
+    }
+    return m;
+}
+
+void amx_matrix_bf16_free(AmxMatrixBF16 *m) {
+    if (m) { free(m->data); free(m); }
+}
+
+size_t amx_matrix_bf16_rows(const AmxMatrixBF16 *m) { return m ? m->rows : 0; }
+size_t amx_matrix_bf16_cols(const AmxMatrixBF16 *m) { return m ? m->cols : 0; }
+size_t amx_matrix_bf16_stride(const AmxMatrixBF16 *m) { return m ? m->stride : 0; }
+const uint16_t *amx_matrix_bf16_data(const AmxMatrixBF16 *m) { return m ? m->data : NULL; }
+uint16_t *amx_matrix_bf16_data_mut(AmxMatrixBF16 *m) { return m ? m->data : NULL; }
+float amx_matrix_bf16_get(const AmxMatrixBF16 *m, size_t r, size_t c) { return bf16_to_f32_scalar(m->data[r * m->stride + c]); }
+void amx_matrix_bf16_set(AmxMatrixBF16 *m, size_t r, size_t c, float v) { m->data[r * m->stride + c] = bf16_from_f32_scalar(v); }
+
+// ----------------------------------------------------------------------------
+// AMX: widen while packing, multiply with the f32 microkernel. The shift is
+// exact, so results match an f32 GEMM on the widened inputs; memory traffic
+// stays at bf16 width. K is blocked so each widened B tile serves a whole
+// MC-row block of A panels.
+// ----------------------------------------------------------------------------
+
+#define BF16_MC 256
+#define BF16_KC 256
+
+HOT static void matmul_bf16_rows_amx(
+    const AmxMatrixBF16 *RESTRICT a,
+    const AmxMatrixBF16 *RESTRICT b,
+    AmxMatrix *RESTRICT c,
+    size_t i_start,
+    size_t i_end,
+    float *RESTRICT a_block,    // BF16_MC x BF16_KC, as 16-row column panels
+    float *RESTRICT b_tile      // BF16_KC x 16
+) {
+    const size_t K = a->cols, N = b->cols;
+    
+    AMX_SET();
+    
+    for (size_t ic = i_start; ic < i_end; ic += BF16_MC) {
+        const size_t mc = (ic + BF16_MC <= i_end) ? BF16_MC : i_end - ic;
+        
+        for (size_t pc = 0; pc < K; pc += BF16_KC) {
+            const size_t kc = (pc + BF16_KC <= K) ? BF16_KC : K - pc;
+            
+            // Widen A rows into column panels: panel p holds rows ic+16p.., k-major
+            for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                float *RESTRICT panel = a_block + ii * kc;
+                const size_t rows = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                for (size_t r = 0; r < AMX_TILE; ++r) {
+                    if (r < rows) {
+                        const uint16_t *RESTRICT src = a->data + (ic + ii + r) * a->stride + pc;
+                        for (size_t k = 0; k < kc; ++k) panel[k * AMX_TILE + r] = bf16_to_f32_scalar(src[k]);
+                    } else {
+                        for (size_t k = 0; k < kc; ++k) panel[k * AMX_TILE + r] = 0.0f;
+                    }
+                }
+            }
+            
+            for (size_t j = 0; j < N; j += AMX_TILE) {
+                const size_t nr = (j + AMX_TILE <= N) ? AMX_TILE : N - j;
+                
+                // Padding lanes only feed output columns that are never stored
+                for (size_t k = 0; k < kc; ++k) {
+                    amx_bf16_to_f32(b->data + (pc + k) * b->stride + j, b_tile + k * AMX_TILE, AMX_TILE);
+                }
+                
+                for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                    const size_t mr = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                    microkernel_16x16_acc(a_block + ii * kc, b_tile,
+                                          c->data + (ic + ii) * c->stride + j,
+                                          kc, AMX_TILE, c->stride, mr, nr, pc > 0);
+                }
+            }
+        }
+    }
+    
+    AMX_CLR();
+}
+
+#if AMX_X86
+// ----------------------------------------------------------------------------
+// AVX-512 BF16: vdpbf16ps consumes bf16 pairs along K directly. B is packed
+// into 32-column strips of k-pairs; A pairs are broadcast straight from the
+// row, so A needs no packing at all.
+// ----------------------------------------------------------------------------
+
+#define BF16_NR 32
+
+// Pack kc rows of B (columns j..j+nr) into k-pair interleaved strip:
+// dst[p][2*col + {0,1}] = B[pc + 2p + {0,1}][j + col], zero padded.
+__attribute__((target("avx512f,avx512bf16")))
+static void pack_b_bf16_pairs(
+    const uint16_t *RESTRICT B, size_t b_stride,
+    uint16_t *RESTRICT dst, size_t kc, size_t nr
+) {
+    const size_t pairs = (kc + 1) / 2;
+    for (size_t p = 0; p < pairs; ++p) {
+        const uint16_t *RESTRICT r0 = B + (2 * p) * b_stride;
+        const uint16_t *RESTRICT r1 = (2 * p + 1 < kc) ? r0 + b_stride : NULL;
+        uint16_t *RESTRICT d = dst + p * 2 * BF16_NR;
+        for (size_t col = 0; col < BF16_NR; ++col) {
+            d[2 * col] = col < nr ? r0[col] : 0;
+            d[2 * col + 1] = (col < nr && r1) ? r1[col] : 0;
+        }
+    }
+}
+
+ALWAYS_INLINE static uint32_t bf16_pair(const uint16_t *RESTRICT p, bool has_second) {
+    return (uint32_t)p[0] | (has_second ? (uint32_t)p[1] << 16 : 0u);
+}
+
+__attribute__((target("avx512f,avx512bf16")))
+static void kernel_bf16_avx512(
+    const uint16_t *RESTRICT A, size_t a_stride,   // mr rows, kc columns
+    const uint16_t *RESTRICT b_strip,              // packed pairs, 32 columns
+    float *RESTRICT C, size_t c_stride,
+    size_t mr, size_t nr, size_t kc
+) {
+    enum { MR = 8 };
+    __m512 acc[MR][2];
+    for (size_t r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm512_setzero_ps();
+    
+    const size_t full_pairs = kc / 2;
+    for (size_t p = 0; p < full_pairs; ++p) {
+        const __m512bh b0 = (__m512bh)_mm512_loadu_si512(b_strip + p * 2 * BF16_NR);
+        const __m512bh b1 = (__m512bh)_mm512_loadu_si512(b_strip + p * 2 * BF16_NR + BF16_NR);
+        for (size_t r = 0; r < MR; ++r) {
+            if (r < mr) {
+                const __m512bh av = (__m512bh)_mm512_set1_epi32((int)bf16_pair(A + r * a_stride + 2 * p, true));
+                acc[r][0] = _mm512_dpbf16_ps(acc[r][0], b0, av);
+                acc[r][1] = _mm512_dpbf16_ps(acc[r][1], b1, av);
+            }
+        }
+    }
+    if (kc & 1) {
+        // Odd K: the partner lane is zero in B and must not be read from A
+        const size_t p = full_pairs;
+        const __m512bh b0 = (__m512bh)_mm512_loadu_si512(b_strip + p * 2 * BF16_NR);
+        const __m512bh b1 = (__m512bh)_mm512_loadu_si512(b_strip + p * 2 * BF16_NR + BF16_NR);
+        for (size_t r = 0; r < MR; ++r) {
+            if (r < mr) {
+                const __m512bh av = (__m512bh)_mm512_set1_epi32((int)bf16_pair(A + r * a_stride + 2 * p, false));
+                acc[r][0] = _mm512_dpbf16_ps(acc[r][0], b0, av);
+                acc[r][1] = _mm512_dpbf16_ps(acc[r][1], b1, av);
+            }
+        }
+    }
+    
+    const __mmask16 m0 = (__mmask16)(nr >= 16 ? 0xFFFF : (1u << nr) - 1);
+    const __mmask16 m1 = (__mmask16)(nr >= 32 ? 0xFFFF : nr > 16 ? (1u << (nr - 16)) - 1 : 0);
+    for (size_t r = 0; r < mr; ++r) {
+        float *RESTRICT c_row = C + r * c_stride;
+        _mm512_mask_storeu_ps(c_row, m0, _mm512_add_ps(_mm512_maskz_loadu_ps(m0, c_row), acc[r][0]));
+        _mm512_mask_storeu_ps(c_row + 16, m1, _mm512_add_ps(_mm512_maskz_loadu_ps(m1, c_row + 16), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f,avx512bf16")))
+static void matmul_bf16_rows_avx512(
+    const AmxMatrixBF16 *RESTRICT a,
+    const AmxMatrixBF16 *RESTRICT b,
+    AmxMatrix *RESTRICT c,
+    size_t i_start,
+    size_t i_end
+) {
+    enum { KC = 256, MR = 8 };
+    uint16_t strip[KC * BF16_NR] ALIGNED(64);
+    const size_t K = a->cols, N = b->cols;
+    
+    for (size_t j = 0; j < N; j += BF16_NR) {
+        const size_t nr = (j + BF16_NR <= N) ? BF16_NR : N - j;
+        for (size_t pc = 0; pc < K; pc += KC) {
+            const size_t kc = (pc + KC <= K) ? KC : K - pc;
+            pack_b_bf16_pairs(b->data + pc * b->stride + j, b->stride, strip, kc, nr);
+            for (size_t i = i_start; i < i_end; i += MR) {
+                const size_t mr = (i + MR <= i_end) ? MR : i_end - i;
+                kernel_bf16_avx512(a->data + i * a->stride + pc, a->stride, strip,
+                                   c->data + i * c->stride + j, c->stride, mr, nr, kc);
+            }
+        }
+    }
+}
+#endif
+
+typedef struct {
+    const AmxMatrixBF16 *a;
+    const AmxMatrixBF16 *b;
+    AmxMatrix *c;
+    size_t i_start, i_end;   // Row range for this thread
+    bool use_amx;
+} MatmulBF16Task;
+
+static void matmul_bf16_task_body(void *ctx, size_t t) {
+    MatmulBF16Task *task = &((MatmulBF16Task *)ctx)[t];
+    if (task->i_start >= task->i_end) return;
+    
+    if (task->use_amx) {
+        float *a_block = alloc_aligned(BF16_MC * BF16_KC * sizeof(float));
+        float *b_tile = alloc_aligned(BF16_KC * AMX_TILE * sizeof(float));
+        if (LIKELY(a_block && b_tile)) {
+            matmul_bf16_rows_amx(task->a, task->b, task->c, task->i_start, task->i_end, a_block, b_tile);
+            free(a_block);
+            free(b_tile);
+            return;
+        }
+        free(a_block);
+        free(b_tile);
+    }
+#if AMX_X86
+    if (cpu_has_avx512_bf16()) {
+        matmul_bf16_rows_avx512(task->a, task->b, task->c, task->i_start, task->i_end);
+        return;
+    }
+#endif
+    matmul_widening_rows(task->a->data, task->a->stride, task->b->data, task->b->stride,
+                         task->c->data, task->c->stride, task->a->cols, task->b->cols,
+                         task->i_start, task->i_end, amx_bf16_to_f32);
+}
+
+AmxMatrix *amx_matrix_bf16_matmul(const AmxMatrixBF16 *a, const AmxMatrixBF16 *b) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    const size_t M = a->rows;
+    const size_t m_tiles = (M + AMX_TILE - 1) / AMX_TILE;
+    size_t num_threads = m_tiles < (size_t)num_workers() ? m_tiles : (size_t)num_workers();
+    if (M <= 64) num_threads = 1;
+    
+    const size_t rows_per_thread = ((m_tiles + num_threads - 1) / num_threads) * AMX_TILE;
+    MatmulBF16Task tasks[AMX_MAX_THREADS];
+    for (size_t t = 0; t < num_threads; ++t) {
+        size_t start = t * rows_per_thread;
+        size_t end = start + rows_per_thread;
+        if (start > M) start = M;
+        if (end > M) end = M;
+        tasks[t] = (MatmulBF16Task){
+            .a = a, .b = b, .c = c,
+            .i_start = start, .i_end = end,
+            .use_amx = amx_is_available()
+        };
+    }
+    
+    parallel_for(num_threads, tasks, matmul_bf16_task_body);
+    return c;
+}
+
+// ============================================================================
+// INT8 Quantized GEMM
+// ============================================================================
+
+#define AMX_ALIGN_I8  64          // 64 int8 = 64 bytes
+
+struct AmxMatrixI8 {
+    int8_t *RESTRICT data;   // 64-byte aligned, row-major with padded stride
+    size_t rows;
+    size_t cols;
+    size_t stride;           // >= cols, multiple of 64
+    AmxQuantAxis axis;
+    float *scales;           // 1, rows or cols entries depending on axis
+    int32_t *zero_points;    // same count as scales
+};
+
+static size_t quant_channels(AmxQuantAxis axis, size_t rows, size_t cols) {
+    return axis == AMX_QUANT_PER_ROW ? rows : axis == AMX_QUANT_PER_COL ? cols : 1;
+}
+
+ALWAYS_INLINE static size_t quant_channel(AmxQuantAxis axis, size_t row, size_t col) {
+    return axis == AMX_QUANT_PER_ROW ? row : axis == AMX_QUANT_PER_COL ? col : 0;
+}
+
+ALWAYS_INLINE static int8_t quantize_i8(float x, float inv_scale, int32_t zero_point) {
+    float q = __builtin_rintf(x * inv_scale) + (float)zero_point;
+    q = q < -128.0f ? -128.0f : q > 127.0f ? 127.0f : q;
+    return (int8_t)q;
+}
+
+static AmxMatrixI8 *matrix_i8_alloc(size_t rows, size_t cols, AmxQuantAxis axis) {
+    if (UNLIKELY(!rows || !cols || axis > AMX_QUANT_PER_COL)) return NULL;
+    
+    AmxMatrixI8 *m = calloc(1, sizeof(AmxMatrixI8));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = round_up(cols, AMX_ALIGN_I8);
+    m->axis = axis;
+    
+    const size_t channels = quant_channels(axis, rows, cols);
+    m->data = alloc_aligned(rows * m->stride);
+    m->scales = malloc(channels * sizeof(float));
+    m->zero_points = calloc(channels, sizeof(int32_t));
+    if (UNLIKELY(!m->data || !m->scales || !m->zero_points)) {
+        amx_matrix_i8_free(m);
+        return NULL;
+    }
+    memset(m->data, 0, rows * m->stride);
+    return m;
+}
+
+AmxMatrixI8 *amx_matrix_i8_from_data(
+    size_t rows, size_t cols, const int8_t *RESTRICT data,
+    AmxQuantAxis axis, const float *scales, const int32_t *zero_points
+) {
+    if (UNLIKELY(!data || !scales)) return NULL;
+    
+    AmxMatrixI8 *m = matrix_i8_alloc(rows, cols, axis);
+    if (UNLIKELY(!m)) return NULL;
+    
+    const size_t channels = quant_channels(axis, rows, cols);
+    memcpy(m->scales, scales, channels * sizeof(float));
+    if (zero_points) memcpy(m->zero_points, zero_points, channels * sizeof(int32_t));
+    for (size_t i = 0; i < rows; ++i) {
+        memcpy(m->data + i * m->stride, data + i * cols, cols);
+    }
+    return m;
+}
+
+AmxMatrixI8 *amx_matrix_i8_quantize(const AmxMatrix *m, AmxQuantAxis axis, bool symmetric) {
+    if (UNLIKELY(!m)) return NULL;
+    
+    AmxMatrixI8 *q = matrix_i8_alloc(m->rows, m->cols, axis);
+    if (UNLIKELY(!q)) return NULL;
+    
+    // Per-channel range
+    const size_t channels = quant_channels(axis, m->rows, m->cols);
+    float *lo = malloc(channels * sizeof(float));
+    float *hi = malloc(channels * sizeof(float));
+    if (UNLIKELY(!lo || !hi)) {
+        free(lo); free(hi);
+        amx_matrix_i8_free(q);
+        return NULL;
+    }
+    for (size_t c = 0; c < channels; ++c) { lo[c] = 0.0f; hi[c] = 0.0f; }
+    for (size_t i = 0; i < m->rows; ++i) {
+        const float *RESTRICT row = m->data + i * m->stride;
+        for (size_t j = 0; j < m->cols; ++j) {
+            const size_t c = quant_channel(axis, i, j);
+            if (row[j] < lo[c]) lo[c] = row[j];
+            if (row[j] > hi[c]) hi[c] = row[j];
+        }
+    }
+    
+    // Ranges always include zero so it stays exactly representable
+    for (size_t c = 0; c < channels; ++c) {
+        float scale;
+        int32_t zp = 0;
+        if (symmetric) {
+            const float amax = -lo[c] > hi[c] ? -lo[c] : hi[c];
+            scale = amax / 127.0f;
+        } else {
+            scale = (hi[c] - lo[c]) / 255.0f;
+            if (scale > 0.0f) zp = (int32_t)__builtin_rintf(-128.0f - lo[c] / scale);
+            zp = zp < -128 ? -128 : zp > 127 ? 127 : zp;
+        }
+        q->scales[c] = scale > 0.0f ? scale : 1.0f;
+        q->zero_points[c] = zp;
+    }
+    free(lo);
+    free(hi);
+    
+    for (size_t i = 0; i < m->rows; ++i) {
+        const float *RESTRICT src = m->data + i * m->stride;
+        int8_t *RESTRICT dst = q->data + i * q->stride;
+        if (axis == AMX_QUANT_PER_COL) {
+            for (size_t j = 0; j < m->cols; ++j) {
+                dst[j] = quantize_i8(src[j], 1.0f / q->scales[j], q->zero_points[j]);
+            }
+        } else {
+            const size_t c = quant_channel(axis, i, 0);
+            const float inv = 1.0f / q->scales[c];
+            const int32_t zp = q->zero_points[c];
+            for (size_t j = 0; j < m->cols; ++j) dst[j] = quantize_i8(src[j], inv, zp);
+        }
+    }
+    return q;
+}
+
+AmxMatrix *amx_matrix_i8_dequantize(const AmxMatrixI8 *q) {
+    if (UNLIKELY(!q)) return NULL;
+    
+    AmxMatrix *m = amx_matrix_zeros(q->rows, q->cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < q->rows; ++i) {
+        const int8_t *RESTRICT src = q->data + i * q->stride;
+        float *RESTRICT dst = m->data + i * m->stride;
+        for (size_t j = 0; j < q->cols; ++j) {
+            const size_t c = quant_channel(q->axis, i, j);
+            dst[j] = q->scales[c] * (float)((int32_t)src[j] - q->zero_points[c]);
+        }
+    }
+    return m;
+}
+
+void amx_matrix_i8_free(AmxMatrixI8 *m) {
+    if (m) { free(m->data); free(m->scales); free(m->zero_points); free(m); }
+}
+
+size_t amx_matrix_i8_rows(const AmxMatrixI8 *m) { return m ? m->rows : 0; }
+size_t amx_matrix_i8_cols(const AmxMatrixI8 *m) { return m ? m->cols : 0; }
+size_t amx_matrix_i8_stride(const AmxMatrixI8 *m) { return m ? m->stride : 0; }
+const int8_t *amx_matrix_i8_data(const AmxMatrixI8 *m) { return m ? m->data : NULL; }
+int8_t *amx_matrix_i8_data_mut(AmxMatrixI8 *m) { return m ? m->data : NULL; }
+AmxQuantAxis amx_matrix_i8_axis(const AmxMatrixI8 *m) { return m ? m->axis : AMX_QUANT_PER_TENSOR; }
+const float *amx_matrix_i8_scales(const AmxMatrixI8 *m) { return m ? m->scales : NULL; }
+const int32_t *amx_matrix_i8_zero_points(const AmxMatrixI8 *m) { return m ? m->zero_points : NULL; }
+
+// ----------------------------------------------------------------------------
+// Raw int32 accumulation backends. Each computes acc[r][j] += sum_k A[ic+r][k] * B[k][j]
+// for an mc-row block on raw (uncorrected) int8 values.
+// ----------------------------------------------------------------------------
+
+#define I8_MC 256
+#define I8_KC 256
+
+// 32x32 i32 tile from i16 operands via mac16. Z row 2r holds the even columns
+// of C row r, row 2r+1 the odd ones (same layout as the f16 -> f32 mode).
+HOT FLATTEN static void microkernel_i16_32x32(
+    const int16_t *RESTRICT A,   // Column-major panel: 32 rows x K, stride 32
+    const int16_t *RESTRICT B,   // Row-major: K rows, stride b_stride (32 valid lanes)
+    int32_t *RESTRICT C,         // Row-major: mr rows x nr cols, stride c_stride
+    size_t K,
+    size_t b_stride,
+    size_t c_stride,
+    size_t mr,
+    size_t nr,
+    bool load_c
+) {
+    int32_t lanes[2 * AMX_TILE] ALIGNED(64) = {0};
+    
+    if (load_c) {
+        for (size_t r = 0; r < AMX_TILE_F16; ++r) {
+            for (size_t t = 0; t < 2 * AMX_TILE; ++t) {
+                lanes[(t & 1) * AMX_TILE + (t >> 1)] = (r < mr && t < nr) ? C[r * c_stride + t] : 0;
+            }
+            AMX_LDZ(lanes, 2 * r);
+            AMX_LDZ(lanes + AMX_TILE, 2 * r + 1);
+        }
+    } else {
+        AMX_ZERO_Z_ALL();
+    }
+    
+    size_t k = 0;
+    for (; k + 8 <= K; k += 8) {
+        const int16_t *RESTRICT a_ptr = A + k * AMX_TILE_F16;
+        const int16_t *RESTRICT b_ptr = B + k * b_stride;
+        
+        AMX_LDY(a_ptr + 0 * AMX_TILE_F16, 0);
+        AMX_LDY(a_ptr + 1 * AMX_TILE_F16, 1);
+        AMX_LDY(a_ptr + 2 * AMX_TILE_F16, 2);
+        AMX_LDY(a_ptr + 3 * AMX_TILE_F16, 3);
+        AMX_LDY(a_ptr + 4 * AMX_TILE_F16, 4);
+        AMX_LDY(a_ptr + 5 * AMX_TILE_F16, 5);
+        AMX_LDY(a_ptr + 6 * AMX_TILE_F16, 6);
+        AMX_LDY(a_ptr + 7 * AMX_TILE_F16, 7);
+        
+        AMX_LDX(b_ptr + 0 * b_stride, 0);
+        AMX_LDX(b_ptr + 1 * b_stride, 1);
+        AMX_MAC16_I32(0 * 64, 0 * 64, 0);
+        
+        AMX_LDX(b_ptr + 2 * b_stride, 2);
+        AMX_MAC16_I32(1 * 64, 1 * 64, 0);
+        
+        AMX_LDX(b_ptr + 3 * b_stride, 3);
+        AMX_MAC16_I32(2 * 64, 2 * 64, 0);
+        
+        AMX_LDX(b_ptr + 4 * b_stride, 4);
+        AMX_MAC16_I32(3 * 64, 3 * 64, 0);
+        
+        AMX_LDX(b_ptr + 5 * b_stride, 5);
+        AMX_MAC16_I32(4 * 64, 4 * 64, 0);
+        
+        AMX_LDX(b_ptr + 6 * b_stride, 6);
+        AMX_MAC16_I32(5 * 64, 5 * 64, 0);
+        
+        AMX_LDX(b_ptr + 7 * b_stride, 7);
+        AMX_MAC16_I32(6 * 64, 6 * 64, 0);
+        AMX_MAC16_I32(7 * 64, 7 * 64, 0);
+    }
+    
+    for (; k < K; ++k) {
+        AMX_LDY(A + k * AMX_TILE_F16, 0);
+        AMX_LDX(B + k * b_stride, 0);
+        AMX_MAC16_I32(0, 0, 0);
+    }
+    
+    for (size_t r = 0; r < mr; ++r) {
+        AMX_STZ(lanes, 2 * r);
+        AMX_STZ(lanes + AMX_TILE, 2 * r + 1);
+        int32_t *RESTRICT c_row = C + r * c_stride;
+        for (size_t t = 0; t < nr; ++t) {
+            c_row[t] = lanes[(t & 1) * AMX_TILE + (t >> 1)];
+        }
+    }
+}
+
+// AMX: int8 is sign-extended to i16 while packing, then mac16 accumulates in i32
+HOT static void i8_block_amx(
+    const AmxMatrixI8 *RESTRICT a,
+    const AmxMatrixI8 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride,
+    int16_t *RESTRICT a_block,   // I8_MC x I8_KC, as 32-row column panels
+    int16_t *RESTRICT b_tile     // I8_KC x 32
+) {
+    const size_t K = a->cols, N = b->cols;
+    
+    AMX_SET();
+    
+    for (size_t pc = 0; pc < K; pc += I8_KC) {
+        const size_t kc = (pc + I8_KC <= K) ? I8_KC : K - pc;
+        
+        for (size_t ii = 0; ii < mc; ii += AMX_TILE_F16) {
+            int16_t *RESTRICT panel = a_block + ii * kc;
+            const size_t rows = (ii + AMX_TILE_F16 <= mc) ? AMX_TILE_F16 : mc - ii;
+            for (size_t r = 0; r < AMX_TILE_F16; ++r) {
+                const int8_t *RESTRICT src = a->data + (ic + ii + r) * a->stride + pc;
+                for (size_t k = 0; k < kc; ++k) {
+                    panel[k * AMX_TILE_F16 + r] = r < rows ? src[k] : 0;
+                }
+            }
+        }
+        
+        for (size_t j = 0; j < N; j += AMX_TILE_F16) {
+            const size_t nr = (j + AMX_TILE_F16 <= N) ? AMX_TILE_F16 : N - j;
+            
+            // Padding lanes only feed output columns that are never stored
+            for (size_t k = 0; k < kc; ++k) {
+                const int8_t *RESTRICT src = b->data + (pc + k) * b->stride + j;
+                int16_t *RESTRICT dst = b_tile + k * AMX_TILE_F16;
+                for (size_t t = 0; t < AMX_TILE_F16; ++t) dst[t] = src[t];
+            }
+            
+            for (size_t ii = 0; ii < mc; ii += AMX_TILE_F16) {
+                const size_t mr = (ii + AMX_TILE_F16 <= mc) ? AMX_TILE_F16 : mc - ii;
+                microkernel_i16_32x32(a_block + ii * kc, b_tile, acc + ii * acc_stride + j,
+                                      kc, AMX_TILE_F16, acc_stride, mr, nr, pc > 0);
+            }
+        }
+    }
+    
+    AMX_CLR();
+}
+
+// Pack kc rows of B (columns j..j+nr) into k-quad interleaved strips of 16
+// columns: dst[q][4*col + t] = B[4q + t][col], zero padded. This is the operand
+// layout of both vpdpbusd and sdot.
+#if AMX_X86 || (defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD))
+static void pack_b_i8_quads(
+    const int8_t *RESTRICT B, size_t b_stride,
+    int8_t *RESTRICT dst, size_t kc, size_t nr, size_t width
+) {
+    const size_t quads = (kc + 3) / 4;
+    for (size_t q = 0; q < quads; ++q) {
+        int8_t *RESTRICT d = dst + q * 4 * width;
+        for (size_t col = 0; col < width; ++col) {
+            for (size_t t = 0; t < 4; ++t) {
+                const size_t k = 4 * q + t;
+                d[4 * col + t] = (col < nr && k < kc) ? B[k * b_stride + col] : 0;
+            }
+        }
+    }
+}
+#endif
+
+ALWAYS_INLINE static int32_t load_quad(const int8_t *p) {
+    int32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+#if AMX_X86
+// AVX-512 VNNI: vpdpbusd multiplies unsigned by signed bytes, so A is biased
+// by +128 (xor 0x80) and 128 * colsum(B) is removed on store. A quads past K
+// meet zero B lanes, and row padding keeps those reads in bounds.
+#define I8_NR 32
+
+static bool cpu_has_avx512_vnni(void) {
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vnni");
+}
+
+__attribute__((target("avx512f,avx512vnni")))
+static void i8_block_vnni(
+    const AmxMatrixI8 *RESTRICT a,
+    const AmxMatrixI8 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride
+) {
+    enum { MR = 8 };
+    int8_t strip[I8_KC * I8_NR] ALIGNED(64);
+    int32_t colsum[I8_NR];
+    const size_t K = a->cols, N = b->cols;
+    const __m512i bias = _mm512_set1_epi32((int)0x80808080u);
+    
+    for (size_t j = 0; j < N; j += I8_NR) {
+        const size_t nr = (j + I8_NR <= N) ? I8_NR : N - j;
+        for (size_t pc = 0; pc < K; pc += I8_KC) {
+            const size_t kc = (pc + I8_KC <= K) ? I8_KC : K - pc;
+            const size_t quads = (kc + 3) / 4;
+            pack_b_i8_quads(b->data + pc * b->stride + j, b->stride, strip, kc, nr, I8_NR);
+            for (size_t col = 0; col < I8_NR; ++col) {
+                int32_t sum = 0;
+                for (size_t k = 0; k < quads * 4; ++k) sum += strip[(k / 4) * 4 * I8_NR + 4 * col + (k & 3)];
+                colsum[col] = 128 * sum;
+            }
+            const __m512i corr0 = _mm512_loadu_si512(colsum);
+            const __m512i corr1 = _mm512_loadu_si512(colsum + 16);
+            
+            for (size_t i = 0; i < mc; i += MR) {
+                const size_t mr = (i + MR <= mc) ? MR : mc - i;
+                __m512i c0[MR], c1[MR];
+                for (size_t r = 0; r < MR; ++r) c0[r] = c1[r] = _mm512_setzero_si512();
+                
+                const int8_t *RESTRICT a_base = a->data + (ic + i) * a->stride + pc;
+                for (size_t q = 0; q < quads; ++q) {
+                    const __m512i b0 = _mm512_load_si512(strip + q * 4 * I8_NR);
+                    const __m512i b1 = _mm512_load_si512(strip + q * 4 * I8_NR + 64);
+                    for (size_t r = 0; r < MR; ++r) {
+                        if (r < mr) {
+                            const __m512i av = _mm512_xor_si512(
+                                _mm512_set1_epi32(load_quad(a_base + r * a->stride + 4 * q)), bias);
+                            c0[r] = _mm512_dpbusd_epi32(c0[r], av, b0);
+                            c1[r] = _mm512_dpbusd_epi32(c1[r], av, b1);
+                        }
+                    }
+                }
+                
+                const __mmask16 m0 = (__mmask16)(nr >= 16 ? 0xFFFF : (1u << nr) - 1);
+                const __mmask16 m1 = (__mmask16)(nr >= 32 ? 0xFFFF : nr > 16 ? (1u << (nr - 16)) - 1 : 0);
+                for (size_t r = 0; r < mr; ++r) {
+                    int32_t *RESTRICT c_row = acc + (i + r) * acc_stride + j;
+                    __m512i v0 = _mm512_sub_epi32(c0[r], corr0);
+                    __m512i v1 = _mm512_sub_epi32(c1[r], corr1);
+                    _mm512_mask_storeu_epi32(c_row, m0, _mm512_add_epi32(_mm512_maskz_loadu_epi32(m0, c_row), v0));
+                    _mm512_mask_storeu_epi32(c_row + 16, m1, _mm512_add_epi32(_mm512_maskz_loadu_epi32(m1, c_row + 16), v1));
+                }
+            }
+        }
+    }
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD)
+// NEON sdot: signed x signed quads, 4 rows x 16 columns per micro-tile
+#define I8_NR_NEON 16
+
+static void i8_block_sdot(
+    const AmxMatrixI8 *RESTRICT a,
+    const AmxMatrixI8 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride
+) {
+    enum { MR = 4 };
+    int8_t strip[I8_KC * I8_NR_NEON] ALIGNED(64);
+    const size_t K = a->cols, N = b->cols;
+    
+    for (size_t j = 0; j < N; j += I8_NR_NEON) {
+        const size_t nr = (j + I8_NR_NEON <= N) ? I8_NR_NEON : N - j;
+        for (size_t pc = 0; pc < K; pc += I8_KC) {
+            const size_t kc = (pc + I8_KC <= K) ? I8_KC : K - pc;
+            const size_t quads = (kc + 3) / 4;
+            pack_b_i8_quads(b->data + pc * b->stride + j, b->stride, strip, kc, nr, I8_NR_NEON);
+            
+            for (size_t i = 0; i < mc; i += MR) {
+                const size_t mr = (i + MR <= mc) ? MR : mc - i;
+                int32x4_t c[MR][4];
+                for (size_t r = 0; r < MR; ++r) {
+                    for (size_t v = 0; v < 4; ++v) c[r][v] = vdupq_n_s32(0);
+                }
+                
+                const int8_t *RESTRICT a_base = a->data + (ic + i) * a->stride + pc;
+                for (size_t q = 0; q < quads; ++q) {
+                    const int8_t *RESTRICT bq = strip + q * 4 * I8_NR_NEON;
+                    const int8x16_t b0 = vld1q_s8(bq);
+                    const int8x16_t b1 = vld1q_s8(bq + 16);
+                    const int8x16_t b2 = vld1q_s8(bq + 32);
+                    const int8x16_t b3 = vld1q_s8(bq + 48);
+                    for (size_t r = 0; r < MR; ++r) {
+                        if (r < mr) {
+                            const int8x16_t av = vreinterpretq_s8_s32(vdupq_n_s32(load_quad(a_base + r * a->stride + 4 * q)));
+                            c[r][0] = vdotq_s32(c[r][0], b0, av);
+                            c[r][1] = vdotq_s32(c[r][1], b1, av);
+                            c[r][2] = vdotq_s32(c[r][2], b2, av);
+                            c[r][3] = vdotq_s32(c[r][3], b3, av);
+                        }
+                    }
+                }
+                
+                for (size_t r = 0; r < mr; ++r) {
+                    int32_t out[I8_NR_NEON];
+                    for (size_t v = 0; v < 4; ++v) vst1q_s32(out + 4 * v, c[r][v]);
+                    int32_t *RESTRICT c_row = acc + (i + r) * acc_stride + j;
+                    for (size_t t = 0; t < nr; ++t) c_row[t] += out[t];
+                }
+            }
+        }
+    }
+}
+#endif
+
+// Generic: sign-extend a KC x NC block of B to i16 and run an i32 axpy loop
+HOT static void i8_block_generic(
+    const AmxMatrixI8 *RESTRICT a,
+    const AmxMatrixI8 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride
+) {
+    enum { NC = 64 };
+    int16_t b_buf[I8_KC * NC] ALIGNED(64);
+    const size_t K = a->cols, N = b->cols;
+    
+    for (size_t jc = 0; jc < N; jc += NC) {
+        const size_t nc = (jc + NC <= N) ? NC : N - jc;
+        for (size_t pc = 0; pc < K; pc += I8_KC) {
+            const size_t kc = (pc + I8_KC <= K) ? I8_KC : K - pc;
+            for (size_t k = 0; k < kc; ++k) {
+                const int8_t *RESTRICT src = b->data + (pc + k) * b->stride + jc;
+                for (size_t j = 0; j < nc; ++j) b_buf[k * NC + j] = src[j];
+            }
+            
+            for (size_t i = 0; i < mc; ++i) {
+                const int8_t *RESTRICT a_row = a->data + (ic + i) * a->stride + pc;
+                int32_t *RESTRICT c_row = acc + i * acc_stride + jc;
+                for (size_t k = 0; k < kc; ++k) {
+                    const int32_t a_val = a_row[k];
+                    const int16_t *RESTRICT b_row = b_buf + k * NC;
+                    for (size_t j = 0; j < nc; ++j) c_row[j] += a_val * b_row[j];
+                }
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Driver and epilogue
+// ----------------------------------------------------------------------------
+
+typedef enum { I8_OUT_I32, I8_OUT_F32, I8_OUT_I8 } I8OutKind;
+
+typedef struct {
+    const AmxMatrixI8 *a;
+    const AmxMatrixI8 *b;
+    const int32_t *a_row_sums;   // sum_k A[i][k]; NULL when B has no zero points
+    const int32_t *b_col_sums;   // sum_k B[k][j]; NULL when A has no zero points
+    const float *bias;           // Per output column, optional (float outputs)
+    I8OutKind kind;
+    void *out;
+    size_t out_stride;
+    float out_scale;
+    int32_t out_zero_point;
+    size_t rows_per_task;
+    bool use_amx;
+    atomic_bool failed;          // A task could not allocate its accumulators
+} I8Gemm;
+
+// acc = sum (a - za)(b - zb), expanded so the hot loop only sees raw int8:
+// sum ab - zb * rowsum(A) - za * colsum(B) + K * za * zb
+static void i8_epilogue(const I8Gemm *g, const int32_t *RESTRICT acc, size_t acc_stride, size_t ic, size_t mc) {
+    const AmxMatrixI8 *a = g->a, *b = g->b;
+    const size_t K = a->cols, N = b->cols;
+    
+    for (size_t r = 0; r < mc; ++r) {
+        const size_t i = ic + r;
+        const size_t ca = quant_channel(a->axis, i, 0);
+        const int32_t za = a->zero_points[ca];
+        const float sa = a->scales[ca];
+        const int32_t *RESTRICT src = acc + r * acc_stride;
+        
+        for (size_t j = 0; j < N; ++j) {
+            const size_t cb = quant_channel(b->axis, 0, j);
+            const int32_t zb = b->zero_points[cb];
+            int32_t v = src[j];
+            if (g->a_row_sums) v -= zb * g->a_row_sums[i];
+            if (g->b_col_sums) v -= za * g->b_col_sums[j] - (int32_t)K * za * zb;
+            
+            if (g->kind == I8_OUT_I32) {
+                ((int32_t *)g->out)[i * g->out_stride + j] = v;
+                continue;
+            }
+            float x = sa * b->scales[cb] * (float)v;
+            if (g->bias) x += g->bias[j];
+            if (g->kind == I8_OUT_F32) {
+                ((float *)g->out)[i * g->out_stride + j] = x;
+            } else {
+                ((int8_t *)g->out)[i * g->out_stride + j] = quantize_i8(x, 1.0f / g->out_scale, g->out_zero_point);
+            }
+        }
+    }
+}
+
+static void i8_gemm_task_body(void *ctx, size_t t) {
+    I8Gemm *g = (I8Gemm *)ctx;
+    const size_t M = g->a->rows, N = g->b->cols;
+    const size_t i_start = t * g->rows_per_task;
+    const size_t i_end = (i_start + g->rows_per_task < M) ? i_start + g->rows_per_task : M;
+    if (i_start >= i_end) return;
+    
+    const size_t acc_stride = round_up(N, AMX_TILE);
+    const size_t mc_max = (i_end - i_start < I8_MC) ? i_end - i_start : I8_MC;
+    int32_t *acc = alloc_aligned(round_up(mc_max, AMX_TILE_F16) * acc_stride * sizeof(int32_t));
+    int16_t *a_block = NULL, *b_tile = NULL;
+    if (g->use_amx) {
+        a_block = alloc_aligned(I8_MC * I8_KC * sizeof(int16_t));
+        b_tile = alloc_aligned(I8_KC * AMX_TILE_F16 * sizeof(int16_t));
+    }
+    const bool amx_ok = g->use_amx && a_block && b_tile;
+    
+    if (LIKELY(acc)) {
+        for (size_t ic = i_start; ic < i_end; ic += I8_MC) {
+            const size_t mc = (ic + I8_MC <= i_end) ? I8_MC : i_end - ic;
+            memset(acc, 0, mc * acc_stride * sizeof(int32_t));
+            
+            if (amx_ok) {
+                i8_block_amx(g->a, g->b, ic, mc, acc, acc_stride, a_block, b_tile);
+            }
+#if AMX_X86
+            else if (cpu_has_avx512_vnni()) {
+                i8_block_vnni(g->a, g->b, ic, mc, acc, acc_stride);
+            }
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD)
+            else {
+                i8_block_sdot(g->a, g->b, ic, mc, acc, acc_stride);
+            }
+#else
+            else {
+                i8_block_generic(g->a, g->b, ic, mc, acc, acc_stride);
+            }
+#endif
+            i8_epilogue(g, acc, acc_stride, ic, mc);
+        }
+    } else {
+        atomic_store_explicit(&g->failed, true, memory_order_relaxed);
+    }
+    
+    free(acc);
+    free(a_block);
+    free(b_tile);
+}
+
+static bool i8_gemm_run(I8Gemm *g) {
+    const AmxMatrixI8 *a = g->a, *b = g->b;
+    const size_t M = a->rows, K = a->cols, N = b->cols;
+    
+    // Zero-point corrections need the sums of the raw int8 operands
+    bool a_has_zp = false, b_has_zp = false;
+    for (size_t c = 0; c < quant_channels(a->axis, M, K); ++c) a_has_zp |= a->zero_points[c] != 0;
+    for (size_t c = 0; c < quant_channels(b->axis, K, N); ++c) b_has_zp |= b->zero_points[c] != 0;
+    
+    int32_t *row_sums = b_has_zp ? calloc(M, sizeof(int32_t)) : NULL;
+    int32_t *col_sums = a_has_zp ? calloc(N, sizeof(int32_t)) : NULL;
+    if (UNLIKELY((b_has_zp && !row_sums) || (a_has_zp && !col_sums))) {
+        free(row_sums); free(col_sums);
+        return false;
+    }
+    for (size_t i = 0; row_sums && i < M; ++i) {
+        for (size_t k = 0; k < K; ++k) row_sums[i] += a->data[i * a->stride + k];
+    }
+    for (size_t k = 0; col_sums && k < K; ++k) {
+        for (size_t j = 0; j < N; ++j) col_sums[j] += b->data[k * b->stride + j];
+    }
+    g->a_row_sums = row_sums;
+    g->b_col_sums = col_sums;
+    
+    // Distribute whole 32-row tiles across threads
+    const size_t m_tiles = (M + AMX_TILE_F16 - 1) / AMX_TILE_F16;
+    size_t num_threads = m_tiles < (size_t)num_workers() ? m_tiles : (size_t)num_workers();
+    if (M <= 64) num_threads = 1;
+    g->rows_per_task = ((m_tiles + num_threads - 1) / num_threads) * AMX_TILE_F16;
+    g->use_amx = amx_is_available();
+    atomic_init(&g->failed, false);
+    
+    parallel_for(num_threads, g, i8_gemm_task_body);
+    
+    free(row_sums);
+    free(col_sums);
+    return !atomic_load_explicit(&g->failed, memory_order_relaxed);
+}
+
+// A scales must factor per output row, B scales per output column
+static bool i8_shapes_ok(const AmxMatrixI8 *a, const AmxMatrixI8 *b) {
+    return a && b && a->cols == b->rows
+        && a->axis != AMX_QUANT_PER_COL && b->axis != AMX_QUANT_PER_ROW;
+}
+
+bool amx_matrix_i8_matmul_i32(const AmxMatrixI8 *a, const AmxMatrixI8 *b, int32_t *c, size_t c_stride) {
+    if (UNLIKELY(!i8_shapes_ok(a, b) || !c || c_stride < b->cols)) return false;
+    
+    I8Gemm g = { .a = a, .b = b, .kind = I8_OUT_I32, .out = c, .out_stride = c_stride };
+    return i8_gemm_run(&g);
+}
+
+AmxMatrix *amx_matrix_i8_matmul(const AmxMatrixI8 *a, const AmxMatrixI8 *b, const float *bias) {
+    if (UNLIKELY(!i8_shapes_ok(a, b))) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    I8Gemm g = { .a = a, .b = b, .bias = bias, .kind = I8_OUT_F32, .out = c->data, .out_stride = c->stride };
+    if (UNLIKELY(!i8_gemm_run(&g))) { amx_matrix_free(c); return NULL; }
+    return c;
+}
+
+AmxMatrixI8 *amx_matrix_i8_matmul_requant(
+    const AmxMatrixI8 *a, const AmxMatrixI8 *b, const float *bias,
+    float out_scale, int32_t out_zero_point
+) {
+    if (UNLIKELY(!i8_shapes_ok(a, b) || !(out_scale > 0.0f))) return NULL;
+    
+    AmxMatrixI8 *c = matrix_i8_alloc(a->rows, b->cols, AMX_QUANT_PER_TENSOR);
+    if (UNLIKELY(!c)) return NULL;
+    c->scales[0] = out_scale;
+    c->zero_points[0] = out_zero_point;
+    
+    I8Gemm g = {
+        .a = a, .b = b, .bias = bias, .kind = I8_OUT_I8,
+        .out = c->data, .out_stride = c->stride,
+        .out_scale = out_scale, .out_zero_point = out_zero_point
+    };
+    if (UNLIKELY(!i8_gemm_run(&g))) { amx_matrix_i8_free(c); return NULL; }
+    return c;
+}
+
+// ============================================================================
+// 4-bit Weight-Only Quantization
+// ----------------------------------------------------------------------------
+// Weights stay packed two per byte in memory and are expanded through a
+// 16-entry table right before use: into the f32 B tile the AMX microkernel
+// loads on Apple Silicon, with pshufb on x86 and tbl on NEON. Only the packed
+// nibbles and one scale per group of rows cross the memory bus.
+// ----------------------------------------------------------------------------
+
+#define Q4_TILE_COLS  128         // 128 nibbles = 64 bytes
+
+struct AmxMatrixQ4 {
+    uint8_t *RESTRICT data;  // 64-byte aligned; low nibble = even column
+    size_t rows;
+    size_t cols;
+    size_t stride;           // Bytes per row, multiple of 64
+    size_t group_size;       // Rows sharing one scale per column
+    float *scales;           // groups x scale_stride, padding columns are zero
+    size_t scale_stride;
+};
+
+// Nibble q encodes the integer level q - 8
+static const int8_t q4_levels[16] ALIGNED(16) = { -8, -7, -6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+// dst[j] = scale[j] * level(nibble j), or the bare level when scale is NULL.
+// src starts at an even column.
+static void q4_expand_scalar(const uint8_t *RESTRICT src, const float *RESTRICT scale, float *RESTRICT dst, size_t n) {
+    for (size_t j = 0; j < n; ++j) {
+        const uint8_t byte = src[j >> 1];
+        const float v = (float)q4_levels[(j & 1) ? byte >> 4 : byte & 0x0F];
+        dst[j] = scale ? scale[j] * v : v;
+    }
+}
+
+#if AMX_X86
+__attribute__((target("avx2,fma")))
+static void q4_expand_avx2(const uint8_t *RESTRICT src, const float *RESTRICT scale, float *RESTRICT dst, size_t n) {
+    const __m128i table = _mm_load_si128((const __m128i *)q4_levels);
+    const __m128i low = _mm_set1_epi8(0x0F);
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i *)(src + j / 2));
+        const __m128i lo = _mm_shuffle_epi8(table, _mm_and_si128(bytes, low));
+        const __m128i hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(bytes, 4), low));
+        const __m128i cols[2] = { _mm_unpacklo_epi8(lo, hi), _mm_unpackhi_epi8(lo, hi) };
+        for (size_t h = 0; h < 2; ++h) {
+            const __m256 v0 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(cols[h]));
+            const __m256 v1 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(cols[h], 8)));
+            float *RESTRICT d = dst + j + 16 * h;
+            if (scale) {
+                _mm256_storeu_ps(d, _mm256_mul_ps(v0, _mm256_loadu_ps(scale + j + 16 * h)));
+                _mm256_storeu_ps(d + 8, _mm256_mul_ps(v1, _mm256_loadu_ps(scale + j + 16 * h + 8)));
+            } else {
+                _mm256_storeu_ps(d, v0);
+                _mm256_storeu_ps(d + 8, v1);
+            }
+        }
+    }
+    q4_expand_scalar(src + j / 2, scale ? scale + j : NULL, dst + j, n - j);
+}
+#endif
+
+#if defined(__aarch64__)
+static void q4_expand_neon(const uint8_t *RESTRICT src, const float *RESTRICT scale, float *RESTRICT dst, size_t n) {
+    const int8x16_t table = vld1q_s8(q4_levels);
+    const uint8x16_t low = vdupq_n_u8(0x0F);
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        const uint8x16_t bytes = vld1q_u8(src + j / 2);
+        const int8x16_t lo = vqtbl1q_s8(table, vandq_u8(bytes, low));
+        const int8x16_t hi = vqtbl1q_s8(table, vshrq_n_u8(bytes, 4));
+        const int8x16_t cols[2] = { vzip1q_s8(lo, hi), vzip2q_s8(lo, hi) };
+        for (size_t h = 0; h < 2; ++h) {
+            const int16x8_t w0 = vmovl_s8(vget_low_s8(cols[h]));
+            const int16x8_t w1 = vmovl_high_s8(cols[h]);
+            float32x4_t v[4] = {
+                vcvtq_f32_s32(vmovl_s16(vget_low_s16(w0))), vcvtq_f32_s32(vmovl_high_s16(w0)),
+                vcvtq_f32_s32(vmovl_s16(vget_low_s16(w1))), vcvtq_f32_s32(vmovl_high_s16(w1))
+            };
+            float *RESTRICT d = dst + j + 16 * h;
+            for (size_t q = 0; q < 4; ++q) {
+                if (scale) v[q] = vmulq_f32(v[q], vld1q_f32(scale + j + 16 * h + 4 * q));
+                vst1q_f32(d + 4 * q, v[q]);
+            }
+        }
+    }
+    q4_expand_scalar(src + j / 2, scale ? scale + j : NULL, dst + j, n - j);
+}
+#endif
+
+static void q4_expand(const uint8_t *RESTRICT src, const float *RESTRICT scale, float *RESTRICT dst, size_t n) {
+#if defined(__aarch64__)
+    q4_expand_neon(src, scale, dst, n);
+#else
+#if AMX_X86
+    if (LIKELY(__builtin_cpu_supports("avx2"))) {
+        q4_expand_avx2(src, scale, dst, n);
+        return;
+    }
+#endif
+    q4_expand_scalar(src, scale, dst, n);
+#endif
+}
+
+ALWAYS_INLINE static const float *q4_row_scales(const AmxMatrixQ4 *w, size_t k) {
+    return w->scales + (k / w->group_size) * w->scale_stride;
+}
+
+AmxMatrixQ4 *amx_matrix_q4_quantize(const AmxMatrix *m, size_t group_size) {
+    if (UNLIKELY(!m || !group_size)) return NULL;
+    
+    AmxMatrixQ4 *w = calloc(1, sizeof(AmxMatrixQ4));
+    if (UNLIKELY(!w)) return NULL;
+    
+    w->rows = m->rows;
+    w->cols = m->cols;
+    w->stride = round_up(m->cols, Q4_TILE_COLS) / 2;
+    w->group_size = group_size;
+    w->scale_stride = round_up(m->cols, Q4_TILE_COLS);
+    
+    const size_t groups = (m->rows + group_size - 1) / group_size;
+    w->data = alloc_aligned(m->rows * w->stride);
+    w->scales = alloc_aligned(groups * w->scale_stride * sizeof(float));
+    if (UNLIKELY(!w->data || !w->scales)) {
+        amx_matrix_q4_free(w);
+        return NULL;
+    }
+    memset(w->data, 0x88, m->rows * w->stride);
+    memset(w->scales, 0, groups * w->scale_stride * sizeof(float));
+    
+    // Symmetric per (group, column): scale = max|w| / 7, levels clamped to [-8, 7]
+    for (size_t g = 0; g < groups; ++g) {
+        const size_t k0 = g * group_size;
+        const size_t k1 = (k0 + group_size < m->rows) ? k0 + group_size : m->rows;
+        float *RESTRICT scale = w->scales + g * w->scale_stride;
+        
+        for (size_t k = k0; k < k1; ++k) {
+            const float *RESTRICT row = m->data + k * m->stride;
+            for (size_t j = 0; j < m->cols; ++j) {
+                const float v = row[j] < 0.0f ? -row[j] : row[j];
+                if (v > scale[j]) scale[j] = v;
+            }
+        }
+        for (size_t j = 0; j < m->cols; ++j) scale[j] = scale[j] > 0.0f ? scale[j] / 7.0f : 1.0f;
+        
+        for (size_t k = k0; k < k1; ++k) {
+            const float *RESTRICT row = m->data + k * m->stride;
+            uint8_t *RESTRICT dst = w->data + k * w->stride;
+            for (size_t j = 0; j < m->cols; ++j) {
+                float q = __builtin_rintf(row[j] / scale[j]);
+                q = q < -8.0f ? -8.0f : q > 7.0f ? 7.0f : q;
+                const uint8_t nib = (uint8_t)((int)q + 8);
+                dst[j >> 1] = (j & 1) ? (uint8_t)((dst[j >> 1] & 0x0F) | (nib << 4))
+                                      : (uint8_t)((dst[j >> 1] & 0xF0) | nib);
+            }
+        }
+    }
+    return w;
+}
+
+AmxMatrix *amx_matrix_q4_dequantize(const AmxMatrixQ4 *w) {
+    if (UNLIKELY(!w)) return NULL;
+    
+    AmxMatrix *m = amx_matrix_zeros(w->rows, w->cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t k = 0; k < w->rows; ++k) {
+        q4_expand(w->data + k * w->stride, q4_row_scales(w, k), m->data + k * m->stride, w->cols);
+    }
+    return m;
+}
+
+void amx_matrix_q4_free(AmxMatrixQ4 *w) {
+    if (w) { free(w->data); free(w->scales); free(w); }
+}
+
+size_t amx_matrix_q4_rows(const AmxMatrixQ4 *w) { return w ? w->rows : 0; }
+size_t amx_matrix_q4_cols(const AmxMatrixQ4 *w) { return w ? w->cols : 0; }
+size_t amx_matrix_q4_stride(const AmxMatrixQ4 *w) { return w ? w->stride : 0; }
+size_t amx_matrix_q4_group_size(const AmxMatrixQ4 *w) { return w ? w->group_size : 0; }
+const uint8_t *amx_matrix_q4_data(const AmxMatrixQ4 *w) { return w ? w->data : NULL; }
+const float *amx_matrix_q4_scales(const AmxMatrixQ4 *w) { return w ? w->scales : NULL; }
+size_t amx_matrix_q4_scale_stride(const AmxMatrixQ4 *w) { return w ? w->scale_stride : 0; }
+
+// ----------------------------------------------------------------------------
+// GEMV: y = x^T W. Each task owns a block of columns and streams every packed
+// row once; levels accumulate per group and the group scale is applied once.
+// ----------------------------------------------------------------------------
+
+#define Q4_GEMV_NB 512
+
+typedef struct {
+    const AmxMatrixQ4 *w;
+    const float *x;
+    float *y;
+} Q4GemvTask;
+
+static void q4_gemv_task_body(void *ctx, size_t t) {
+    const Q4GemvTask *task = (const Q4GemvTask *)ctx;
+    const AmxMatrixQ4 *w = task->w;
+    const size_t j0 = t * Q4_GEMV_NB;
+    const size_t nb = (j0 + Q4_GEMV_NB <= w->cols) ? Q4_GEMV_NB : w->cols - j0;
+    float y_blk[Q4_GEMV_NB] ALIGNED(64) = {0};
+    float part[Q4_GEMV_NB] ALIGNED(64);
+    float levels[Q4_GEMV_NB] ALIGNED(64);
+    
+    for (size_t k0 = 0; k0 < w->rows; k0 += w->group_size) {
+        const size_t k1 = (k0 + w->group_size < w->rows) ? k0 + w->group_size : w->rows;
+        memset(part, 0, nb * sizeof(float));
+        for (size_t k = k0; k < k1; ++k) {
+            const float xk = task->x[k];
+            if (xk == 0.0f) continue;
+            q4_expand(w->data + k * w->stride + j0 / 2, NULL, levels, nb);
+            for (size_t j = 0; j < nb; ++j) part[j] += xk * levels[j];
+        }
+        const float *RESTRICT scale = q4_row_scales(w, k0) + j0;
+        for (size_t j = 0; j < nb; ++j) y_blk[j] += scale[j] * part[j];
+    }
+    memcpy(task->y + j0, y_blk, nb * sizeof(float));
+}
+
+void amx_matrix_q4_gemv(const AmxMatrixQ4 *w, const float *x, float *y) {
+    if (UNLIKELY(!w || !x || !y)) return;
+    
+    Q4GemvTask task = { .w = w, .x = x, .y = y };
+    parallel_for((w->cols + Q4_GEMV_NB - 1) / Q4_GEMV_NB, &task, q4_gemv_task_body);
+}
+
+// ----------------------------------------------------------------------------
+// GEMM: C = A * W with f32 activations. AMX expands each KC x 16 weight tile
+// once per MC-row block of A panels, like the bf16 driver.
+// ----------------------------------------------------------------------------
+
+#define Q4_MC 256
+#define Q4_KC 256
+
+HOT static void matmul_q4_rows_amx(
+    const AmxMatrix *RESTRICT a,
+    const AmxMatrixQ4 *RESTRICT w,
+    AmxMatrix *RESTRICT c,
+    size_t i_start,
+    size_t i_end,
+    float *RESTRICT a_block,    // Q4_MC x Q4_KC, as 16-row column panels
+    float *RESTRICT b_tile      // Q4_KC x 16
+) {
+    const size_t K = a->cols, N = w->cols;
+    
+    AMX_SET();
+    
+    for (size_t ic = i_start; ic < i_end; ic += Q4_MC) {
+        const size_t mc = (ic + Q4_MC <= i_end) ? Q4_MC : i_end - ic;
+        
+        for (size_t pc = 0; pc < K; pc += Q4_KC) {
+            const size_t kc = (pc + Q4_KC <= K) ? Q4_KC : K - pc;
+            
+            for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                const size_t rows = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                pack_a_panel(a->data + pc, a_block + ii * kc, ic + ii, ic + ii + rows, kc, a->stride);
+            }
+            
+            for (size_t j = 0; j < N; j += AMX_TILE) {
+                const size_t nr = (j + AMX_TILE <= N) ? AMX_TILE : N - j;
+                
+                // Padding columns carry zero scales
+                for (size_t k = 0; k < kc; ++k) {
+                    q4_expand(w->data + (pc + k) * w->stride + j / 2, q4_row_scales(w, pc + k) + j,
+                              b_tile + k * AMX_TILE, AMX_TILE);
+                }
+                
+                for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                    const size_t mr = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                    microkernel_16x16_acc(a_block + ii * kc, b_tile,
+                                          c->data + (ic + ii) * c->stride + j,
+                                          kc, AMX_TILE, c->stride, mr, nr, pc > 0);
+                }
+            }
+        }
+    }
+    
+    AMX_CLR();
+}
+
+// Portable: expand a KC x NC weight block on the stack, then a vectorized axpy loop
+HOT static void matmul_q4_rows_portable(
+    const AmxMatrix *RESTRICT a,
+    const AmxMatrixQ4 *RESTRICT w,
+    AmxMatrix *RESTRICT c,
+    size_t i_start,
+    size_t i_end
+) {
+    enum { KC = 128, NC = 64 };
+    float b_buf[KC * NC] ALIGNED(64);
+    const size_t K = a->cols, N = w->cols;
+    
+    for (size_t jc = 0; jc < N; jc += NC) {
+        const size_t nc = (jc + NC <= N) ? NC : N - jc;
+        for (size_t pc = 0; pc < K; pc += KC) {
+            const size_t kc = (pc + KC <= K) ? KC : K - pc;
+            for (size_t k = 0; k < kc; ++k) {
+                q4_expand(w->data + (pc + k) * w->stride + jc / 2, q4_row_scales(w, pc + k) + jc,
+                          b_buf + k * NC, nc);
+            }
+            
+            for (size_t i = i_start; i < i_end; ++i) {
+                const float *RESTRICT a_row = a->data + i * a->stride + pc;
+                float *RESTRICT c_row = c->data + i * c->stride + jc;
+                for (size_t k = 0; k < kc; ++k) {
+                    const float a_val = a_row[k];
+                    const float *RESTRICT b_row = b_buf + k * NC;
+                    for (size_t j = 0; j < nc; ++j) {
+                        c_row[j] += a_val * b_row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    const AmxMatrix *a;
+    const AmxMatrixQ4 *w;
+    AmxMatrix *c;
+    size_t i_start, i_end;   // Row range for this thread
+    bool use_amx;
+} MatmulQ4Task;
+
+static void matmul_q4_task_body(void *ctx, size_t t) {
+    MatmulQ4Task *task = &((MatmulQ4Task *)ctx)[t];
+    if (task->i_start >= task->i_end) return;
+    
+    if (task->use_amx) {
+        float *a_block = alloc_aligned(Q4_MC * Q4_KC * sizeof(float));
+        float *b_tile = alloc_aligned(Q4_KC * AMX_TILE * sizeof(float));
+        if (LIKELY(a_block && b_tile)) {
+            matmul_q4_rows_amx(task->a, task->w, task->c, task->i_start, task->i_end, a_block, b_tile);
+            free(a_block);
+            free(b_tile);
+            return;
+        }
+        free(a_block);
+        free(b_tile);
+    }
+    matmul_q4_rows_portable(task->a, task->w, task->c, task->i_start, task->i_end);
+}
+
+AmxMatrix *amx_matrix_q4_matmul(const AmxMatrix *a, const AmxMatrixQ4 *w) {
+    if (UNLIKELY(!a || !w || a->cols != w->rows)) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(a->rows, w->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    // A single activation row is a GEMV: parallelize over columns instead
+    if (a->rows == 1) {
+        amx_matrix_q4_gemv(w, a->data, c->data);
+        return c;
+    }
+    
+    const size_t M = a->rows;
+    const size_t m_tiles = (M + AMX_TILE - 1) / AMX_TILE;
+    size_t num_threads = m_tiles < (size_t)num_workers() ? m_tiles : (size_t)num_workers();
+    if (M <= 64) num_threads = 1;
+    
+    const size_t rows_per_thread = ((m_tiles + num_threads - 1) / num_threads) * AMX_TILE;
+    MatmulQ4Task tasks[AMX_MAX_THREADS];
+    for (size_t t = 0; t < num_threads; ++t) {
+        size_t start = t * rows_per_thread;
+        size_t end = start + rows_per_thread;
+        if (start > M) start = M;
+        if (end > M) end = M;
+        tasks[t] = (MatmulQ4Task){
+            .a = a, .w = w, .c = c,
+            .i_start = start, .i_end = end,
+            .use_amx = amx_is_available()
+        };
+    }
+    
+    parallel_for(num_threads, tasks, matmul_q4_task_body);
+    return c;
+}
+
+// ============================================================================
+// INT16 Fixed-Point GEMM
+// ----------------------------------------------------------------------------
+// Products accumulate in int32 on every backend: mac16 into 32-bit Z rows on
+// AMX, pmaddwd on x86, smlal on NEON. The store applies a rounding arithmetic
+// right shift and saturates to int16, so Q15 x Q15 with shift 15 yields Q15.
+// ----------------------------------------------------------------------------
+
+#define AMX_ALIGN_I16 32          // 32 int16 = 64 bytes
+
+struct AmxMatrixI16 {
+    int16_t *RESTRICT data;  // 64-byte aligned, row-major with padded stride
+    size_t rows;
+    size_t cols;
+    size_t stride;           // >= cols, multiple of 32
+};
+
+ALWAYS_INLINE static int16_t sat_i16(int64_t v) {
+    return (int16_t)(v < INT16_MIN ? INT16_MIN : v > INT16_MAX ? INT16_MAX : v);
+}
+
+void amx_f32_to_q15(const float *RESTRICT src, int16_t *RESTRICT dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = __builtin_rintf(src[i] * 32768.0f);
+        v = v < -32768.0f ? -32768.0f : v > 32767.0f ? 32767.0f : v;
+        dst[i] = (int16_t)v;
+    }
+}
+
+void amx_q15_to_f32(const int16_t *RESTRICT src, float *RESTRICT dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] = (float)src[i] * (1.0f / 32768.0f);
+}
+
+AmxMatrixI16 *amx_matrix_i16_zeros(size_t rows, size_t cols) {
+    if (UNLIKELY(!rows || !cols)) return NULL;
+    
+    AmxMatrixI16 *m = malloc(sizeof(AmxMatrixI16));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = round_up(cols, AMX_ALIGN_I16);
+    
+    const size_t size = rows * m->stride * sizeof(int16_t);
+    m->data = alloc_aligned(size);
+    if (UNLIKELY(!m->data)) { free(m); return NULL; }
+    
+    memset(m->data, 0, size);
+    return m;
+}
+
+AmxMatrixI16 *amx_matrix_i16_from_data(size_t rows, size_t cols, const int16_t *RESTRICT data) {
+    if (UNLIKELY(!data)) return NULL;
+    
+    AmxMatrixI16 *m = amx_matrix_i16_zeros(rows, cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < rows; ++i) {
+        memcpy(m->data + i * m->stride, data + i * cols, cols * sizeof(int16_t));
+    }
+    return m;
+}
+
+void amx_matrix_i16_free(AmxMatrixI16 *m) {
+    if (m) { free(m->data); free(m); }
+}
+
+size_t amx_matrix_i16_rows(const AmxMatrixI16 *m) { return m ? m->rows : 0; }
+size_t amx_matrix_i16_cols(const AmxMatrixI16 *m) { return m ? m->cols : 0; }
+size_t amx_matrix_i16_stride(const AmxMatrixI16 *m) { return m ? m->stride : 0; }
+const int16_t *amx_matrix_i16_data(const AmxMatrixI16 *m) { return m ? m->data : NULL; }
+int16_t *amx_matrix_i16_data_mut(AmxMatrixI16 *m) { return m ? m->data : NULL; }
+int16_t amx_matrix_i16_get(const AmxMatrixI16 *m, size_t r, size_t c) { return m->data[r * m->stride + c]; }
+void amx_matrix_i16_set(AmxMatrixI16 *m, size_t r, size_t c, int16_t v) { m->data[r * m->stride + c] = v; }
+
+#define I16_MC 256
+#define I16_KC 256
+
+// AMX: A is packed into 32-row column panels, B rows feed mac16 directly
+HOT static void i16_block_amx(
+    const AmxMatrixI16 *RESTRICT a,
+    const AmxMatrixI16 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride,
+    int16_t *RESTRICT a_block    // I16_MC x I16_KC, as 32-row column panels
+) {
+    const size_t K = a->cols, N = b->cols;
+    
+    AMX_SET();
+    
+    for (size_t pc = 0; pc < K; pc += I16_KC) {
+        const size_t kc = (pc + I16_KC <= K) ? I16_KC : K - pc;
+        
+        for (size_t ii = 0; ii < mc; ii += AMX_TILE_F16) {
+            int16_t *RESTRICT panel = a_block + ii * kc;
+            const size_t rows = (ii + AMX_TILE_F16 <= mc) ? AMX_TILE_F16 : mc - ii;
+            for (size_t r = 0; r < AMX_TILE_F16; ++r) {
+                const int16_t *RESTRICT src = a->data + (ic + ii + r) * a->stride + pc;
+                for (size_t k = 0; k < kc; ++k) {
+                    panel[k * AMX_TILE_F16 + r] = r < rows ? src[k] : 0;
+                }
+            }
+        }
+        
+        for (size_t j = 0; j < N; j += AMX_TILE_F16) {
+            const size_t nr = (j + AMX_TILE_F16 <= N) ? AMX_TILE_F16 : N - j;
+            for (size_t ii = 0; ii < mc; ii += AMX_TILE_F16) {
+                const size_t mr = (ii + AMX_TILE_F16 <= mc) ? AMX_TILE_F16 : mc - ii;
+                microkernel_i16_32x32(a_block + ii * kc, b->data + pc * b->stride + j,
+                                      acc + ii * acc_stride + j,
+                                      kc, b->stride, acc_stride, mr, nr, pc > 0);
+            }
+        }
+    }
+    
+    AMX_CLR();
+}
+
+#if AMX_X86
+// ----------------------------------------------------------------------------
+// AVX2 pmaddwd: B is packed into 16-column strips of k-pairs, an A pair is
+// broadcast as one 32-bit lane. Odd K meets zero B lanes; the A read past K
+// stays inside the padded row.
+// ----------------------------------------------------------------------------
+
+#define I16_NR 16
+
+__attribute__((target("avx2")))
+static void i16_block_avx2(
+    const AmxMatrixI16 *RESTRICT a,
+    const AmxMatrixI16 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride
+) {
+    enum { MR = 4 };
+    int16_t strip[I16_KC * I16_NR] ALIGNED(64);
+    const size_t K = a->cols, N = b->cols;
+    
+    for (size_t j = 0; j < N; j += I16_NR) {
+        const size_t nr = (j + I16_NR <= N) ? I16_NR : N - j;
+        for (size_t pc = 0; pc < K; pc += I16_KC) {
+            const size_t kc = (pc + I16_KC <= K) ? I16_KC : K - pc;
+            const size_t pairs = (kc + 1) / 2;
+            
+            // dst[p][2*col + t] = B[pc + 2p + t][j + col], zero padded
+            for (size_t p = 0; p < pairs; ++p) {
+                for (size_t col = 0; col < I16_NR; ++col) {
+                    for (size_t t = 0; t < 2; ++t) {
+                        const size_t k = 2 * p + t;
+                        strip[p * 2 * I16_NR + 2 * col + t] =
+                            (col < nr && k < kc) ? b->data[(pc + k) * b->stride + j + col] : 0;
+                    }
+                }
+            }
+            
+            for (size_t i = 0; i < mc; i += MR) {
+                const size_t mr = (i + MR <= mc) ? MR : mc - i;
+                __m256i c0[MR], c1[MR];
+                for (size_t r = 0; r < MR; ++r) c0[r] = c1[r] = _mm256_setzero_si256();
+                
+                const int16_t *RESTRICT a_base = a->data + (ic + i) * a->stride + pc;
+                for (size_t p = 0; p < pairs; ++p) {
+                    const __m256i b0 = _mm256_load_si256((const __m256i *)(strip + p * 2 * I16_NR));
+                    const __m256i b1 = _mm256_load_si256((const __m256i *)(strip + p * 2 * I16_NR + 16));
+                    for (size_t r = 0; r < MR; ++r) {
+                        if (r < mr) {
+                            int32_t pair;
+                            memcpy(&pair, a_base + r * a->stride + 2 * p, sizeof(pair));
+                            const __m256i av = _mm256_set1_epi32(pair);
+                            c0[r] = _mm256_add_epi32(c0[r], _mm256_madd_epi16(av, b0));
+                            c1[r] = _mm256_add_epi32(c1[r], _mm256_madd_epi16(av, b1));
+                        }
+                    }
+                }
+                
+                for (size_t r = 0; r < mr; ++r) {
+                    int32_t out[I16_NR] ALIGNED(32);
+                    _mm256_store_si256((__m256i *)out, c0[r]);
+                    _mm256_store_si256((__m256i *)(out + 8), c1[r]);
+                    int32_t *RESTRICT c_row = acc + (i + r) * acc_stride + j;
+                    for (size_t t = 0; t < nr; ++t) c_row[t] += out[t];
+                }
+            }
+        }
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+// NEON smlal: 4 rows x 16 columns of int32 accumulators, B rows read in place
+static void i16_block_neon(
+    const AmxMatrixI16 *RESTRICT a,
+    const AmxMatrixI16 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride
+) {
+    enum { MR = 4, NR = 16 };
+    const size_t K = a->cols, N = b->cols;
+    
+    // Row padding makes every 16-column load in bounds; extra lanes are dropped
+    for (size_t j = 0; j < N; j += NR) {
+        const size_t nr = (j + NR <= N) ? NR : N - j;
+        for (size_t i = 0; i < mc; i += MR) {
+            const size_t mr = (i + MR <= mc) ? MR : mc - i;
+            int32x4_t c[MR][4];
+            for (size_t r = 0; r < MR; ++r) {
+                for (size_t v = 0; v < 4; ++v) c[r][v] = vdupq_n_s32(0);
+            }
+            
+            for (size_t k = 0; k < K; ++k) {
+                const int16_t *RESTRICT b_row = b->data + k * b->stride + j;
+                const int16x8_t b0 = vld1q_s16(b_row);
+                const int16x8_t b1 = vld1q_s16(b_row + 8);
+                for (size_t r = 0; r < MR; ++r) {
+                    if (r < mr) {
+                        const int16_t av = a->data[(ic + i + r) * a->stride + k];
+                        c[r][0] = vmlal_n_s16(c[r][0], vget_low_s16(b0), av);
+                        c[r][1] = vmlal_high_n_s16(c[r][1], b0, av);
+                        c[r][2] = vmlal_n_s16(c[r][2], vget_low_s16(b1), av);
+                        c[r][3] = vmlal_high_n_s16(c[r][3], b1, av);
+                    }
+                }
+            }
+            
+            for (size_t r = 0; r < mr; ++r) {
+                int32_t out[NR];
+                for (size_t v = 0; v < 4; ++v) vst1q_s32(out + 4 * v, c[r][v]);
+                int32_t *RESTRICT c_row = acc + (i + r) * acc_stride + j;
+                for (size_t t = 0; t < nr; ++t) c_row[t] += out[t];
+            }
+        }
+    }
+}
+#endif
+
+// Generic: int32 axpy over int16 rows, left to the auto-vectorizer
+HOT static void i16_block_generic(
+    const AmxMatrixI16 *RESTRICT a,
+    const AmxMatrixI16 *RESTRICT b,
+    size_t ic,
+    size_t mc,
+    int32_t *RESTRICT acc,
+    size_t acc_stride
+) {
+    const size_t K = a->cols, N = b->cols;
+    for (size_t i = 0; i < mc; ++i) {
+        const int16_t *RESTRICT a_row = a->data + (ic + i) * a->stride;
+        int32_t *RESTRICT c_row = acc + i * acc_stride;
+        for (size_t k = 0; k < K; ++k) {
+            const int32_t a_val = a_row[k];
+            const int16_t *RESTRICT b_row = b->data + k * b->stride;
+            for (size_t j = 0; j < N; ++j) c_row[j] += a_val * b_row[j];
+        }
+    }
+}
+
+typedef struct {
+    const AmxMatrixI16 *a;
+    const AmxMatrixI16 *b;
+    int32_t *out_i32;        // Raw accumulators, or
+    AmxMatrixI16 *out_i16;   // shifted and saturated
+    size_t out_stride;
+    unsigned shift;
+    size_t rows_per_task;
+    bool use_amx;
+    atomic_bool failed;      // A task could not allocate its accumulators
+} I16Gemm;
+
+static void i16_gemm_task_body(void *ctx, size_t t) {
+    I16Gemm *g = (I16Gemm *)ctx;
+    const size_t M = g->a->rows, N = g->b->cols;
+    const size_t i_start = t * g->rows_per_task;
+    const size_t i_end = (i_start + g->rows_per_task < M) ? i_start + g->rows_per_task : M;
+    if (i_start >= i_end) return;
+    
+    const size_t acc_stride = round_up(N, AMX_TILE);
+    const size_t mc_max = (i_end - i_start < I16_MC) ? i_end - i_start : I16_MC;
+    int32_t *acc = alloc_aligned(round_up(mc_max, AMX_TILE_F16) * acc_stride * sizeof(int32_t));
+    int16_t *a_block = g->use_amx ? alloc_aligned(I16_MC * I16_KC * sizeof(int16_t)) : NULL;
+    const int64_t round = g->shift ? (int64_t)1 << (g->shift - 1) : 0;
+    
+    if (LIKELY(acc)) {
+        for (size_t ic = i_start; ic < i_end; ic += I16_MC) {
+            const size_t mc = (ic + I16_MC <= i_end) ? I16_MC : i_end - ic;
+            memset(acc, 0, mc * acc_stride * sizeof(int32_t));
+            
+            if (a_block) {
+                i16_block_amx(g->a, g->b, ic, mc, acc, acc_stride, a_block);
+            }
+#if AMX_X86
+            else if (__builtin_cpu_supports("avx2")) {
+                i16_block_avx2(g->a, g->b, ic, mc, acc, acc_stride);
+            }
+#endif
+#if defined(__aarch64__)
+            else {
+                i16_block_neon(g->a, g->b, ic, mc, acc, acc_stride);
+            }
+#else
+            else {
+                i16_block_generic(g->a, g->b, ic, mc, acc, acc_stride);
+            }
+#endif
+            
+            for (size_t r = 0; r < mc; ++r) {
+                const int32_t *RESTRICT src = acc + r * acc_stride;
+                if (g->out_i32) {
+                    memcpy(g->out_i32 + (ic + r) * g->out_stride, src, N * sizeof(int32_t));
+                } else {
+                    int16_t *RESTRICT dst = g->out_i16->data + (ic + r) * g->out_i16->stride;
+                    for (size_t j = 0; j < N; ++j) dst[j] = sat_i16(((int64_t)src[j] + round) >> g->shift);
+                }
+            }
+        }
+    } else {
+        atomic_store_explicit(&g->failed, true, memory_order_relaxed);
+    }
+    
+    free(acc);
+    free(a_block);
+}
+
+static bool i16_gemm_run(I16Gemm *g) {
+    const size_t M = g->a->rows;
+    const size_t m_tiles = (M + AMX_TILE_F16 - 1) / AMX_TILE_F16;
+    size_t num_threads = m_tiles < (size_t)num_workers() ? m_tiles : (size_t)num_workers();
+    if (M <= 64) num_threads = 1;
+    
+    // Distribute whole 32-row tiles across threads
+    g->rows_per_task = ((m_tiles + num_threads - 1) / num_threads) * AMX_TILE_F16;
+    g->use_amx = amx_is_available();
+    atomic_init(&g->failed, false);
+    parallel_for(num_threads, g, i16_gemm_task_body);
+    return !atomic_load_explicit(&g->failed, memory_order_relaxed);
+}
+
+bool amx_matrix_i16_matmul_i32(const AmxMatrixI16 *a, const AmxMatrixI16 *b, int32_t *c, size_t c_stride) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows || !c || c_stride < b->cols)) return false;
+    
+    I16Gemm g = { .a = a, .b = b, .out_i32 = c, .out_stride = c_stride };
+    return i16_gemm_run(&g);
+}
+
+AmxMatrixI16 *amx_matrix_i16_matmul(const AmxMatrixI16 *a, const AmxMatrixI16 *b, unsigned shift) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows || shift > 31)) return NULL;
+    
+    AmxMatrixI16 *c = amx_matrix_i16_zeros(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    I16Gemm g = { .a = a, .b = b, .out_i16 = c, .shift = shift };
+    if (UNLIKELY(!i16_gemm_run(&g))) { amx_matrix_i16_free(c); return NULL; }
+    return c;
+}
+
+// ============================================================================
+// Complex Single Precision (CGEMM)
+// ----------------------------------------------------------------------------
+// Split storage: a real plane and an imaginary plane with the f32 layout.
+// The AMX driver packs the real, imaginary (and for 3M, summed) panels of A
+// and tiles of B together and keeps every partial product in Z:
+//   3M: Z0 = Ar*Br, Z1 = Ai*Bi, Z2 = (Ar+Ai)(Br+Bi)
+//       Cr = Z0 - Z1, Ci = Z2 - Z0 - Z1
+//   4M: Z0 = Ar*Br - Ai*Bi, Z1 = Ar*Bi + Ai*Br
+// so no intermediate matrices exist. A later K block resumes 3M from
+// Z0 = Cr, Z1 = 0, Z2 = Ci + Cr, which reproduces the same sums.
+// ----------------------------------------------------------------------------
+
+struct AmxMatrixC32 {
+    float *RESTRICT re;      // 64-byte aligned planes, row-major with padded stride
+    float *RESTRICT im;
+    size_t rows;
+    size_t cols;
+    size_t stride;           // >= cols, multiple of 16
+};
+
+AmxMatrixC32 *amx_matrix_c32_zeros(size_t rows, size_t cols) {
+    if (UNLIKELY(!rows || !cols)) return NULL;
+    
+    AmxMatrixC32 *m = malloc(sizeof(AmxMatrixC32));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = round_up(cols, AMX_TILE);
+    
+    const size_t plane = rows * m->stride;
+    m->re = alloc_aligned(2 * plane * sizeof(float));
+    if (UNLIKELY(!m->re)) { free(m); return NULL; }
+    m->im = m->re + plane;
+    
+    memset(m->re, 0, 2 * plane * sizeof(float));
+    return m;
+}
+
+AmxMatrixC32 *amx_matrix_c32_from_split(size_t rows, size_t cols, const float *RESTRICT re, const float *RESTRICT im) {
+    if (UNLIKELY(!re)) return NULL;
+    
+    AmxMatrixC32 *m = amx_matrix_c32_zeros(rows, cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < rows; ++i) {
+        memcpy(m->re + i * m->stride, re + i * cols, cols * sizeof(float));
+        if (im) memcpy(m->im + i * m->stride, im + i * cols, cols * sizeof(float));
+    }
+    return m;
+}
+
+AmxMatrixC32 *amx_matrix_c32_from_interleaved(size_t rows, size_t cols, const float *RESTRICT data) {
+    if (UNLIKELY(!data)) return NULL;
+    
+    AmxMatrixC32 *m = amx_matrix_c32_zeros(rows, cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < rows; ++i) {
+        const float *RESTRICT src = data + 2 * i * cols;
+        float *RESTRICT re = m->re + i * m->stride;
+        float *RESTRICT im = m->im + i * m->stride;
+        for (size_t j = 0; j < cols; ++j) {
+            re[j] = src[2 * j];
+            im[j] = src[2 * j + 1];
+        }
+    }
+    return m;
+}
+
+void amx_matrix_c32_to_interleaved(const AmxMatrixC32 *m, float *RESTRICT out) {
+    if (UNLIKELY(!m || !out)) return;
+    
+    for (size_t i = 0; i < m->rows; ++i) {
+        const float *RESTRICT re = m->re + i * m->stride;
+        const float *RESTRICT im = m->im + i * m->stride;
+        float *RESTRICT dst = out + 2 * i * m->cols;
+        for (size_t j = 0; j < m->cols; ++j) {
+            dst[2 * j] = re[j];
+            dst[2 * j + 1] = im[j];
+        }
+    }
+}
+
+void amx_matrix_c32_free(AmxMatrixC32 *m) {
+    if (m) { free(m->re); free(m); }
+}
+
+size_t amx_matrix_c32_rows(const AmxMatrixC32 *m) { return m ? m->rows : 0; }
+size_t amx_matrix_c32_cols(const AmxMatrixC32 *m) { return m ? m->cols : 0; }
+size_t amx_matrix_c32_stride(const AmxMatrixC32 *m) { return m ? m->stride : 0; }
+const float *amx_matrix_c32_real(const AmxMatrixC32 *m) { return m ? m->re : NULL; }
+const float *amx_matrix_c32_imag(const AmxMatrixC32 *m) { return m ? m->im : NULL; }
+float *amx_matrix_c32_real_mut(AmxMatrixC32 *m) { return m ? m->re : NULL; }
+float *amx_matrix_c32_imag_mut(AmxMatrixC32 *m) { return m ? m->im : NULL; }
+
+void amx_matrix_c32_get(const AmxMatrixC32 *m, size_t r, size_t c, float *re, float *im) {
+    *re = m->re[r * m->stride + c];
+    *im = m->im[r * m->stride + c];
+}
+
+void amx_matrix_c32_set(AmxMatrixC32 *m, size_t r, size_t c, float re, float im) {
+    m->re[r * m->stride + c] = re;
+    m->im[r * m->stride + c] = im;
+}
+
+#define C32_MC 128
+#define C32_KC 256
+
+// Complex 16x16 tile: planes are [re, im, re+im] panels of A (stride 16) and
+// tiles of B (stride 16); the sum planes are only read by 3M.
+HOT FLATTEN static void microkernel_c32_16x16(
+    const float *RESTRICT A,     // 3 planes of a 16 x K panel, plane stride a_plane
+    const float *RESTRICT B,     // 3 planes of a K x 16 tile, plane stride b_plane
+    float *RESTRICT Cr,
+    float *RESTRICT Ci,
+    size_t K,
+    size_t a_plane,
+    size_t b_plane,
+    size_t c_stride,
+    size_t mr,
+    size_t nr,
+    bool load_c,
+    bool three_m
+) {
+    float r0[AMX_TILE] ALIGNED(64) = {0};
+    float r1[AMX_TILE] ALIGNED(64) = {0};
+    float r2[AMX_TILE] ALIGNED(64) = {0};
+    static const float zeros[AMX_TILE] ALIGNED(64) = {0};
+    const float *RESTRICT Ar = A, *RESTRICT Ai = A + a_plane, *RESTRICT As = A + 2 * a_plane;
+    const float *RESTRICT Br = B, *RESTRICT Bi = B + b_plane, *RESTRICT Bs = B + 2 * b_plane;
+    
+    for (size_t r = 0; r < AMX_TILE; ++r) {
+        if (load_c && r < mr) {
+            memcpy(r0, Cr + r * c_stride, nr * sizeof(float));
+            memcpy(r1, Ci + r * c_stride, nr * sizeof(float));
+        } else {
+            memset(r0, 0, sizeof(r0));
+            memset(r1, 0, sizeof(r1));
+        }
+        AMX_LDZ(r0, r * 4);
+        if (three_m) {
+            for (size_t t = 0; t < AMX_TILE; ++t) r2[t] = r1[t] + r0[t];
+            AMX_LDZ(zeros, r * 4 + 1);
+            AMX_LDZ(r2, r * 4 + 2);
+        } else {
+            AMX_LDZ(r1, r * 4 + 1);
+        }
+    }
+    
+    if (three_m) {
+        size_t k = 0;
+        for (; k + 2 <= K; k += 2) {
+            AMX_LDY(Ar + k * 16, 0);      AMX_LDY(Ai + k * 16, 1);      AMX_LDY(As + k * 16, 2);
+            AMX_LDY(Ar + k * 16 + 16, 3); AMX_LDY(Ai + k * 16 + 16, 4); AMX_LDY(As + k * 16 + 16, 5);
+            AMX_LDX(Br + k * 16, 0);      AMX_LDX(Bi + k * 16, 1);      AMX_LDX(Bs + k * 16, 2);
+            AMX_LDX(Br + k * 16 + 16, 3); AMX_LDX(Bi + k * 16 + 16, 4); AMX_LDX(Bs + k * 16 + 16, 5);
+            AMX_FMA32(0 * 64, 0 * 64, 0);
+            AMX_FMA32(1 * 64, 1 * 64, 1);
+            AMX_FMA32(2 * 64, 2 * 64, 2);
+            AMX_FMA32(3 * 64, 3 * 64, 0);
+            AMX_FMA32(4 * 64, 4 * 64, 1);
+            AMX_FMA32(5 * 64, 5 * 64, 2);
+        }
+        for (; k < K; ++k) {
+            AMX_LDY(Ar + k * 16, 0); AMX_LDY(Ai + k * 16, 1); AMX_LDY(As + k * 16, 2);
+            AMX_LDX(Br + k * 16, 0); AMX_LDX(Bi + k * 16, 1); AMX_LDX(Bs + k * 16, 2);
+            AMX_FMA32(0 * 64, 0 * 64, 0);
+            AMX_FMA32(1 * 64, 1 * 64, 1);
+            AMX_FMA32(2 * 64, 2 * 64, 2);
+        }
+    } else {
+        size_t k = 0;
+        for (; k + 2 <= K; k += 2) {
+            AMX_LDY(Ar + k * 16, 0);      AMX_LDY(Ai + k * 16, 1);
+            AMX_LDY(Ar + k * 16 + 16, 2); AMX_LDY(Ai + k * 16 + 16, 3);
+            AMX_LDX(Br + k * 16, 0);      AMX_LDX(Bi + k * 16, 1);
+            AMX_LDX(Br + k * 16 + 16, 2); AMX_LDX(Bi + k * 16 + 16, 3);
+            AMX_FMA32(0 * 64, 0 * 64, 0);
+            AMX_FMS32(1 * 64, 1 * 64, 0);
+            AMX_FMA32(1 * 64, 0 * 64, 1);
+            AMX_FMA32(0 * 64, 1 * 64, 1);
+            AMX_FMA32(2 * 64, 2 * 64, 0);
+            AMX_FMS32(3 * 64, 3 * 64, 0);
+            AMX_FMA32(3 * 64, 2 * 64, 1);
+            AMX_FMA32(2 * 64, 3 * 64, 1);
+        }
+        for (; k < K; ++k) {
+            AMX_LDY(Ar + k * 16, 0); AMX_LDY(Ai + k * 16, 1);
+            AMX_LDX(Br + k * 16, 0); AMX_LDX(Bi + k * 16, 1);
+            AMX_FMA32(0 * 64, 0 * 64, 0);
+            AMX_FMS32(1 * 64, 1 * 64, 0);
+            AMX_FMA32(1 * 64, 0 * 64, 1);
+            AMX_FMA32(0 * 64, 1 * 64, 1);
+        }
+    }
+    
+    for (size_t r = 0; r < mr; ++r) {
+        AMX_STZ(r0, r * 4);
+        AMX_STZ(r1, r * 4 + 1);
+        float *RESTRICT cr = Cr + r * c_stride;
+        float *RESTRICT ci = Ci + r * c_stride;
+        if (three_m) {
+            AMX_STZ(r2, r * 4 + 2);
+            for (size_t t = 0; t < nr; ++t) {
+                cr[t] = r0[t] - r1[t];
+                ci[t] = r2[t] - r0[t] - r1[t];
+            }
+        } else {
+            memcpy(cr, r0, nr * sizeof(float));
+            memcpy(ci, r1, nr * sizeof(float));
+        }
+    }
+}
+
+HOT static void matmul_c32_rows_amx(
+    const AmxMatrixC32 *RESTRICT a,
+    const AmxMatrixC32 *RESTRICT b,
+    AmxMatrixC32 *RESTRICT c,
+    size_t i_start,
+    size_t i_end,
+    bool three_m,
+    float *RESTRICT a_block,    // 3 planes of C32_MC x C32_KC, as 16-row column panels
+    float *RESTRICT b_tile      // 3 planes of C32_KC x 16
+) {
+    const size_t K = a->cols, N = b->cols;
+    const size_t a_plane = C32_MC * C32_KC, b_plane = C32_KC * AMX_TILE;
+    
+    AMX_SET();
+    
+    for (size_t ic = i_start; ic < i_end; ic += C32_MC) {
+        const size_t mc = (ic + C32_MC <= i_end) ? C32_MC : i_end - ic;
+        
+        for (size_t pc = 0; pc < K; pc += C32_KC) {
+            const size_t kc = (pc + C32_KC <= K) ? C32_KC : K - pc;
+            
+            for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                const size_t rows = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                float *RESTRICT pr = a_block + ii * kc;
+                float *RESTRICT pi = pr + a_plane;
+                float *RESTRICT ps = pi + a_plane;
+                pack_a_panel(a->re + pc, pr, ic + ii, ic + ii + rows, kc, a->stride);
+                pack_a_panel(a->im + pc, pi, ic + ii, ic + ii + rows, kc, a->stride);
+                if (three_m) {
+                    for (size_t e = 0; e < kc * AMX_TILE; ++e) ps[e] = pr[e] + pi[e];
+                }
+            }
+            
+            for (size_t j = 0; j < N; j += AMX_TILE) {
+                const size_t nr = (j + AMX_TILE <= N) ? AMX_TILE : N - j;
+                
+                // Padding lanes only feed output columns that are never stored
+                for (size_t k = 0; k < kc; ++k) {
+                    const float *RESTRICT br = b->re + (pc + k) * b->stride + j;
+                    const float *RESTRICT bi = b->im + (pc + k) * b->stride + j;
+                    float *RESTRICT tr = b_tile + k * AMX_TILE;
+                    memcpy(tr, br, AMX_TILE * sizeof(float));
+                    memcpy(tr + b_plane, bi, AMX_TILE * sizeof(float));
+                    if (three_m) {
+                        for (size_t t = 0; t < AMX_TILE; ++t) tr[2 * b_plane + t] = br[t] + bi[t];
+                    }
+                }
+                
+                for (size_t ii = 0; ii < mc; ii += AMX_TILE) {
+                    const size_t mr = (ii + AMX_TILE <= mc) ? AMX_TILE : mc - ii;
+                    const size_t off = (ic + ii) * c->stride + j;
+                    microkernel_c32_16x16(a_block + ii * kc, b_tile, c->re + off, c->im + off,
+                                          kc, a_plane, b_plane, c->stride, mr, nr, pc > 0, three_m);
+                }
+            }
+        }
+    }
+    
+    AMX_CLR();
+}
+
+// Portable: copy a KC x NC block of B (plus its re+im sums for 3M) to the
+// stack and accumulate both output planes row by row
+HOT static void matmul_c32_rows_portable(
+    const AmxMatrixC32 *RESTRICT a,
+    const AmxMatrixC32 *RESTRICT b,
+    AmxMatrixC32 *RESTRICT c,
+    size_t i_start,
+    size_t i_end,
+    bool three_m
+) {
+    enum { KC = 128, NC = 32 };
+    float br_buf[KC * NC] ALIGNED(64);
+    float bi_buf[KC * NC] ALIGNED(64);
+    float bs_buf[KC * NC] ALIGNED(64);
+    const size_t K = a->cols, N = b->cols;
+    
+    for (size_t jc = 0; jc < N; jc += NC) {
+        const size_t nc = (jc + NC <= N) ? NC : N - jc;
+        for (size_t pc = 0; pc < K; pc += KC) {
+            const size_t kc = (pc + KC <= K) ? KC : K - pc;
+            for (size_t k = 0; k < kc; ++k) {
+                const float *RESTRICT br = b->re + (pc + k) * b->stride + jc;
+                const float *RESTRICT bi = b->im + (pc + k) * b->stride + jc;
+                for (size_t j = 0; j < nc; ++j) {
+                    br_buf[k * NC + j] = br[j];
+                    bi_buf[k * NC + j] = bi[j];
+                    bs_buf[k * NC + j] = br[j] + bi[j];
+                }
+            }
+            
+            for (size_t i = i_start; i < i_end; ++i) {
+                const float *RESTRICT a_re = a->re + i * a->stride + pc;
+                const float *RESTRICT a_im = a->im + i * a->stride + pc;
+                float *RESTRICT cr = c->re + i * c->stride + jc;
+                float *RESTRICT ci = c->im + i * c->stride + jc;
+                for (size_t k = 0; k < kc; ++k) {
+                    const float ar = a_re[k], ai = a_im[k], as = ar + ai;
+                    const float *RESTRICT br = br_buf + k * NC;
+                    const float *RESTRICT bi = bi_buf + k * NC;
+                    const float *RESTRICT bs = bs_buf + k * NC;
+                    if (three_m) {
+                        for (size_t j = 0; j < nc; ++j) {
+                            const float t1 = ar * br[j], t2 = ai * bi[j];
+                            cr[j] += t1 - t2;
+                            ci[j] += as * bs[j] - t1 - t2;
+                        }
+                    } else {
+                        for (size_t j = 0; j < nc; ++j) {
+                            cr[j] += ar * br[j] - ai * bi[j];
+                            ci[j] += ar * bi[j] + ai * br[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    const AmxMatrixC32 *a;
+    const AmxMatrixC32 *b;
+    AmxMatrixC32 *c;
+    size_t i_start, i_end;   // Row range for this thread
+    bool three_m;
+    bool use_amx;
+} MatmulC32Task;
+
+static void matmul_c32_task_body(void *ctx, size_t t) {
+    MatmulC32Task *task = &((MatmulC32Task *)ctx)[t];
+    if (task->i_start >= task->i_end) return;
+    
+    if (task->use_amx) {
+        float *a_block = alloc_aligned(3 * C32_MC * C32_KC * sizeof(float));
+        float *b_tile = alloc_aligned(3 * C32_KC * AMX_TILE * sizeof(float));
+        if (LIKELY(a_block && b_tile)) {
+            matmul_c32_rows_amx(task->a, task->b, task->c, task->i_start, task->i_end,
+                                task->three_m, a_block, b_tile);
+            free(a_block);
+            free(b_tile);
+            return;
+        }
+        free(a_block);
+        free(b_tile);
+    }
+    matmul_c32_rows_portable(task->a, task->b, task->c, task->i_start, task->i_end, task->three_m);
+}
+
+AmxMatrixC32 *amx_matrix_c32_matmul(const AmxMatrixC32 *a, const AmxMatrixC32 *b, AmxComplexAlgo algo) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+    
+    AmxMatrixC32 *c = amx_matrix_c32_zeros(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    const size_t M = a->rows;
+    const size_t m_tiles = (M + AMX_TILE - 1) / AMX_TILE;
+    size_t num_threads = m_tiles < (size_t)num_workers() ? m_tiles : (size_t)num_workers();
+    if (M <= 64) num_threads = 1;
+    
+    const size_t rows_per_thread = ((m_tiles + num_threads - 1) / num_threads) * AMX_TILE;
+    MatmulC32Task tasks[AMX_MAX_THREADS];
+    for (size_t t = 0; t < num_threads; ++t) {
+        size_t start = t * rows_per_thread;
+        size_t end = start + rows_per_thread;
+        if (start > M) start = M;
+        if (end > M) end = M;
+        tasks[t] = (MatmulC32Task){
+            .a = a, .b = b, .c = c,
+            .i_start = start, .i_end = end,
+            .three_m = (algo == AMX_COMPLEX_3M),
+            .use_amx = amx_is_available()
+        };
+    }
+    
+    parallel_for(num_threads, tasks, matmul_c32_task_body);
+    return c;
+}
+
+// ============================================================================
+// Sparse Matrices (CSR)
+// ----------------------------------------------------------------------------
+// Compressed sparse rows with 32-bit column indices. SpMM computes each row
+// of C as a sum of dense B rows scaled by that row's nonzeros: a strip of 64
+// output columns stays in four vector accumulators while the nonzeros stream
+// past, so each C strip is written once and each B row segment is read as
+// whole 16-float vectors. B's zero padding makes C's padding come out zero.
+// Rows are split across tasks by nonzeros plus one per row, so a few dense
+// rows do not serialize the product.
+// ----------------------------------------------------------------------------
+
+#define CSR_STRIP 64                // C columns accumulated per pass over a row
+#define CSR_PARALLEL_MIN (1 << 18)  // Multiply-adds below which one thread is used
+
+struct AmxMatrixCsr {
+    size_t rows;
+    size_t cols;
+    size_t *row_ptr;            // rows + 1 entries; row i is [row_ptr[i], row_ptr[i + 1])
+    uint32_t *col_idx;          // Ascending within a row
+    float *values;
+};
+
+static AmxMatrixCsr *csr_alloc(size_t rows, size_t cols, size_t nnz) {
+    AmxMatrixCsr *m = calloc(1, sizeof(AmxMatrixCsr));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->row_ptr = malloc((rows + 1) * sizeof(size_t));
+    m->col_idx = malloc((nnz ? nnz : 1) * sizeof(uint32_t));
+    m->values = malloc((nnz ? nnz : 1) * sizeof(float));
+    if (UNLIKELY(!m->row_ptr || !m->col_idx || !m->values)) {
+        amx_matrix_csr_free(m);
+        return NULL;
+    }
+    return m;
+}
+
+AmxMatrixCsr *amx_matrix_csr_from_dense(const AmxMatrix *m, float threshold) {
+    if (UNLIKELY(!m || m->cols > UINT32_MAX)) return NULL;
+    
+    size_t nnz = 0;
+    for (size_t i = 0; i < m->rows; ++i) {
+        const float *RESTRICT row = m->data + i * m->stride;
+        for (size_t j = 0; j < m->cols; ++j) nnz += fabsf(row[j]) > threshold;
+    }
+    
+    AmxMatrixCsr *s = csr_alloc(m->rows, m->cols, nnz);
+    if (UNLIKELY(!s)) return NULL;
+    
+    size_t p = 0;
+    for (size_t i = 0; i < m->rows; ++i) {
+        const float *RESTRICT row = m->data + i * m->stride;
+        s->row_ptr[i] = p;
+        for (size_t j = 0; j < m->cols; ++j) {
+            if (fabsf(row[j]) > threshold) {
+                s->col_idx[p] = (uint32_t)j;
+                s->values[p] = row[j];
+                ++p;
+            }
+        }
+    }
+    s->row_ptr[m->rows] = p;
+    return s;
+}
+
+AmxMatrixCsr *amx_matrix_csr_from_data(size_t rows, size_t cols, const size_t *row_ptr,
+                                       const uint32_t *col_idx, const float *values) {
+    if (UNLIKELY(!rows || !cols || !row_ptr || row_ptr[0] != 0)) return NULL;
+    const size_t nnz = row_ptr[rows];
+    if (UNLIKELY(nnz && (!col_idx || !values))) return NULL;
+    
+    // Row pointers must not decrease or pass nnz, columns must ascend within a row
+    for (size_t i = 0; i < rows; ++i) {
+        if (UNLIKELY(row_ptr[i + 1] < row_ptr[i] || row_ptr[i + 1] > nnz)) return NULL;
+        for (size_t p = row_ptr[i]; p < row_ptr[i + 1]; ++p) {
+            if (UNLIKELY(col_idx[p] >= cols || (p > row_ptr[i] && col_idx[p] <= col_idx[p - 1]))) return NULL;
+        }
+    }
+    
+    AmxMatrixCsr *s = csr_alloc(rows, cols, nnz);
+    if (UNLIKELY(!s)) return NULL;
+    
+    memcpy(s->row_ptr, row_ptr, (rows + 1) * sizeof(size_t));
+    if (nnz) {
+        memcpy(s->col_idx, col_idx, nnz * sizeof(uint32_t));
+        memcpy(s->values, values, nnz * sizeof(float));
+    }
+    return s;
+}
+
+AmxMatrix *amx_matrix_csr_to_dense(const AmxMatrixCsr *s) {
+    if (UNLIKELY(!s)) return NULL;
+    
+    AmxMatrix *m = amx_matrix_zeros(s->rows, s->cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    for (size_t i = 0; i < s->rows; ++i) {
+        float *RESTRICT row = m->data + i * m->stride;
+        for (size_t p = s->row_ptr[i]; p < s->row_ptr[i + 1]; ++p) row[s->col_idx[p]] = s->values[p];
+    }
+    return m;
+}
+
+void amx_matrix_csr_free(AmxMatrixCsr *m) {
+    if (m) {
+        free(m->row_ptr);
+        free(m->col_idx);
+        free(m->values);
+        free(m);
+    }
+}
+
+size_t amx_matrix_csr_rows(const AmxMatrixCsr *m) { return m ? m->rows : 0; }
+size_t amx_matrix_csr_cols(const AmxMatrixCsr *m) { return m ? m->cols : 0; }
+size_t amx_matrix_csr_nnz(const AmxMatrixCsr *m) { return m ? m->row_ptr[m->rows] : 0; }
+const size_t *amx_matrix_csr_row_ptr(const AmxMatrixCsr *m) { return m ? m->row_ptr : NULL; }
+const uint32_t *amx_matrix_csr_col_idx(const AmxMatrixCsr *m) { return m ? m->col_idx : NULL; }
+const float *amx_matrix_csr_values(const AmxMatrixCsr *m) { return m ? m->values : NULL; }
+
+typedef struct {
+    const AmxMatrixCsr *a;
+    const float *b;
+    float *c;
+    size_t stride;              // Shared by B and C, which have the same column count
+    size_t tasks;
+} CsrSpmm;
+
+// C rows [i0, i1): every lane of each row is written, padding included
+HOT static void csr_spmm_rows(const CsrSpmm *s, size_t i0, size_t i1) {
+    const size_t *row_ptr = s->a->row_ptr;
+    const uint32_t *RESTRICT col = s->a->col_idx;
+    const float *RESTRICT val = s->a->values;
+    const size_t stride = s->stride;
+    
+    for (size_t i = i0; i < i1; ++i) {
+        const size_t p0 = row_ptr[i], p1 = row_ptr[i + 1];
+        float *c_row = s->c + i * stride;
+        
+        size_t j = 0;
+        for (; j + CSR_STRIP <= stride; j += CSR_STRIP) {
+            v16f acc0 = {0}, acc1 = {0}, acc2 = {0}, acc3 = {0};
+            for (size_t p = p0; p < p1; ++p) {
+                const float *b_row = s->b + (size_t)col[p] * stride + j;
+                if (p + 4 < p1) PREFETCH_R(s->b + (size_t)col[p + 4] * stride + j);
+                const float v = val[p];
+                acc0 += v * EW_VEC(b_row);
+                acc1 += v * EW_VEC(b_row + AMX_TILE);
+                acc2 += v * EW_VEC(b_row + 2 * AMX_TILE);
+                acc3 += v * EW_VEC(b_row + 3 * AMX_TILE);
+            }
+            EW_VEC(c_row + j) = acc0;
+            EW_VEC(c_row + j + AMX_TILE) = acc1;
+            EW_VEC(c_row + j + 2 * AMX_TILE) = acc2;
+            EW_VEC(c_row + j + 3 * AMX_TILE) = acc3;
+        }
+        for (; j < stride; j += AMX_TILE) {
+            v16f acc = {0};
+            for (size_t p = p0; p < p1; ++p) acc += val[p] * EW_VEC(s->b + (size_t)col[p] * stride + j);
+            EW_VEC(c_row + j) = acc;
+        }
+    }
+}
+
+// First row of task t's share when row i costs ptr[i + 1] - ptr[i] + 1
+static size_t csr_split(const size_t *ptr, size_t rows, size_t tasks, size_t t) {
+    const size_t total = ptr[rows] + rows;
+    const size_t target = (size_t)((double)total * t / tasks);
+    size_t lo = 0, hi = rows;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (ptr[mid] + mid < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void csr_spmm_task_body(void *ctx, size_t t) {
+    const CsrSpmm *s = (const CsrSpmm *)ctx;
+    const size_t i0 = csr_split(s->a->row_ptr, s->a->rows, s->tasks, t);
+    const size_t i1 = (t + 1 == s->tasks) ? s->a->rows : csr_split(s->a->row_ptr, s->a->rows, s->tasks, t + 1);
+    if (i0 < i1) csr_spmm_rows(s, i0, i1);
+}
+
+AmxMatrix *amx_matrix_csr_matmul(const AmxMatrixCsr *a, const AmxMatrix *b) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+    
+    AmxMatrix *c = matrix_alloc(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    CsrSpmm s = { .a = a, .b = b->data, .c = c->data, .stride = c->stride, .tasks = 1 };
+    const size_t workers = (size_t)num_workers();
+    const double work = (double)(a->row_ptr[a->rows] + a->rows) * c->stride;
+    if (workers > 1 && a->rows > 1 && work >= CSR_PARALLEL_MIN) {
+        s.tasks = 2 * workers < a->rows ? 2 * workers : a->rows;
+    }
+    
+    if (s.tasks == 1) csr_spmm_rows(&s, 0, a->rows);
+    else parallel_for(s.tasks, &s, csr_spmm_task_body);
+    return c;
+}
+
+// ============================================================================
+// Block-Sparse Matrices (16x16 tiles)
+// ----------------------------------------------------------------------------
+// Structured-pruned weights are zero in whole AMX_TILE x AMX_TILE blocks. A
+// bitmap marks the nonzero tiles of each tile row and those tiles are stored
+// back to back, already in the column-major 16-row panel layout the
+// microkernels read, so the product never packs A and never visits a zero
+// tile: each C tile accumulates one 16-deep step per set bit, straight from
+// the stored tile and the matching B rows. C tiles are written whole, which
+// B's zero padding keeps zero in C's padding. Tile rows are split across
+// tasks by stored tiles, as CSR rows are by nonzeros.
+// ----------------------------------------------------------------------------
+
+#define BSR_TILE_FLOATS (AMX_TILE * AMX_TILE)
+#define BSR_MB (SGEMM_MC / AMX_TILE)     // Tile rows per cache block
+#define BSR_KB (SGEMM_KC / AMX_TILE)     // Tile columns per K block; divides 64
+
+struct AmxMatrixBsr {
+    size_t rows;
+    size_t cols;
+    size_t tile_rows;           // ceil(rows / 16)
+    size_t tile_cols;           // ceil(cols / 16)
+    size_t words;               // Bitmap words per tile row
+    uint64_t *bitmap;           // Bit bj of tile row bi set when that tile is stored
+    size_t *tile_ptr;           // tile_rows + 1 entries; tile row bi is [tile_ptr[bi], tile_ptr[bi + 1])
+    float *tiles;               // tile[k * 16 + r] = A[16 bi + r][16 bj + k], zero-padded at the edges
+};
+
+static AmxMatrixBsr *bsr_alloc(size_t rows, size_t cols, size_t tiles) {
+    AmxMatrixBsr *m = calloc(1, sizeof(AmxMatrixBsr));
+    if (UNLIKELY(!m)) return NULL;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->tile_rows = (rows + AMX_TILE - 1) / AMX_TILE;
+    m->tile_cols = (cols + AMX_TILE - 1) / AMX_TILE;
+    m->words = (m->tile_cols + 63) / 64;
+    m->bitmap = calloc(m->tile_rows * m->words, sizeof(uint64_t));
+    m->tile_ptr = malloc((m->tile_rows + 1) * sizeof(size_t));
+    m->tiles = alloc_aligned((tiles ? tiles : 1) * BSR_TILE_FLOATS * sizeof(float));
+    if (UNLIKELY(!m->bitmap || !m->tile_ptr || !m->tiles)) {
+        amx_matrix_bsr_free(m);
+        return NULL;
+    }
+    return m;
+}
+
+static bool bsr_tile_nonzero(const AmxMatrix *m, size_t i0, size_t j0, float threshold) {
+    const size_t i1 = (i0 + AMX_TILE <= m->rows) ? i0 + AMX_TILE : m->rows;
+    const size_t j1 = (j0 + AMX_TILE <= m->cols) ? j0 + AMX_TILE : m->cols;
+    for (size_t i = i0; i < i1; ++i) {
+        const float *RESTRICT row = m->data + i * m->stride;
+        for (size_t j = j0; j < j1; ++j) {
+            if (fabsf(row[j]) > threshold) return true;
+        }
+    }
+    return false;
+}
+
+AmxMatrixBsr *amx_matrix_bsr_from_dense(const AmxMatrix *m, float threshold) {
+    if (UNLIKELY(!m)) return NULL;
+    
+    const size_t tile_rows = (m->rows + AMX_TILE - 1) / AMX_TILE;
+    const size_t tile_cols = (m->cols + AMX_TILE - 1) / AMX_TILE;
+    size_t count = 0;
+    for (size_t bi = 0; bi < tile_rows; ++bi) {
+        for (size_t bj = 0; bj < tile_cols; ++bj) count += bsr_tile_nonzero(m, bi * AMX_TILE, bj * AMX_TILE, threshold);
+    }
+    
+    AmxMatrixBsr *s = bsr_alloc(m->rows, m->cols, count);
+    if (UNLIKELY(!s)) return NULL;
+    
+    size_t p = 0;
+    for (size_t bi = 0; bi < tile_rows; ++bi) {
+        const size_t i0 = bi * AMX_TILE;
+        const size_t mr = (i0 + AMX_TILE <= m->rows) ? AMX_TILE : m->rows - i0;
+        s->tile_ptr[bi] = p;
+        for (size_t bj = 0; bj < tile_cols; ++bj) {
+            const size_t j0 = bj * AMX_TILE;
+            if (!bsr_tile_nonzero(m, i0, j0, threshold)) continue;
+            
+            // Whole tiles are kept, entries under the threshold included
+            const size_t kc = (j0 + AMX_TILE <= m->cols) ? AMX_TILE : m->cols - j0;
+            float *RESTRICT tile = s->tiles + p * BSR_TILE_FLOATS;
+            memset(tile, 0, BSR_TILE_FLOATS * sizeof(float));
+            for (size_t r = 0; r < mr; ++r) {
+                const float *RESTRICT row = m->data + (i0 + r) * m->stride + j0;
+                for (size_t k = 0; k < kc; ++k) tile[k * AMX_TILE + r] = row[k];
+            }
+            s->bitmap[bi * s->words + bj / 64] |= (uint64_t)1 << (bj % 64);
+            ++p;
+        }
+    }
+    s->tile_ptr[tile_rows] = p;
+    return s;
+}
+
+AmxMatrix *amx_matrix_bsr_to_dense(const AmxMatrixBsr *s) {
+    if (UNLIKELY(!s)) return NULL;
+    
+    AmxMatrix *m = amx_matrix_zeros(s->rows, s->cols);
+    if (UNLIKELY(!m)) return NULL;
+    
+    const float *RESTRICT tile = s->tiles;
+    for (size_t bi = 0; bi < s->tile_rows; ++bi) {
+        const size_t i0 = bi * AMX_TILE;
+        const size_t mr = (i0 + AMX_TILE <= s->rows) ? AMX_TILE : s->rows - i0;
+        for (size_t w = 0; w < s->words; ++w) {
+            for (uint64_t bits = s->bitmap[bi * s->words + w]; bits; bits &= bits - 1) {
+                const size_t j0 = (w * 64 + (size_t)__builtin_ctzll(bits)) * AMX_TILE;
+                const size_t kc = (j0 + AMX_TILE <= s->cols) ? AMX_TILE : s->cols - j0;
+                for (size_t r = 0; r < mr; ++r) {
+                    float *RESTRICT row = m->data + (i0 + r) * m->stride + j0;
+                    for (size_t k = 0; k < kc; ++k) row[k] = tile[k * AMX_TILE + r];
+                }
+                tile += BSR_TILE_FLOATS;
+            }
+        }
+    }
+    return m;
+}
+
+void amx_matrix_bsr_free(AmxMatrixBsr *m) {
+    if (m) {
+        free(m->bitmap);
+        free(m->tile_ptr);
+        free(m->tiles);
+        free(m);
+    }
+}
+
+size_t amx_matrix_bsr_rows(const AmxMatrixBsr *m) { return m ? m->rows : 0; }
+size_t amx_matrix_bsr_cols(const AmxMatrixBsr *m) { return m ? m->cols : 0; }
+size_t amx_matrix_bsr_tiles(const AmxMatrixBsr *m) { return m ? m->tile_ptr[m->tile_rows] : 0; }
+
+bool amx_matrix_bsr_has_tile(const AmxMatrixBsr *m, size_t bi, size_t bj) {
+    if (UNLIKELY(!m || bi >= m->tile_rows || bj >= m->tile_cols)) return false;
+    return (m->bitmap[bi * m->words + bj / 64] >> (bj % 64)) & 1;
+}
+
+// acc += rows [0, 4) of a stored tile times kc rows of B; a constant kc unrolls
+ALWAYS_INLINE static void bsr_tile_step(
+    float acc[4][AMX_TILE], const float *RESTRICT a, const float *RESTRICT b, size_t ldb, size_t kc
+) {
+    for (size_t k = 0; k < kc; ++k) {
+        for (size_t r = 0; r < 4; ++r) {
+            for (size_t t = 0; t < AMX_TILE; ++t) acc[r][t] += a[k * AMX_TILE + r] * b[k * ldb + t];
+        }
+    }
+}
+
+// One C tile from one tile row and one K block: C (mr x 16) = [C +] the sum
+// over the set bits bj of mask of tile * B rows [k0 + 16 bj, +kc). The stored
+// tiles are 16-row panels, so the portable path keeps the dense kernel's
+// loop shape; the last tile column is only kc deep.
+ALWAYS_INLINE static void bsr_tile_generic(
+    const float *RESTRICT tiles, uint32_t mask, size_t k0, size_t K,
+    const float *RESTRICT B, size_t ldb,
+    float *RESTRICT C, size_t ldc, size_t mr, bool load_c
+) {
+    for (size_t r0 = 0; r0 < mr; r0 += 4) {
+        float acc[4][AMX_TILE] ALIGNED(64) = {{0}};
+        const float *RESTRICT tile = tiles;
+        for (uint32_t bits = mask; bits; bits &= bits - 1) {
+            const size_t kb = k0 + (size_t)__builtin_ctz(bits) * AMX_TILE;
+            if (LIKELY(kb + AMX_TILE <= K)) {
+                bsr_tile_step(acc, tile + r0, B + kb * ldb, ldb, AMX_TILE);
+            } else {
+                bsr_tile_step(acc, tile + r0, B + kb * ldb, ldb, K - kb);
+            }
+            tile += BSR_TILE_FLOATS;
+        }
+        
+        const size_t rows = (r0 + 4 <= mr) ? 4 : mr - r0;
+        for (size_t r = 0; r < rows; ++r) {
+            float *RESTRICT c_row = C + (r0 + r) * ldc;
+            if (load_c) {
+                for (size_t t = 0; t < AMX_TILE; ++t) c_row[t] += acc[r][t];
+            } else {
+                for (size_t t = 0; t < AMX_TILE; ++t) c_row[t] = acc[r][t];
+            }
+        }
+    }
+}
+
+static void bsr_tile_portable(
+    const float *RESTRICT tiles, uint32_t mask, size_t k0, size_t K, const float *RESTRICT B, size_t ldb,
+    float *RESTRICT C, size_t ldc, size_t mr, bool load_c
+) {
+    bsr_tile_generic(tiles, mask, k0, K, B, ldb, C, ldc, mr, load_c);
+}
+
+#if AMX_X86
+__attribute__((target("avx2,fma")))
+static void bsr_tile_avx2(
+    const float *RESTRICT tiles, uint32_t mask, size_t k0, size_t K, const float *RESTRICT B, size_t ldb,
+    float *RESTRICT C, size_t ldc, size_t mr, bool load_c
+) {
+    bsr_tile_generic(tiles, mask, k0, K, B, ldb, C, ldc, mr, load_c);
+}
+#endif
+
+// The stored tiles feed the accumulators directly, one 16-deep step per set bit
+HOT static void bsr_tile_amx(
+    const float *RESTRICT tiles, uint32_t mask, size_t k0, size_t K, const float *RESTRICT B, size_t ldb,
+    float *RESTRICT C, size_t ldc, size_t mr, bool load_c
+) {
+    AMX_ZERO_Z();
+    if (load_c) {
+        for (size_t r = 0; r < mr; ++r) AMX_LDZ(C + r * ldc, r * 4);
+    }
+    
+    const float *RESTRICT tile = tiles;
+    for (uint32_t bits = mask; bits; bits &= bits - 1) {
+        const size_t kb = k0 + (size_t)__builtin_ctz(bits) * AMX_TILE;
+        const size_t kc = (kb + AMX_TILE <= K) ? AMX_TILE : K - kb;
+        microkernel_accumulate(tile, B + kb * ldb, kc, ldb);
+        tile += BSR_TILE_FLOATS;
+    }
+    
+    for (size_t r = 0; r < mr; ++r) AMX_STZ(C + r * ldc, r * 4);
+}
+
+typedef void (*BsrTileKernel)(const float *tiles, uint32_t mask, size_t k0, size_t K,
+                              const float *B, size_t ldb, float *C, size_t ldc, size_t mr, bool load_c);
+
+static BsrTileKernel bsr_tile_kernel(bool use_amx) {
+    if (use_amx) return bsr_tile_amx;
+#if AMX_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return bsr_tile_avx2;
+#endif
+    return bsr_tile_portable;
+}
+
+typedef struct {
+    const AmxMatrixBsr *a;
+    const float *b;
+    float *c;
+    size_t stride;              // Shared by B and C, which have the same column count
+    size_t tasks;
+    bool use_amx;
+} BsrSpmm;
+
+// C rows of tile rows [b0, b1), padding included. Blocked like the dense
+// driver: BSR_MB tile rows by BSR_KB tile columns of A stay cache resident
+// while each 16-column strip of the matching B rows is reused across them.
+HOT static void bsr_spmm_rows(const BsrSpmm *s, size_t b0, size_t b1) {
+    const AmxMatrixBsr *a = s->a;
+    const BsrTileKernel kernel = bsr_tile_kernel(s->use_amx);
+    const float *next[BSR_MB];
+    uint32_t masks[BSR_MB];
+    
+    if (s->use_amx) AMX_SET();
+    
+    for (size_t bm = b0; bm < b1; bm += BSR_MB) {
+        const size_t mb = (bm + BSR_MB <= b1) ? BSR_MB : b1 - bm;
+        for (size_t r = 0; r < mb; ++r) next[r] = a->tiles + a->tile_ptr[bm + r] * BSR_TILE_FLOATS;
+        
+        for (size_t kb = 0; kb < a->tile_cols; kb += BSR_KB) {
+            bool any = false;
+            for (size_t r = 0; r < mb; ++r) {
+                masks[r] = (uint32_t)(a->bitmap[(bm + r) * a->words + kb / 64] >> (kb % 64)) & ((1u << BSR_KB) - 1);
+                any |= masks[r] != 0;
+            }
+            
+            // The first K block writes C, later ones accumulate; empty blocks are skipped
+            const bool load_c = kb > 0;
+            if (any || !load_c) {
+                for (size_t j = 0; j < s->stride; j += AMX_TILE) {
+                    for (size_t r = 0; r < mb; ++r) {
+                        if (!masks[r] && load_c) continue;
+                        const size_t i0 = (bm + r) * AMX_TILE;
+                        const size_t mr = (i0 + AMX_TILE <= a->rows) ? AMX_TILE : a->rows - i0;
+                        kernel(next[r], masks[r], kb * AMX_TILE, a->cols, s->b + j, s->stride,
+                               s->c + i0 * s->stride + j, s->stride, mr, load_c);
+                    }
+                }
+            }
+            for (size_t r = 0; r < mb; ++r) next[r] += (size_t)__builtin_popcount(masks[r]) * BSR_TILE_FLOATS;
+        }
+    }
+    
+    if (s->use_amx) AMX_CLR();
+}
+
+static void bsr_spmm_task_body(void *ctx, size_t t) {
+    const BsrSpmm *s = (const BsrSpmm *)ctx;
+    const size_t rows = s->a->tile_rows;
+    const size_t b0 = csr_split(s->a->tile_ptr, rows, s->tasks, t);
+    const size_t b1 = (t + 1 == s->tasks) ? rows : csr_split(s->a->tile_ptr, rows, s->tasks, t + 1);
+    if (b0 < b1) bsr_spmm_rows(s, b0, b1);
+}
+
+AmxMatrix *amx_matrix_bsr_matmul(const AmxMatrixBsr *a, const AmxMatrix *b) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+    
+    AmxMatrix *c = matrix_alloc(a->rows, b->cols);
+    if (UNLIKELY(!c)) return NULL;
+    
+    BsrSpmm s = {
+        .a = a, .b = b->data, .c = c->data, .stride = c->stride, .tasks = 1,
+        .use_amx = amx_is_available()
+    };
+    const size_t workers = (size_t)num_workers();
+    const double work = (double)a->tile_ptr[a->tile_rows] * BSR_TILE_FLOATS * c->stride;
+    if (workers > 1 && a->tile_rows > 1 && work >= 64.0 * 64.0 * 64.0) {
+        s.tasks = 2 * workers < a->tile_rows ? 2 * workers : a->tile_rows;
+    }
+    
+    if (s.tasks == 1) bsr_spmm_rows(&s, 0, a->tile_rows);
+    else parallel_for(s.tasks, &s, bsr_spmm_task_body);
+    return c;
+}
+
+// ============================================================================
+// Strassen-Winograd
+// ----------------------------------------------------------------------------
+// Winograd's form of Strassen's recursion: 7 half-size products and 15
+// quadrant additions per level instead of 8 products. The recursion runs a
+// fixed number of levels over operands zero-padded to a multiple of
+// 16 << levels, so every quadrant at every level is whole tiles, and the
+// leaves are ordinary tiled SGEMMs. Each level uses the schedule of Boyer,
+// Dumas, Pernet and Zhou (ISSAC 2009) that needs only two temporaries, X and
+// Y, with the C quadrants holding the other intermediates; the temporaries of
+// all levels come from one arena allocated up front. Sub-products run one
+// after another, each leaf and each addition spread across the pool.
+// ----------------------------------------------------------------------------
+
+#define STRASSEN_CUTOFF 2048        // Default leaf size
+#define STRASSEN_CUTOFF_MIN 64      // Smaller leaves only add overhead
+
+typedef struct {
+    float *dst;
+    const float *x, *y;
+    size_t ldd, ldx, ldy;
+    size_t rows, cols;          // cols is a multiple of 16
+    float sign;
+    size_t rows_per_task;
+} StrassenAdd;
+
+// dst = x + sign * y over rows [i0, i1); dst may be x or y
+static void strassen_add_rows(const StrassenAdd *s, size_t i0, size_t i1) {
+    for (size_t i = i0; i < i1; ++i) {
+        float *d = s->dst + i * s->ldd;
+        const float *x = s->x + i * s->ldx, *y = s->y + i * s->ldy;
+        for (size_t j = 0; j < s->cols; j += AMX_TILE) EW_VEC(d + j) = EW_VEC(x + j) + s->sign * EW_VEC(y + j);
+    }
+}
+
+static void strassen_add_task_body(void *ctx, size_t t) {
+    const StrassenAdd *s = (const StrassenAdd *)ctx;
+    const size_t i0 = t * s->rows_per_task;
+    const size_t i1 = (i0 + s->rows_per_task <= s->rows) ? i0 + s->rows_per_task : s->rows;
+    if (i0 < i1) strassen_add_rows(s, i0, i1);
+}
+
+static void strassen_add(float *dst, size_t ldd, const float *x, size_t ldx, const float *y, size_t ldy,
+                         size_t rows, size_t cols, float sign) {
+    StrassenAdd s = {
+        .dst = dst, .x = x, .y = y, .ldd = ldd, .ldx = ldx, .ldy = ldy,
+        .rows = rows, .cols = cols, .sign = sign, .rows_per_task = rows
+    };
+    const size_t workers = (size_t)num_workers();
+    if (rows * cols < EW_PARALLEL_MIN || workers == 1 || rows == 1) {
+        strassen_add_rows(&s, 0, rows);
+        return;
+    }
+    
+    s.rows_per_task = (rows + workers - 1) / workers;
+    parallel_for((rows + s.rows_per_task - 1) / s.rows_per_task, &s, strassen_add_task_body);
+}
+
+// Floats of X and Y for one level with m x k and k x n operands
+static size_t strassen_level_floats(size_t m, size_t n, size_t k) {
+    const size_t mh = m / 2, nh = n / 2, kh = k / 2;
+    return mh * (kh > nh ? kh : nh) + kh * nh;
+}
+
+// C = A * B with m, n, k multiples of 16 << levels; ws holds every deeper level's X and Y
+static void strassen_rec(const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc,
+                         size_t m, size_t n, size_t k, unsigned levels, float *ws) {
+    if (levels == 0) {
+        const Sgemm g = {
+            .A = A, .lda = lda, .B = B, .ldb = ldb, .C = C, .ldc = ldc,
+            .M = m, .N = n, .K = k, .alpha = 1.0f, .beta = 0.0f
+        };
+        sgemm_run(&g);
+        return;
+    }
+    
+    const size_t mh = m / 2, nh = n / 2, kh = k / 2;
+    const float *A11 = A, *A12 = A + kh, *A21 = A + mh * lda, *A22 = A21 + kh;
+    const float *B11 = B, *B12 = B + nh, *B21 = B + kh * ldb, *B22 = B21 + nh;
+    float *C11 = C, *C12 = C + nh, *C21 = C + mh * ldc, *C22 = C21 + nh;
+    float *X = ws;                              // mh x kh, later mh x nh
+    float *Y = X + mh * (kh > nh ? kh : nh);    // kh x nh
+    float *next = Y + kh * nh;
+    const unsigned sub = levels - 1;
+    
+    strassen_add(X, kh, A11, lda, A21, lda, mh, kh, -1.0f);         // S3 = A11 - A21
+    strassen_add(Y, nh, B22, ldb, B12, ldb, kh, nh, -1.0f);         // T3 = B22 - B12
+    strassen_rec(X, kh, Y, nh, C21, ldc, mh, nh, kh, sub, next);    // P7 = S3 T3
+    strassen_add(X, kh, A21, lda, A22, lda, mh, kh, 1.0f);          // S1 = A21 + A22
+    strassen_add(Y, nh, B12, ldb, B11, ldb, kh, nh, -1.0f);         // T1 = B12 - B11
+    strassen_rec(X, kh, Y, nh, C22, ldc, mh, nh, kh, sub, next);    // P5 = S1 T1
+    strassen_add(X, kh, X, kh, A11, lda, mh, kh, -1.0f);            // S2 = S1 - A11
+    strassen_add(Y, nh, B22, ldb, Y, nh, kh, nh, -1.0f);            // T2 = B22 - T1
+    strassen_rec(X, kh, Y, nh, C12, ldc, mh, nh, kh, sub, next);    // P6 = S2 T2
+    strassen_add(X, kh, A12, lda, X, kh, mh, kh, -1.0f);            // S4 = A12 - S2
+    strassen_rec(X, kh, B22, ldb, C11, ldc, mh, nh, kh, sub, next); // P3 = S4 B22
+    strassen_rec(A11, lda, B11, ldb, X, nh, mh, nh, kh, sub, next); // P1 = A11 B11
+    strassen_add(C12, ldc, X, nh, C12, ldc, mh, nh, 1.0f);          // U2 = P1 + P6
+    strassen_add(C21, ldc, C12, ldc, C21, ldc, mh, nh, 1.0f);       // U3 = U2 + P7
+    strassen_add(C12, ldc, C12, ldc, C22, ldc, mh, nh, 1.0f);       // U4 = U2 + P5
+    strassen_add(C22, ldc, C21, ldc, C22, ldc, mh, nh, 1.0f);       // U7 = U3 + P5 = C22
+    strassen_add(C12, ldc, C12, ldc, C11, ldc, mh, nh, 1.0f);       // U5 = U4 + P3 = C12
+    strassen_add(Y, nh, Y, nh, B21, ldb, kh, nh, -1.0f);            // T4 = T2 - B21
+    strassen_rec(A22, lda, Y, nh, C11, ldc, mh, nh, kh, sub, next); // P4 = A22 T4
+    strassen_add(C21, ldc, C21, ldc, C11, ldc, mh, nh, -1.0f);      // U6 = U3 - P4 = C21
+    strassen_rec(A12, lda, B21, ldb, C11, ldc, mh, nh, kh, sub, next); // P2 = A12 B21
+    strassen_add(C11, ldc, X, nh, C11, ldc, mh, nh, 1.0f);          // U1 = P1 + P2 = C11
+}
+
+// rows x cols of m into a zeroed rows_p x cols_p buffer, or m's own data when no padding is needed
+static const float *strassen_operand(const AmxMatrix *m, size_t rows_p, size_t cols_p, float **owned) {
+    *owned = NULL;
+    if (m->rows == rows_p && m->stride == cols_p) return m->data;
+    
+    float *p = alloc_aligned(rows_p * cols_p * sizeof(float));
+    if (UNLIKELY(!p)) return NULL;
+    for (size_t i = 0; i < m->rows; ++i) {
+        memcpy(p + i * cols_p, m->data + i * m->stride, m->stride * sizeof(float));
+        memset(p + i * cols_p + m->stride, 0, (cols_p - m->stride) * sizeof(float));
+    }
+    memset(p + m->rows * cols_p, 0, (rows_p - m->rows) * cols_p * sizeof(float));
+    *owned = p;
+    return p;
+}
+
+AmxMatrix *amx_matrix_matmul_algo(const AmxMatrix *a, const AmxMatrix *b, AmxMatmulAlgo algo, size_t cutoff) {
+    if (UNLIKELY(!a || !b || a->cols != b->rows)) return NULL;
+    if (algo != AMX_MATMUL_STRASSEN) return amx_matrix_matmul(a, b);
+    
+    // Halve until the smallest dimension is within the cutoff
+    if (cutoff == 0) cutoff = STRASSEN_CUTOFF;
+    if (cutoff < STRASSEN_CUTOFF_MIN) cutoff = STRASSEN_CUTOFF_MIN;
+    const size_t m = a->rows, n = b->cols, k = a->cols;
+    size_t d = m < n ? m : n;
+    if (k < d) d = k;
+    unsigned levels = 0;
+    for (; d > cutoff; d = (d + 1) / 2) ++levels;
+    if (levels == 0) return amx_matrix_matmul(a, b);
+    
+    const size_t unit = (size_t)AMX_TILE << levels;
+    const size_t mp = round_up(m, unit), np = round_up(n, unit), kp = round_up(k, unit);
+    size_t ws_floats = 0;
+    for (unsigned l = 0; l < levels; ++l) ws_floats += strassen_level_floats(mp >> l, np >> l, kp >> l);
+    
+    AmxMatrix *c = matrix_alloc(m, n);
+    if (UNLIKELY(!c)) return NULL;
+    
+    float *a_owned, *b_owned, *c_owned = NULL;
+    const float *ap = strassen_operand(a, mp, kp, &a_owned);
+    const float *bp = strassen_operand(b, kp, np, &b_owned);
+    float *cp = c->data;
+    if (m != mp || c->stride != np) cp = c_owned = alloc_aligned(mp * np * sizeof(float));
+    float *ws = alloc_aligned(ws_floats * sizeof(float));
+    
+    if (LIKELY(ap && bp && cp && ws)) {
+        strassen_rec(ap, kp, bp, np, cp, np, mp, np, kp, levels, ws);
+        
+        // Padded columns of C cancel only up to rounding, so C's padding is
+        // cleared on both paths, including when C was computed in place
+        for (size_t i = 0; i < m; ++i) {
+            if (c_owned) memcpy(c->data + i * c->stride, c_owned + i * np, n * sizeof(float));
+            if (c->stride != n) memset(c->data + i * c->stride + n, 0, (c->stride - n) * sizeof(float));
+        }
+    } else {
+        // Not enough memory for the padded operands or workspace
+        const Sgemm g = {
+            .A = a->data, .lda = a->stride, .B = b->data, .ldb = b->stride, .C = c->data, .ldc = c->stride,
+            .M = m, .N = n, .K = k, .alpha = 1.0f, .beta = 0.0f
+        };
+        sgemm_run(&g);
+        if (c->stride != n) {
+            for (size_t i = 0; i < m; ++i) memset(c->data + i * c->stride + n, 0, (c->stride - n) * sizeof(float));
+        }
+    }
+    
+    free(a_owned);
+    free(b_owned);
+    free(c_owned);
+    free(ws);
+    return c;
+}
+
+// ============================================================================
+// Matrix Chains
+// ----------------------------------------------------------------------------
+// The classic O(n^3) dynamic program picks the parenthesization with the
+// least cost, where a product's cost is its multiply-adds plus a weight per
+// float of operand and result traffic, so chains of thin products are not
+// judged by flops alone. The plan then runs depth first. Intermediates come
+// from a small workspace that takes each buffer back once its product has
+// been consumed; a later product reuses the smallest free buffer that is
+// large enough, reshaped in place.
+// ----------------------------------------------------------------------------
+
+#define CHAIN_MEM_WEIGHT 8.0    // Multiply-adds costing about as much as moving one float
+#define CHAIN_POOL 8
+
+typedef struct {
+    AmxMatrix *buf[CHAIN_POOL];
+    size_t cap[CHAIN_POOL];     // Floats of buf[i]->data
+    size_t n;
+} ChainWork;
+
+typedef struct {
+    const AmxMatrix *const *mats;
+    const size_t *split;        // split[i * count + j]: last factor of the left operand of i..j
+    size_t count;
+    ChainWork work;
+} Chain;
+
+// Smallest free buffer holding rows x cols, reshaped, or a new one; *cap gets its capacity
+static AmxMatrix *chain_take(ChainWork *w, size_t rows, size_t cols, size_t *cap) {
+    const size_t need = rows * round_up(cols, AMX_TILE);
+    size_t best = w->n;
+    for (size_t i = 0; i < w->n; ++i) {
+        if (w->cap[i] >= need && (best == w->n || w->cap[i] < w->cap[best])) best = i;
+    }
+    if (best == w->n) {
+        *cap = need;
+        return matrix_alloc(rows, cols);
+    }
+    
+    AmxMatrix *m = w->buf[best];
+    *cap = w->cap[best];
+    --w->n;
+    w->buf[best] = w->buf[w->n];
+    w->cap[best] = w->cap[w->n];
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = round_up(cols, AMX_TILE);
+    return m;
+}
+
+// When the workspace is full the smallest buffer is dropped
+static void chain_put(ChainWork *w, AmxMatrix *m, size_t cap) {
+    if (w->n == CHAIN_POOL) {
+        size_t small = 0;
+        for (size_t i = 1; i < w->n; ++i) {
+            if (w->cap[i] < w->cap[small]) small = i;
+        }
+        if (w->cap[small] >= cap) {
+            amx_matrix_free(m);
+            return;
+        }
+        amx_matrix_free(w->buf[small]);
+        w->buf[small] = m;
+        w->cap[small] = cap;
+        return;
+    }
+    w->buf[w->n] = m;
+    w->cap[w->n] = cap;
+    ++w->n;
+}
+
+// Product of factors i..j. *cap is the capacity of a workspace result, 0 for an input.
+static AmxMatrix *chain_eval(Chain *c, size_t i, size_t j, size_t *cap) {
+    *cap = 0;
+    if (i == j) return (AmxMatrix *)c->mats[i];
+    
+    const size_t s = c->split[i * c->count + j];
+    size_t cap_a = 0, cap_b = 0;
+    AmxMatrix *a = chain_eval(c, i, s, &cap_a);
+    AmxMatrix *b = a ? chain_eval(c, s + 1, j, &cap_b) : NULL;
+    AmxMatrix *out = b ? chain_take(&c->work, a->rows, b->cols, cap) : NULL;
+    
+    if (LIKELY(out)) {
+        const Sgemm g = {
+            .A = a->data, .lda = a->stride, .B = b->data, .ldb = b->stride,
+            .C = out->data, .ldc = out->stride,
+            .M = a->rows, .N = b->cols, .K = a->cols, .alpha = 1.0f, .beta = 0.0f
+        };
+        sgemm_run(&g);
+        
+        // GEMM leaves the padding alone and reused buffers hold stale data there
+        if (out->stride != out->cols) {
+            for (size_t r = 0; r < out->rows; ++r) {
+                memset(out->data + r * out->stride + out->cols, 0, (out->stride - out->cols) * sizeof(float));
+            }
+        }
+    } else {
+        *cap = 0;
+    }
+    
+    if (cap_a) chain_put(&c->work, a, cap_a);
+    if (cap_b) chain_put(&c->work, b, cap_b);
+    return out;
+}
+
+AmxMatrix *amx_matrix_chain_multiply(const AmxMatrix *const *mats, size_t count) {
+    if (UNLIKELY(!mats || count == 0)) return NULL;
+    for (size_t t = 0; t < count; ++t) {
+        if (UNLIKELY(!mats[t] || (t > 0 && mats[t - 1]->cols != mats[t]->rows))) return NULL;
+    }
+    if (count == 1) return amx_matrix_clone(mats[0]);
+    
+    // Factor t is dims[t] x dims[t + 1]
+    double *cost = malloc(count * count * sizeof(double));
+    size_t *split = malloc(count * count * sizeof(size_t));
+    size_t *dims = malloc((count + 1) * sizeof(size_t));
+    if (UNLIKELY(!cost || !split || !dims)) {
+        free(cost);
+        free(split);
+        free(dims);
+        return NULL;
+    }
+    for (size_t t = 0; t < count; ++t) dims[t] = mats[t]->rows;
+    dims[count] = mats[count - 1]->cols;
+    
+    for (size_t i = 0; i < count; ++i) cost[i * count + i] = 0.0;
+    for (size_t len = 2; len <= count; ++len) {
+        for (size_t i = 0; i + len <= count; ++i) {
+            const size_t j = i + len - 1;
+            const double m = (double)dims[i], n = (double)dims[j + 1];
+            double best = INFINITY;
+            size_t best_s = i;
+            for (size_t s = i; s < j; ++s) {
+                const double k = (double)dims[s + 1];
+                const double c = cost[i * count + s] + cost[(s + 1) * count + j]
+                               + m * k * n + CHAIN_MEM_WEIGHT * (m * k + k * n + m * n);
+                if (c < best) {
+                    best = c;
+                    best_s = s;
+                }
+            }
+            cost[i * count + j] = best;
+            split[i * count + j] = best_s;
+        }
+    }
+    
+    Chain c = { .mats = mats, .split = split, .count = count };
+    size_t cap;
+    AmxMatrix *result = chain_eval(&c, 0, count - 1, &cap);
+    
+    for (size_t p = 0; p < c.work.n; ++p) amx_matrix_free(c.work.buf[p]);
+    free(cost);
+    free(split);
+    free(dims);
+    return result;
+}
+
+// ============================================================================
+// Pairwise Distances and k-Nearest Neighbors
+// ----------------------------------------------------------------------------
+// Every metric is a function of the Gram product X * Y^T, which the tiled
+// GEMM computes with Y as its transposed B operand. L2 folds -2 into alpha
+// and adds the squared norms in the epilogue; cosine scales by the inverse
+// norms there. For k-NN the product is produced one KNN_MB x KNN_NB block
+// at a time into a cache-sized scratch, and the epilogue pushes each
+// finished tile straight into per-row bounded max-heaps, so the m x n
+// distance matrix never exists. Heaps are keyed so that smaller is nearer
+// (similarities are negated) and live in the caller's output rows; most
+// candidates are rejected by one compare against the heap root. With fewer
+// query blocks than workers the database is split too, into parts with
+// private heaps that are merged at the end.
+// ----------------------------------------------------------------------------
+
+#define KNN_MB 64                   // Query rows per task
+#define KNN_NB 512                  // Database rows per GEMM
+
+typedef struct {
+    AmxMetric metric;
+    const float *x_norm;            // Squared norms for L2, inverse norms for cosine
+    const float *y_norm;
+} Dist;
+
+// Squared norms, or inverse norms with 0 for a zero row
+static float *dist_norms(const AmxMatrix *m, AmxMetric metric) {
+    float *norm = malloc(m->rows * sizeof(float));
+    if (UNLIKELY(!norm)) return NULL;
+    
+    for (size_t i = 0; i < m->rows; ++i) {
+        const float *RESTRICT row = m->data + i * m->stride;
+        float s = 0.0f;
+        for (size_t j = 0; j < m->cols; ++j) s += row[j] * row[j];
+        norm[i] = metric == AMX_METRIC_L2 ? s : (s > 0.0f ? 1.0f / sqrtf(s) : 0.0f);
+    }
+    return norm;
+}
+
+// Gram value of query i and database row j to the metric's value
+ALWAYS_INLINE static float dist_value(const Dist *d, size_t i, size_t j, float g) {
+    switch (d->metric) {
+    case AMX_METRIC_L2: {
+        const float v = d->x_norm[i] + d->y_norm[j] + g;     // g carries the -2 of alpha
+        return v > 0.0f ? v : 0.0f;
+    }
+    case AMX_METRIC_COSINE:
+        return g * d->x_norm[i] * d->y_norm[j];
+    default:
+        return g;
+    }
+}
+
+typedef struct {
+    Dist dist;
+    float *c;
+    size_t ldc;
+} DistFull;
+
+static void dist_full_epilogue(const void *ctx, size_t i0, size_t i1, size_t j0, size_t j1) {
+    const DistFull *f = (const DistFull *)ctx;
+    if (f->dist.metric == AMX_METRIC_INNER_PRODUCT) return;
+    for (size_t i = i0; i < i1; ++i) {
+        float *RESTRICT row = f->c + i * f->ldc;
+        for (size_t j = j0; j < j1; ++j) row[j] = dist_value(&f->dist, i, j, row[j]);
+    }
+}
+
+AmxMatrix *amx_matrix_pairwise(const AmxMatrix *x, const AmxMatrix *y, AmxMetric metric) {
+    if (UNLIKELY(!x || !y || x->cols != y->cols)) return NULL;
+    
+    AmxMatrix *c = amx_matrix_zeros(x->rows, y->rows);
+    float *x_norm = NULL, *y_norm = NULL;
+    if (metric != AMX_METRIC_INNER_PRODUCT) {
+        x_norm = dist_norms(x, metric);
+        y_norm = dist_norms(y, metric);
+    }
+    if (UNLIKELY(!c || (metric != AMX_METRIC_INNER_PRODUCT && (!x_norm || !y_norm)))) {
+        amx_matrix_free(c);
+        free(x_norm);
+        free(y_norm);
+        return NULL;
+    }
+    
+    const DistFull f = {
+        .dist = { .metric = metric, .x_norm = x_norm, .y_norm = y_norm },
+        .c = c->data, .ldc = c->stride
+    };
+    const Sgemm g = {
+        .A = x->data, .lda = x->stride, .B = y->data, .ldb = y->stride, .trans_b = true,
+        .C = c->data, .ldc = c->stride, .M = x->rows, .N = y->rows, .K = x->cols,
+        .alpha = metric == AMX_METRIC_L2 ? -2.0f : 1.0f, .beta = 0.0f,
+        .epilogue = dist_full_epilogue, .epilogue_ctx = &f
+    };
+    sgemm_run(&g);
+    
+    free(x_norm);
+    free(y_norm);
+    return c;
+}
+
+// Bounded max-heap of the k smallest keys seen; key[0] is the worst kept
+static void knn_push(float *RESTRICT key, uint32_t *RESTRICT idx, size_t *count, size_t k, float v, uint32_t id) {
+    size_t pos;
+    if (*count < k) {
+        // Sift up from the new leaf
+        pos = (*count)++;
+        while (pos > 0) {
+            const size_t parent = (pos - 1) / 2;
+            if (key[parent] >= v) break;
+            key[pos] = key[parent];
+            idx[pos] = idx[parent];
+            pos = parent;
+        }
+    } else {
+        if (!(v < key[0])) return;
+        // Replace the root and sift down
+        pos = 0;
+        for (;;) {
+            size_t child = 2 * pos + 1;
+            if (child >= k) break;
+            if (child + 1 < k && key[child + 1] > key[child]) ++child;
+            if (key[child] <= v) break;
+            key[pos] = key[child];
+            idx[pos] = idx[child];
+            pos = child;
+        }
+    }
+    key[pos] = v;
+    idx[pos] = id;
+}
+
+// Heap to ascending order in place
+static void knn_sort(float *RESTRICT key, uint32_t *RESTRICT idx, size_t count) {
+    while (count > 1) {
+        const float v = key[count - 1];
+        const uint32_t id = idx[count - 1];
+        key[count - 1] = key[0];
+        idx[count - 1] = idx[0];
+        --count;
+        
+        size_t pos = 0;
+        for (;;) {
+            size_t child = 2 * pos + 1;
+            if (child >= count) break;
+            if (child + 1 < count && key[child + 1] > key[child]) ++child;
+            if (key[child] <= v) break;
+            key[pos] = key[child];
+            idx[pos] = idx[child];
+            pos = child;
+        }
+        key[pos] = v;
+        idx[pos] = id;
+    }
+}
+
+typedef struct {
+    const AmxMatrix *x, *y;
+    Dist dist;
+    size_t k;
+    size_t parts;
+    size_t part_rows;               // Database rows per part
+    float *key;                     // m x k per part: the output when there is one part
+    uint32_t *idx;
+    atomic_bool failed;
+} Knn;
+
+// One task's view while its GEMM blocks run
+typedef struct {
+    const Knn *knn;
+    const float *scratch;
+    size_t r0, c0;                  // Query and database offsets of the current block
+    float *key;                     // Heaps of rows r0.. of this task's part
+    uint32_t *idx;
+    size_t count[KNN_MB];
+} KnnTask;
+
+static void knn_epilogue(const void *ctx, size_t i0, size_t i1, size_t j0, size_t j1) {
+    KnnTask *t = (KnnTask *)ctx;
+    const Knn *s = t->knn;
+    const bool negate = s->dist.metric != AMX_METRIC_L2;
+    
+    for (size_t i = i0; i < i1; ++i) {
+        const float *RESTRICT row = t->scratch + i * KNN_NB;
+        float *key = t->key + i * s->k;
+        uint32_t *idx = t->idx + i * s->k;
+        for (size_t j = j0; j < j1; ++j) {
+            const float v = dist_value(&s->dist, t->r0 + i, t->c0 + j, row[j]);
+            knn_push(key, idx, &t->count[i], s->k, negate ? -v : v, (uint32_t)(t->c0 + j));
+        }
+    }
+}
+
+static void knn_task_body(void *ctx, size_t task) {
+    Knn *s = (Knn *)ctx;
+    const size_t qb = task / s->parts, part = task % s->parts;
+    const size_t m = s->x->rows, n = s->y->rows;
+    const size_t r0 = qb * KNN_MB, r1 = (r0 + KNN_MB < m) ? r0 + KNN_MB : m;
+    const size_t p0 = part * s->part_rows, p1 = (p0 + s->part_rows < n) ? p0 + s->part_rows : n;
+    if (r0 >= r1 || p0 >= p1) return;
+    
+    float *scratch = alloc_aligned(KNN_MB * KNN_NB * sizeof(float));
+    if (UNLIKELY(!scratch)) {
+        atomic_store_explicit(&s->failed, true, memory_order_relaxed);
+        return;
+    }
+    
+    KnnTask t = {
+        .knn = s, .scratch = scratch, .r0 = r0,
+        .key = s->key + (part * m + r0) * s->k,
+        .idx = s->idx + (part * m + r0) * s->k
+    };
+    for (size_t c0 = p0; c0 < p1; c0 += KNN_NB) {
+        const size_t nc = (c0 + KNN_NB < p1) ? KNN_NB : p1 - c0;
+        t.c0 = c0;
+        const Sgemm g = {
+            .A = s->x->data + r0 * s->x->stride, .lda = s->x->stride,
+            .B = s->y->data + c0 * s->y->stride, .ldb = s->y->stride, .trans_b = true,
+            .C = scratch, .ldc = KNN_NB, .M = r1 - r0, .N = nc, .K = s->x->cols,
+            .alpha = s->dist.metric == AMX_METRIC_L2 ? -2.0f : 1.0f, .beta = 0.0f,
+            .epilogue = knn_epilogue, .epilogue_ctx = &t, .serial = true
+        };
+        sgemm_run(&g);
+    }
+    free(scratch);
+}
+
+bool amx_matrix_knn(const AmxMatrix *x, const AmxMatrix *y, AmxMetric metric, size_t k,
+                    float *scores, uint32_t *indices) {
+    if (UNLIKELY(!x || !y || !scores || !indices || x->cols != y->cols)) return false;
+    if (UNLIKELY(k == 0 || k > y->rows || y->rows > UINT32_MAX)) return false;
+    
+    const size_t m = x->rows, n = y->rows;
+    const size_t workers = (size_t)num_workers();
+    const size_t q_blocks = (m + KNN_MB - 1) / KNN_MB;
+    size_t parts = 1;
+    if (q_blocks < workers) {
+        const size_t n_blocks = (n + KNN_NB - 1) / KNN_NB;
+        parts = workers / q_blocks;
+        if (parts > n_blocks) parts = n_blocks;
+        if (parts < 1) parts = 1;
+    }
+    
+    // Whole GEMM blocks per part; rounding up can leave fewer parts
+    const size_t part_rows = round_up((n + parts - 1) / parts, KNN_NB);
+    parts = (n + part_rows - 1) / part_rows;
+    Knn s = {
+        .x = x, .y = y, .k = k, .parts = parts, .part_rows = part_rows,
+        .dist = { .metric = metric }
+    };
+    atomic_init(&s.failed, false);
+    float *x_norm = NULL, *y_norm = NULL;
+    float *part_key = NULL;
+    uint32_t *part_idx = NULL;
+    bool ok = true;
+    if (metric != AMX_METRIC_INNER_PRODUCT) {
+        s.dist.x_norm = x_norm = dist_norms(x, metric);
+        s.dist.y_norm = y_norm = dist_norms(y, metric);
+        ok = x_norm && y_norm;
+    }
+    if (parts > 1) {
+        part_key = malloc(parts * m * k * sizeof(float));
+        part_idx = malloc(parts * m * k * sizeof(uint32_t));
+        ok = ok && part_key && part_idx;
+    }
+    
+    if (LIKELY(ok)) {
+        s.key = parts > 1 ? part_key : scores;
+        s.idx = parts > 1 ? part_idx : indices;
+        parallel_for(q_blocks * parts, &s, knn_task_body);
+        ok = !atomic_load_explicit(&s.failed, memory_order_relaxed);
+        
+        // Every heap saw all of its part, so each holds min(k, part size) entries
+        for (size_t i = 0; i < m && ok; ++i) {
+            float *key = scores + i * k;
+            uint32_t *idx = indices + i * k;
+            size_t count = k;
+            if (parts > 1) {
+                count = 0;
+                for (size_t p = 0; p < parts; ++p) {
+                    const size_t size = (p + 1) * part_rows <= n ? part_rows : n - p * part_rows;
+                    const size_t have = size < k ? size : k;
+                    const float *pk = part_key + (p * m + i) * k;
+                    const uint32_t *pi = part_idx + (p * m + i) * k;
+                    for (size_t e = 0; e < have; ++e) knn_push(key, idx, &count, k, pk[e], pi[e]);
+                }
+            }
+            knn_sort(key, idx, count);
+            if (metric != AMX_METRIC_L2) {
+                for (size_t e = 0; e < count; ++e) key[e] = -key[e];
+            }
+        }
+    }
+    
+    free(x_norm);
+    free(y_norm);
+    free(part_key);
+    free(part_idx);
+    return ok;
 }
@@ -262,12 +262,38 @@ void amx_matrix_set(AmxMatrix *m, size_t row, size_t col, float value);
 
 /// Matrix multiplication: result = a * b
 /// Returns NULL if dimensions don't match or allocation fails.
-/// Uses AMX acceleration for square matrices when available.
+/// Uses AMX acceleration when available, a blocked SIMD kernel otherwise.
 AmxMatrix *amx_matrix_matmul(const AmxMatrix *a, const AmxMatrix *b);
 
+/// Operand orientation for the GEMM entry points.
+typedef enum {
+    AMX_NO_TRANS = 0,
+    AMX_TRANS = 1,
+} AmxTranspose;
+
+/// Matrix multiplication with transposed operands: result = op(a) * op(b).
+/// The transpose is absorbed into operand packing; no transposed copy is made.
+/// Returns NULL if dimensions don't match or allocation fails.
+AmxMatrix *amx_matrix_matmul_t(const AmxMatrix *a, AmxTranspose trans_a,
+                               const AmxMatrix *b, AmxTranspose trans_b);
+
+/// General matrix multiply in place: c = alpha * op(a) * op(b) + beta * c.
+/// With beta == 0, c is overwritten (its previous contents, even NaN, are ignored).
+/// c must not alias a or b. Returns false if dimensions don't match.
+bool amx_matrix_gemm(AmxTranspose trans_a, AmxTranspose trans_b,
+                     float alpha, const AmxMatrix *a, const AmxMatrix *b,
+                     float beta, AmxMatrix *c);
+
 /// Transpose a matrix.
+/// Blocked and cache-oblivious; large matrices are split across threads.
 AmxMatrix *amx_matrix_transpose(const AmxMatrix *m);
 
+/// Transpose a strided row-major buffer: dst[j * dst_stride + i] = src[i * src_stride + j]
+/// for a rows x cols source. Buffers must not overlap.
+void amx_transpose_f32(const float *src, size_t src_stride,
+                       float *dst, size_t dst_stride,
+                       size_t rows, size_t cols);
+
 /// Element-wise addition: result = a + b
 /// Returns NULL if shapes don't match.
 AmxMatrix *amx_matrix_add(const AmxMatrix *a, const AmxMatrix *b);
@@ -278,6 +304,750 @@ AmxMatrix *amx_matrix_sub(const AmxMatrix *a, const AmxMatrix *b);
 /// Scalar multiplication: result = m * scalar
 AmxMatrix *amx_matrix_scale(const AmxMatrix *m, float scalar);
 
+/// In-place addition: a += b. Returns false if shapes don't match.
+bool amx_matrix_add_inplace(AmxMatrix *a, const AmxMatrix *b);
+
+/// In-place scaled addition: y += alpha * x. Returns false if shapes don't match.
+bool amx_matrix_axpy(float alpha, const AmxMatrix *x, AmxMatrix *y);
+
+/// In-place scalar multiplication: m *= scalar
+void amx_matrix_scale_inplace(AmxMatrix *m, float scalar);
+
+/// Maximum operand count for amx_matrix_lincomb.
+#define AMX_LINCOMB_MAX 8
+
+/// Fused linear combination in a single pass:
+/// out = coeffs[0] * mats[0] + ... + coeffs[n-1] * mats[n-1] + bias
+/// out may be one of the operands. With n == 0, out is filled with bias.
+/// Returns false if n > AMX_LINCOMB_MAX or any shape differs from out.
+bool amx_matrix_lincomb(AmxMatrix *out, size_t n, const float *coeffs,
+                        const AmxMatrix *const *mats, float bias);
+
+// ============================================================================
+// Deferred Expressions
+// ============================================================================
+
+/// Node of a lazily evaluated matrix expression (opaque, reference counted).
+/// Builders take ownership of the references passed to them, so calls nest:
+///   amx_expr_scale(amx_expr_add(amx_expr_matmul(a, b), c), 0.5f)
+/// Use amx_expr_retain to feed one node to several builders. On error a
+/// builder releases its arguments and returns NULL, so NULL propagates.
+/// Expressions are not thread-safe.
+typedef struct AmxExpr AmxExpr;
+
+/// Leaf referencing m without copying. m must stay alive and unchanged
+/// until the last amx_expr_eval of any expression using it.
+AmxExpr *amx_expr_input(const AmxMatrix *m);
+
+/// a * b. NULL if a->cols != b->rows.
+AmxExpr *amx_expr_matmul(AmxExpr *a, AmxExpr *b);
+
+/// coeffs[0] * args[0] + ... + coeffs[n-1] * args[n-1] + bias, for
+/// 1 <= n <= AMX_LINCOMB_MAX operands of equal shape.
+AmxExpr *amx_expr_lincomb(size_t n, const float *coeffs, AmxExpr *const *args, float bias);
+
+/// a + b
+AmxExpr *amx_expr_add(AmxExpr *a, AmxExpr *b);
+
+/// a - b
+AmxExpr *amx_expr_sub(AmxExpr *a, AmxExpr *b);
+
+/// a * scalar
+AmxExpr *amx_expr_scale(AmxExpr *a, float scalar);
+
+/// Add a reference. Returns e.
+AmxExpr *amx_expr_retain(AmxExpr *e);
+
+/// Drop a reference; the node and its unreferenced operands are freed.
+void amx_expr_release(AmxExpr *e);
+
+/// Evaluate into a new matrix (caller frees). Elementwise chains are fused
+/// into a preceding matmul's epilogue or into one streaming pass, and
+/// intermediate buffers are reused once their last consumer has run.
+/// The expression is not consumed and may be evaluated again.
+AmxMatrix *amx_expr_eval(AmxExpr *e);
+
+// ============================================================================
+// Reductions
+// ============================================================================
+
+typedef enum {
+    AMX_REDUCE_FAST = 0,        // Independent float lanes
+    AMX_REDUCE_PAIRWISE = 1,    // Tree summation, error grows with log(n)
+    AMX_REDUCE_KAHAN = 2,       // Compensated summation
+} AmxReduceMode;
+
+/// out[i] = sum of row i. out holds rows floats.
+bool amx_matrix_row_sums(const AmxMatrix *m, float *out, AmxReduceMode mode);
+
+/// out[j] = sum of column j. out holds cols floats.
+/// In FAST mode on AMX this is a ones-vector GEMV.
+bool amx_matrix_col_sums(const AmxMatrix *m, float *out, AmxReduceMode mode);
+
+/// out[i] = L2 norm of row i. out holds rows floats.
+bool amx_matrix_row_norms(const AmxMatrix *m, float *out, AmxReduceMode mode);
+
+/// Largest absolute element; NaN if any element is NaN, 0 for NULL.
+float amx_matrix_max_abs(const AmxMatrix *m);
+
+/// sqrt of the sum of squared elements, 0 for NULL.
+float amx_matrix_frobenius_norm(const AmxMatrix *m, AmxReduceMode mode);
+
+// ============================================================================
+// Convolution
+// ============================================================================
+
+typedef enum {
+    AMX_ACT_NONE = 0,
+    AMX_ACT_RELU = 1,           // max(x, 0)
+    AMX_ACT_RELU6 = 2,          // min(max(x, 0), 6)
+} AmxActivation;
+
+/// Shape of a 2D convolution. Zero stride, dilation or groups mean 1.
+/// Padding is applied symmetrically (pad_h rows above and below).
+typedef struct {
+    size_t batch, in_h, in_w, in_c;
+    size_t out_c;
+    size_t kernel_h, kernel_w;
+    size_t stride_h, stride_w;
+    size_t pad_h, pad_w;
+    size_t dilation_h, dilation_w;
+    size_t groups;              // Must divide in_c and out_c
+} AmxConv2dParams;
+
+/// Output size: (in + 2 * pad - dilation * (kernel - 1) - 1) / stride + 1.
+/// Returns false if the dilated kernel does not fit the padded input.
+bool amx_conv2d_output_size(const AmxConv2dParams *p, size_t *out_h, size_t *out_w);
+
+/// NHWC convolution with optional bias and activation, as an implicit GEMM:
+/// input patches are gathered straight into the GEMM panels, never into an
+/// im2col buffer.
+///   input:  [batch][in_h][in_w][in_c]
+///   filter: [kernel_h][kernel_w][in_c / groups][out_c]
+///   bias:   [out_c] or NULL
+///   output: [batch][out_h][out_w][out_c]
+/// Depthwise convs (groups == in_c == out_c) run a dedicated channel-blocked
+/// vector kernel; unpadded stride-1 1x1 convs read the input in place.
+bool amx_conv2d_f32(const AmxConv2dParams *p, const float *input, const float *filter,
+                    const float *bias, AmxActivation act, float *output);
+
+/// 1x1 convolution over NHWC buffers as a single GEMM with no copies:
+///   output[pixels][out_c] = act(input[pixels][in_c] * filter[in_c][out_c] + bias)
+/// pixels is batch * height * width; bias may be NULL.
+bool amx_conv1x1_f32(const float *input, size_t pixels, size_t in_c,
+                     const float *filter, size_t out_c,
+                     const float *bias, AmxActivation act, float *output);
+
+// ============================================================================
+// Attention
+// ============================================================================
+
+/// Shape of a multi-head attention. Zero kv_heads means heads.
+typedef struct {
+    size_t batch;
+    size_t heads;               // Query heads
+    size_t kv_heads;            // Must divide heads; each K/V head serves heads / kv_heads queries
+    size_t q_len, kv_len;
+    size_t head_dim;
+    float scale;                // 0 means 1 / sqrt(head_dim)
+    bool causal;                // Query i sees keys j <= i + kv_len - q_len
+} AmxAttentionParams;
+
+/// out = softmax(scale * Q * K^T) * V for every batch and head, with tiled
+/// online softmax: the q_len x kv_len score matrix is never materialized.
+///   q, out: [batch][q_len][heads][head_dim]
+///   k, v:   [batch][kv_len][kv_heads][head_dim]
+/// Causal rows that see no key produce zeros.
+/// Returns false for NULL pointers, zero sizes or a kv_heads that does not
+/// divide heads.
+bool amx_attention_f32(const AmxAttentionParams *p, const float *q, const float *k,
+                       const float *v, float *out);
+
+// ============================================================================
+// Row Normalization
+// ============================================================================
+
+typedef enum {
+    AMX_ROW_SOFTMAX = 0,        // exp(x - max) / sum; see amx_matrix_softmax
+    AMX_ROW_LAYERNORM = 1,      // (x - mean) / sqrt(var + eps) * gamma + beta
+    AMX_ROW_RMSNORM = 2,        // x / sqrt(mean(x^2) + eps) * gamma
+} AmxRowOpKind;
+
+/// A per-row operation. gamma and beta hold cols floats; NULL means all
+/// ones and all zeros. Zero eps means 1e-5. Softmax ignores all three.
+typedef struct {
+    AmxRowOpKind kind;
+    const float *gamma;
+    const float *beta;
+    float eps;
+} AmxRowOp;
+
+/// Apply op to every row of m in place. Padding lanes stay zero.
+/// Returns false for NULL arguments or an unknown kind.
+bool amx_matrix_row_op(AmxMatrix *m, const AmxRowOp *op);
+
+/// op(a * b) with op fused as the GEMM epilogue: each block of rows is
+/// normalized right after its last column tile is produced, while still in
+/// cache. Returns NULL on shape mismatch or allocation failure.
+AmxMatrix *amx_matrix_matmul_row_op(const AmxMatrix *a, const AmxMatrix *b, const AmxRowOp *op);
+
+/// Row-wise softmax in place. -inf entries get exactly 0 and a row that is
+/// all -inf becomes zeros; +inf entries split the row evenly. A NaN
+/// anywhere in a row makes the row NaN.
+bool amx_matrix_softmax(AmxMatrix *m);
+
+/// Row-wise layer normalization in place; gamma and beta may be NULL.
+bool amx_matrix_layernorm(AmxMatrix *m, const float *gamma, const float *beta, float eps);
+
+/// Row-wise RMS normalization in place; gamma may be NULL.
+bool amx_matrix_rmsnorm(AmxMatrix *m, const float *gamma, float eps);
+
+// ============================================================================
+// Triangular Solves
+// ============================================================================
+
+typedef enum {
+    AMX_LEFT = 0,               // op(T) * X = B
+    AMX_RIGHT = 1,              // X * op(T) = B
+} AmxSide;
+
+typedef enum {
+    AMX_LOWER = 0,
+    AMX_UPPER = 1,
+} AmxTriangle;
+
+typedef enum {
+    AMX_NON_UNIT = 0,
+    AMX_UNIT = 1,               // Diagonal taken as 1 and not read
+} AmxDiag;
+
+/// Solve op(T) * X = B or X * op(T) = B for triangular n x n T, overwriting
+/// b with X. Only the uplo triangle of t is read. Diagonal blocks are solved
+/// by substitution and the rest of the work is SGEMM updates; many
+/// right-hand sides are split across threads.
+/// Returns false for NULL or mismatched shapes.
+bool amx_matrix_trsm(AmxSide side, AmxTriangle uplo, AmxTranspose trans, AmxDiag diag,
+                     const AmxMatrix *t, AmxMatrix *b);
+
+// ============================================================================
+// Symmetric Rank-k Update
+// ============================================================================
+
+/// C = alpha * op(A) * op(A)^T + beta * C for n x n C, where op(A) is A
+/// (n x k, C = A * A^T) or A^T (A is k x n, C = A^T * A). Only the 16x16
+/// tiles touching the uplo triangle are computed, about half the work of a
+/// full multiply; tiles on the diagonal are written whole and the rest of
+/// the other triangle is left untouched unless mirror copies the result
+/// across to make C fully symmetric.
+/// Returns false for NULL or mismatched shapes.
+bool amx_matrix_syrk(AmxTriangle uplo, AmxTranspose trans, float alpha, const AmxMatrix *a,
+                     float beta, AmxMatrix *c, bool mirror);
+
+/// Symmetric Gram matrix: a * a^T (AMX_NO_TRANS) or a^T * a (AMX_TRANS).
+/// Returns NULL on allocation failure.
+AmxMatrix *amx_matrix_gram(const AmxMatrix *a, AmxTranspose trans);
+
+// ============================================================================
+// Cholesky Factorization
+// ============================================================================
+
+/// In-place Cholesky factorization A = L * L^T of a symmetric positive-definite
+/// matrix. Only the lower triangle is read; on success `a` holds L with the
+/// strict upper triangle zeroed.
+/// Returns 0 on success, -1 for NULL or non-square input, or k > 0 if the
+/// leading k x k minor is not positive definite (a is then partially updated).
+int amx_matrix_cholesky(AmxMatrix *a);
+
+/// Solve A * X = B given L from amx_matrix_cholesky, by forward and back
+/// substitution. b (n x nrhs) is overwritten with X.
+bool amx_matrix_cholesky_solve(const AmxMatrix *l, AmxMatrix *b);
+
+// ============================================================================
+// LU Factorization
+// ============================================================================
+
+/// In-place LU factorization with partial pivoting, P * A = L * U, for an
+/// m x n matrix. On return the strict lower triangle holds L (unit diagonal
+/// implied) and the upper triangle holds U. pivots (min(m, n) entries)
+/// records the row swaps: row i was exchanged with row pivots[i], in order.
+/// Returns 0 on success, -1 for NULL arguments, or k > 0 if U[k-1][k-1] is
+/// exactly zero (the factorization is complete but U is singular).
+int amx_matrix_lu(AmxMatrix *a, size_t *pivots);
+
+/// Solve A * X = B given the factors of a square A from amx_matrix_lu.
+/// b (n x nrhs) is overwritten with X.
+bool amx_matrix_lu_solve(const AmxMatrix *lu, const size_t *pivots, AmxMatrix *b);
+
+/// Solve A * X = B for square A and any number of right-hand sides.
+/// Returns a new matrix X, or NULL if A is singular or shapes don't match.
+AmxMatrix *amx_matrix_solve(const AmxMatrix *a, const AmxMatrix *b);
+
+// ============================================================================
+// QR Factorization
+// ============================================================================
+
+/// In-place blocked Householder QR of an m x n matrix. R is left in the upper
+/// triangle and the Householder vectors (unit leading entry implied) below
+/// it; tau receives min(m, n) reflector scales.
+bool amx_matrix_qr(AmxMatrix *a, float *tau);
+
+/// Thin Q (m x min(m, n)) from the factors written by amx_matrix_qr.
+AmxMatrix *amx_matrix_qr_q(const AmxMatrix *qr, const float *tau);
+
+/// R factor (min(m, n) x n, upper triangular) of a tall-skinny matrix by
+/// TSQR: row blocks are factored in parallel and their R factors merged.
+/// R is unique up to the signs of its rows.
+AmxMatrix *amx_matrix_tsqr_r(const AmxMatrix *a);
+
+/// Least-squares solution X minimizing ||A * X - B|| for m x n A with
+/// m >= n, via TSQR of [A | B]. Returns NULL if A is numerically rank
+/// deficient (some |R_ii| <= m * FLT_EPSILON * max_j |R_jj|) or shapes
+/// don't match.
+AmxMatrix *amx_matrix_lstsq(const AmxMatrix *a, const AmxMatrix *b);
+
+// ============================================================================
+// Half Precision (f16)
+// ============================================================================
+
+/// Convert n floats to IEEE binary16 (round to nearest even).
+/// Uses NEON on ARM and F16C on x86 when present, scalar code otherwise.
+void amx_f32_to_f16(const float *src, uint16_t *dst, size_t n);
+
+/// Convert n IEEE binary16 values to floats (exact).
+void amx_f16_to_f32(const uint16_t *src, float *dst, size_t n);
+
+/// Opaque f16 matrix handle. Elements are stored as raw binary16 bit patterns.
+///
+/// Same layout rules as AmxMatrix, at half the footprint:
+/// - Data is 64-byte aligned
+/// - Row stride is padded to a 32-element (64-byte) boundary
+typedef struct AmxMatrixF16 AmxMatrixF16;
+
+/// Create a zero-filled f16 matrix.
+/// Returns NULL on allocation failure.
+AmxMatrixF16 *amx_matrix_f16_zeros(size_t rows, size_t cols);
+
+/// Create an f16 matrix from binary16 data (copies the data).
+/// data must have at least rows*cols elements.
+AmxMatrixF16 *amx_matrix_f16_from_data(size_t rows, size_t cols, const uint16_t *data);
+
+/// Convert an f32 matrix to f16 (round to nearest even).
+AmxMatrixF16 *amx_matrix_f16_from_f32(const AmxMatrix *m);
+
+/// Widen an f16 matrix to f32.
+AmxMatrix *amx_matrix_f16_to_f32(const AmxMatrixF16 *m);
+
+/// Free an f16 matrix. Safe to call with NULL.
+void amx_matrix_f16_free(AmxMatrixF16 *m);
+
+size_t amx_matrix_f16_rows(const AmxMatrixF16 *m);
+size_t amx_matrix_f16_cols(const AmxMatrixF16 *m);
+
+/// Row stride in elements (>= cols, multiple of 32).
+size_t amx_matrix_f16_stride(const AmxMatrixF16 *m);
+
+const uint16_t *amx_matrix_f16_data(const AmxMatrixF16 *m);
+uint16_t *amx_matrix_f16_data_mut(AmxMatrixF16 *m);
+
+/// Get element at (row, col) widened to f32. No bounds checking.
+float amx_matrix_f16_get(const AmxMatrixF16 *m, size_t row, size_t col);
+
+/// Set element at (row, col), rounding to f16. No bounds checking.
+void amx_matrix_f16_set(AmxMatrixF16 *m, size_t row, size_t col, float value);
+
+/// Mixed-precision matrix multiplication: result = a * b
+/// Inputs are f16, products are accumulated and returned in f32.
+/// Uses AMX fma16 with f32 accumulation when available; elsewhere the inputs are
+/// widened block by block and multiplied with a vectorized f32 kernel.
+/// Returns NULL if dimensions don't match or allocation fails.
+AmxMatrix *amx_matrix_f16_matmul(const AmxMatrixF16 *a, const AmxMatrixF16 *b);
+
+// ============================================================================
+// Brain Float (bf16)
+// ============================================================================
+
+/// Convert n floats to bfloat16 (round to nearest even, NaN preserved).
+/// Subnormals are kept, identically on every backend.
+void amx_f32_to_bf16(const float *src, uint16_t *dst, size_t n);
+
+/// Convert n bfloat16 values to floats (exact: a 16-bit shift).
+void amx_bf16_to_f32(const uint16_t *src, float *dst, size_t n);
+
+/// Opaque bf16 matrix handle. Elements are stored as raw bfloat16 bit patterns,
+/// with the same layout as AmxMatrixF16 (64-byte aligned, stride multiple of 32).
+typedef struct AmxMatrixBF16 AmxMatrixBF16;
+
+/// Create a zero-filled bf16 matrix.
+/// Returns NULL on allocation failure.
+AmxMatrixBF16 *amx_matrix_bf16_zeros(size_t rows, size_t cols);
+
+/// Create a bf16 matrix from bfloat16 data (copies the data).
+/// data must have at least rows*cols elements.
+AmxMatrixBF16 *amx_matrix_bf16_from_data(size_t rows, size_t cols, const uint16_t *data);
+
+/// Convert an f32 matrix to bf16 (round to nearest even).
+AmxMatrixBF16 *amx_matrix_bf16_from_f32(const AmxMatrix *m);
+
+/// Widen a bf16 matrix to f32.
+AmxMatrix *amx_matrix_bf16_to_f32(const AmxMatrixBF16 *m);
+
+/// Free a bf16 matrix. Safe to call with NULL.
+void amx_matrix_bf16_free(AmxMatrixBF16 *m);
+
+size_t amx_matrix_bf16_rows(const AmxMatrixBF16 *m);
+size_t amx_matrix_bf16_cols(const AmxMatrixBF16 *m);
+
+/// Row stride in elements (>= cols, multiple of 32).
+size_t amx_matrix_bf16_stride(const AmxMatrixBF16 *m);
+
+const uint16_t *amx_matrix_bf16_data(const AmxMatrixBF16 *m);
+uint16_t *amx_matrix_bf16_data_mut(AmxMatrixBF16 *m);
+
+/// Get element at (row, col) widened to f32. No bounds checking.
+float amx_matrix_bf16_get(const AmxMatrixBF16 *m, size_t row, size_t col);
+
+/// Set element at (row, col), rounding to bf16. No bounds checking.
+void amx_matrix_bf16_set(AmxMatrixBF16 *m, size_t row, size_t col, float value);
+
+/// Mixed-precision matrix multiplication: result = a * b
+/// Inputs are bf16, products are accumulated and returned in f32.
+/// Backend chosen at runtime: AMX (bf16 widened while packing, f32 tiles),
+/// AVX-512 BF16 dot products on x86 that have them, otherwise a vectorized
+/// widening kernel.
+/// Returns NULL if dimensions don't match or allocation fails.
+AmxMatrix *amx_matrix_bf16_matmul(const AmxMatrixBF16 *a, const AmxMatrixBF16 *b);
+
+// ============================================================================
+// INT8 Quantized Matrices
+// ============================================================================
+
+/// Granularity of quantization parameters.
+typedef enum {
+    AMX_QUANT_PER_TENSOR = 0,   // One scale/zero point for the whole matrix
+    AMX_QUANT_PER_ROW = 1,      // One per row (e.g. per token for activations)
+    AMX_QUANT_PER_COL = 2,      // One per column (e.g. per output channel for weights)
+} AmxQuantAxis;
+
+/// Opaque int8 matrix handle with affine quantization parameters:
+/// real = scale[c] * (q - zero_point[c]) for channel c of each element.
+/// Data is 64-byte aligned, row stride padded to a 64-element boundary.
+typedef struct AmxMatrixI8 AmxMatrixI8;
+
+/// Quantize an f32 matrix. Ranges are taken per channel of `axis` and always
+/// include zero. symmetric=true gives zero_point 0 and scale = max|x| / 127;
+/// otherwise the full [-128, 127] range is used with a zero point.
+/// Returns NULL on allocation failure.
+AmxMatrixI8 *amx_matrix_i8_quantize(const AmxMatrix *m, AmxQuantAxis axis, bool symmetric);
+
+/// Create an int8 matrix from existing quantized data (copies everything).
+/// scales has 1, rows or cols entries depending on axis; zero_points may be NULL (all zero).
+AmxMatrixI8 *amx_matrix_i8_from_data(size_t rows, size_t cols, const int8_t *data,
+                                     AmxQuantAxis axis, const float *scales,
+                                     const int32_t *zero_points);
+
+/// Dequantize to f32.
+AmxMatrix *amx_matrix_i8_dequantize(const AmxMatrixI8 *m);
+
+/// Free an int8 matrix. Safe to call with NULL.
+void amx_matrix_i8_free(AmxMatrixI8 *m);
+
+size_t amx_matrix_i8_rows(const AmxMatrixI8 *m);
+size_t amx_matrix_i8_cols(const AmxMatrixI8 *m);
+
+/// Row stride in elements (>= cols, multiple of 64).
+size_t amx_matrix_i8_stride(const AmxMatrixI8 *m);
+
+const int8_t *amx_matrix_i8_data(const AmxMatrixI8 *m);
+int8_t *amx_matrix_i8_data_mut(AmxMatrixI8 *m);
+AmxQuantAxis amx_matrix_i8_axis(const AmxMatrixI8 *m);
+const float *amx_matrix_i8_scales(const AmxMatrixI8 *m);
+const int32_t *amx_matrix_i8_zero_points(const AmxMatrixI8 *m);
+
+// Quantized GEMM: int8 x int8 products accumulate in int32, zero points are
+// corrected exactly, then a fused epilogue produces the output.
+// a must be quantized per tensor or per row, b per tensor or per column, so
+// every output element has a single combined scale. Backends: AMX mac16 on
+// operands sign-extended to i16 with 32-bit Z accumulation, AVX-512 VNNI on
+// x86, NEON sdot on ARM cores with dot product, a vectorized loop otherwise.
+
+/// Raw zero-point-corrected accumulators: c[i * c_stride + j] = sum_k (a - za)(b - zb).
+/// Returns false on mismatched shapes/axes or allocation failure.
+bool amx_matrix_i8_matmul_i32(const AmxMatrixI8 *a, const AmxMatrixI8 *b,
+                              int32_t *c, size_t c_stride);
+
+/// Dequantizing GEMM: result = sa * sb * acc + bias. bias (cols of b entries) may be NULL.
+AmxMatrix *amx_matrix_i8_matmul(const AmxMatrixI8 *a, const AmxMatrixI8 *b, const float *bias);
+
+/// Requantizing GEMM: result is int8, per-tensor with the given output parameters:
+/// q = clamp(round((sa * sb * acc + bias) / out_scale) + out_zero_point, -128, 127).
+AmxMatrixI8 *amx_matrix_i8_matmul_requant(const AmxMatrixI8 *a, const AmxMatrixI8 *b,
+                                          const float *bias, float out_scale,
+                                          int32_t out_zero_point);
+
+// ============================================================================
+// 4-bit Weight-Only Quantization
+// ============================================================================
+
+/// Opaque packed int4 weight matrix (K rows x N cols), two values per byte
+/// (low nibble = even column). Each group of group_size consecutive rows has
+/// one f32 scale per column: w = scale[k / group_size][j] * (nibble - 8).
+typedef struct AmxMatrixQ4 AmxMatrixQ4;
+
+/// Quantize f32 weights symmetrically to 4 bits with groups along rows (K).
+/// Returns NULL if group_size is 0 or on allocation failure.
+AmxMatrixQ4 *amx_matrix_q4_quantize(const AmxMatrix *m, size_t group_size);
+
+/// Expand back to f32.
+AmxMatrix *amx_matrix_q4_dequantize(const AmxMatrixQ4 *w);
+
+/// Free a 4-bit matrix. Safe to call with NULL.
+void amx_matrix_q4_free(AmxMatrixQ4 *w);
+
+size_t amx_matrix_q4_rows(const AmxMatrixQ4 *w);
+size_t amx_matrix_q4_cols(const AmxMatrixQ4 *w);
+
+/// Row stride in bytes (multiple of 64).
+size_t amx_matrix_q4_stride(const AmxMatrixQ4 *w);
+size_t amx_matrix_q4_group_size(const AmxMatrixQ4 *w);
+const uint8_t *amx_matrix_q4_data(const AmxMatrixQ4 *w);
+
+/// Group scales, row g at scales + g * scale_stride.
+const float *amx_matrix_q4_scales(const AmxMatrixQ4 *w);
+size_t amx_matrix_q4_scale_stride(const AmxMatrixQ4 *w);
+
+/// y = x^T W for x of length rows(w), y of length cols(w). Weights are expanded
+/// on the fly (table lookup), so only the packed nibbles are read from memory.
+void amx_matrix_q4_gemv(const AmxMatrixQ4 *w, const float *x, float *y);
+
+/// C = A * W with f32 activations. Uses AMX when available; single-row A takes the GEMV path.
+AmxMatrix *amx_matrix_q4_matmul(const AmxMatrix *a, const AmxMatrixQ4 *w);
+
+// ============================================================================
+// INT16 Fixed-Point Matrices
+// ============================================================================
+
+/// Convert f32 in [-1, 1) to Q15 with rounding and saturation.
+void amx_f32_to_q15(const float *src, int16_t *dst, size_t n);
+
+/// Convert Q15 to f32.
+void amx_q15_to_f32(const int16_t *src, float *dst, size_t n);
+
+/// Opaque int16 matrix handle.
+/// Data is 64-byte aligned, row stride padded to a 32-element boundary.
+typedef struct AmxMatrixI16 AmxMatrixI16;
+
+AmxMatrixI16 *amx_matrix_i16_zeros(size_t rows, size_t cols);
+
+/// Create from row-major int16 data (copies).
+AmxMatrixI16 *amx_matrix_i16_from_data(size_t rows, size_t cols, const int16_t *data);
+
+/// Free an int16 matrix. Safe to call with NULL.
+void amx_matrix_i16_free(AmxMatrixI16 *m);
+
+size_t amx_matrix_i16_rows(const AmxMatrixI16 *m);
+size_t amx_matrix_i16_cols(const AmxMatrixI16 *m);
+
+/// Row stride in elements (>= cols, multiple of 32).
+size_t amx_matrix_i16_stride(const AmxMatrixI16 *m);
+const int16_t *amx_matrix_i16_data(const AmxMatrixI16 *m);
+int16_t *amx_matrix_i16_data_mut(AmxMatrixI16 *m);
+int16_t amx_matrix_i16_get(const AmxMatrixI16 *m, size_t r, size_t c);
+void amx_matrix_i16_set(AmxMatrixI16 *m, size_t r, size_t c, int16_t v);
+
+// Products accumulate in int32 on every backend (AMX mac16, pmaddwd on x86,
+// smlal on NEON), so partial sums must fit in int32: for Q15 inputs the
+// real-valued sums must stay within (-2, 2).
+
+/// Raw int32 accumulators: c[i * c_stride + j] = sum_k a[i][k] * b[k][j].
+/// Returns false on mismatched shapes or allocation failure.
+bool amx_matrix_i16_matmul_i32(const AmxMatrixI16 *a, const AmxMatrixI16 *b,
+                               int32_t *c, size_t c_stride);
+
+/// Fixed-point GEMM: c = saturate_i16((acc + 2^(shift-1)) >> shift).
+/// shift = 15 keeps Q15 inputs in Q15. Returns NULL if shift > 31 or allocation fails.
+AmxMatrixI16 *amx_matrix_i16_matmul(const AmxMatrixI16 *a, const AmxMatrixI16 *b, unsigned shift);
+
+// ============================================================================
+// Complex Single Precision
+// ============================================================================
+
+/// Opaque complex f32 matrix handle in split storage: separate real and
+/// imaginary planes, each with the AmxMatrix layout (stride multiple of 16).
+typedef struct AmxMatrixC32 AmxMatrixC32;
+
+/// Real-decomposition used by the complex GEMM.
+typedef enum {
+    AMX_COMPLEX_3M = 0,   // 3 real products: 25% fewer flops, slightly larger rounding error
+    AMX_COMPLEX_4M = 1,   // 4 real products: textbook accuracy
+} AmxComplexAlgo;
+
+AmxMatrixC32 *amx_matrix_c32_zeros(size_t rows, size_t cols);
+
+/// Create from row-major real and imaginary arrays (copies). im may be NULL (all zero).
+AmxMatrixC32 *amx_matrix_c32_from_split(size_t rows, size_t cols, const float *re, const float *im);
+
+/// Create from row-major interleaved (re, im) pairs, 2 * rows * cols floats (copies).
+AmxMatrixC32 *amx_matrix_c32_from_interleaved(size_t rows, size_t cols, const float *data);
+
+/// Copy out as row-major interleaved (re, im) pairs into out (2 * rows * cols floats).
+void amx_matrix_c32_to_interleaved(const AmxMatrixC32 *m, float *out);
+
+/// Free a complex matrix. Safe to call with NULL.
+void amx_matrix_c32_free(AmxMatrixC32 *m);
+
+size_t amx_matrix_c32_rows(const AmxMatrixC32 *m);
+size_t amx_matrix_c32_cols(const AmxMatrixC32 *m);
+
+/// Row stride of each plane in elements (>= cols, multiple of 16).
+size_t amx_matrix_c32_stride(const AmxMatrixC32 *m);
+const float *amx_matrix_c32_real(const AmxMatrixC32 *m);
+const float *amx_matrix_c32_imag(const AmxMatrixC32 *m);
+float *amx_matrix_c32_real_mut(AmxMatrixC32 *m);
+float *amx_matrix_c32_imag_mut(AmxMatrixC32 *m);
+void amx_matrix_c32_get(const AmxMatrixC32 *m, size_t r, size_t c, float *re, float *im);
+void amx_matrix_c32_set(AmxMatrixC32 *m, size_t r, size_t c, float re, float im);
+
+/// Complex GEMM (CGEMM): C = A * B.
+/// Real and imaginary panels are packed together and all partial products stay
+/// in the AMX accumulators, so no intermediate full matrices are allocated.
+AmxMatrixC32 *amx_matrix_c32_matmul(const AmxMatrixC32 *a, const AmxMatrixC32 *b, AmxComplexAlgo algo);
+
+// ============================================================================
+// Sparse Matrices (CSR)
+// ============================================================================
+
+/// Opaque compressed-sparse-row f32 matrix: row i holds the nonzeros
+/// values[row_ptr[i] .. row_ptr[i + 1]) at columns col_idx[...], ascending.
+typedef struct AmxMatrixCsr AmxMatrixCsr;
+
+/// Keep the entries of m with |x| > threshold (0 keeps every nonzero).
+/// Returns NULL on allocation failure.
+AmxMatrixCsr *amx_matrix_csr_from_dense(const AmxMatrix *m, float threshold);
+
+/// Create from CSR arrays (copies). row_ptr has rows + 1 entries starting at
+/// 0; nnz is row_ptr[rows]. Returns NULL if row_ptr decreases or exceeds nnz,
+/// a row's columns are out of range or not strictly ascending, or nnz > 0 and
+/// col_idx or values is NULL.
+AmxMatrixCsr *amx_matrix_csr_from_data(size_t rows, size_t cols, const size_t *row_ptr,
+                                       const uint32_t *col_idx, const float *values);
+
+/// Expand to a dense matrix.
+AmxMatrix *amx_matrix_csr_to_dense(const AmxMatrixCsr *m);
+
+/// Free a CSR matrix. Safe to call with NULL.
+void amx_matrix_csr_free(AmxMatrixCsr *m);
+
+size_t amx_matrix_csr_rows(const AmxMatrixCsr *m);
+size_t amx_matrix_csr_cols(const AmxMatrixCsr *m);
+size_t amx_matrix_csr_nnz(const AmxMatrixCsr *m);
+const size_t *amx_matrix_csr_row_ptr(const AmxMatrixCsr *m);
+const uint32_t *amx_matrix_csr_col_idx(const AmxMatrixCsr *m);
+const float *amx_matrix_csr_values(const AmxMatrixCsr *m);
+
+/// Sparse x dense product C = A * B. Each nonzero scales a dense B row into
+/// vector accumulators; rows are split across threads by nonzero count.
+/// Returns NULL on shape mismatch or allocation failure.
+AmxMatrix *amx_matrix_csr_matmul(const AmxMatrixCsr *a, const AmxMatrix *b);
+
+// ============================================================================
+// Block-Sparse Matrices (16x16 tiles)
+// ============================================================================
+
+/// Opaque block-sparse f32 matrix at AMX tile granularity: a bitmap marks the
+/// nonzero 16x16 tiles and only those are stored, packed for the microkernel.
+typedef struct AmxMatrixBsr AmxMatrixBsr;
+
+/// Keep every 16x16 tile of m holding an entry with |x| > threshold; kept
+/// tiles are stored whole. Returns NULL on allocation failure.
+AmxMatrixBsr *amx_matrix_bsr_from_dense(const AmxMatrix *m, float threshold);
+
+/// Expand to a dense matrix.
+AmxMatrix *amx_matrix_bsr_to_dense(const AmxMatrixBsr *m);
+
+/// Free a block-sparse matrix. Safe to call with NULL.
+void amx_matrix_bsr_free(AmxMatrixBsr *m);
+
+size_t amx_matrix_bsr_rows(const AmxMatrixBsr *m);
+size_t amx_matrix_bsr_cols(const AmxMatrixBsr *m);
+
+/// Number of stored tiles.
+size_t amx_matrix_bsr_tiles(const AmxMatrixBsr *m);
+
+/// Whether tile (bi, bj), covering rows 16 bi.. and columns 16 bj.., is stored.
+bool amx_matrix_bsr_has_tile(const AmxMatrixBsr *m, size_t bi, size_t bj);
+
+/// Block-sparse x dense product C = A * B. Zero tiles are skipped outright,
+/// so the cost scales with the stored tile count; tile rows are split across
+/// threads by stored tiles. Returns NULL on shape mismatch or allocation failure.
+AmxMatrix *amx_matrix_bsr_matmul(const AmxMatrixBsr *a, const AmxMatrix *b);
+
+// ============================================================================
+// Strassen-Winograd
+// ============================================================================
+
+/// Algorithm for amx_matrix_matmul_algo.
+typedef enum {
+    AMX_MATMUL_TILED = 0,       // The blocked GEMM behind amx_matrix_matmul
+    AMX_MATMUL_STRASSEN = 1,    // Strassen-Winograd recursion over the blocked GEMM
+} AmxMatmulAlgo;
+
+/// Matrix multiplication with a selectable algorithm: result = a * b.
+/// With AMX_MATMUL_STRASSEN the operands are halved until the smallest of
+/// M, N, K is at most cutoff (0 selects 2048; values below 64 act as 64) and
+/// each level trades one of 8 half-size products for 15 additions, about
+/// 12% fewer flops per level. Worth it only for products of several
+/// thousand per side. The operands are zero-padded to whole quadrants and the
+/// temporaries take about (M K + K N) / 3 floats, all allocated once per call.
+///
+/// Error bound: unlike the tiled product, whose error is bounded elementwise
+/// by about K u |A| |B|, Strassen-Winograd is only normwise stable: the bound
+/// is on max|C_ij| in terms of u max|A| max|B|, and it grows by a factor of
+/// up to 18/4 per level relative to the leaf products. Expect one to two
+/// fewer correct digits at two or three levels, and large relative errors in
+/// entries of C much smaller than the typical entry, e.g. when rows or
+/// columns of A and B are scaled very differently.
+/// Returns NULL if dimensions don't match or allocation fails.
+AmxMatrix *amx_matrix_matmul_algo(const AmxMatrix *a, const AmxMatrix *b, AmxMatmulAlgo algo, size_t cutoff);
+
+// ============================================================================
+// Matrix Chains
+// ============================================================================
+
+/// Product of a chain mats[0] * mats[1] * ... * mats[count - 1].
+/// The parenthesization minimizing multiply-adds plus operand and result
+/// traffic is found by dynamic programming (O(count^3), negligible next to
+/// the products), then executed with intermediates drawn from a workspace
+/// that reuses buffers once they have been consumed. Returns a copy when
+/// count is 1, NULL if adjacent shapes don't chain or allocation fails.
+AmxMatrix *amx_matrix_chain_multiply(const AmxMatrix *const *mats, size_t count);
+
+// ============================================================================
+// Pairwise Distances and k-Nearest Neighbors
+// ============================================================================
+
+/// Distance or similarity between rows of two matrices with equal column counts.
+typedef enum {
+    AMX_METRIC_L2 = 0,              // Squared Euclidean distance |x - y|^2; smaller is nearer
+    AMX_METRIC_INNER_PRODUCT = 1,   // x . y; larger is nearer
+    AMX_METRIC_COSINE = 2,          // x . y / (|x| |y|), 0 for a zero row; larger is nearer
+} AmxMetric;
+
+/// Full x->rows x y->rows matrix of metric values between the rows of x and y.
+/// One GEMM against y transposed in place; the norms are applied in its epilogue.
+/// L2 is computed as |x|^2 + |y|^2 - 2 x . y (clamped at 0), which loses
+/// relative accuracy for points much closer together than their norms.
+/// Returns NULL if column counts differ or allocation fails.
+AmxMatrix *amx_matrix_pairwise(const AmxMatrix *x, const AmxMatrix *y, AmxMetric metric);
+
+/// For each row of x (queries), the k rows of y (database) nearest under
+/// metric: scores and indices are x->rows x k row-major arrays, each row
+/// ordered nearest first. Distances are produced tile by tile into per-row
+/// top-k heaps, so the full distance matrix is never stored.
+/// Returns false if column counts differ, k is 0 or exceeds y->rows, y has
+/// more than UINT32_MAX rows, or allocation fails.
+bool amx_matrix_knn(const AmxMatrix *x, const AmxMatrix *y, AmxMetric metric, size_t k,
+                    float *scores, uint32_t *indices);
+
 #ifdef __cplusplus
 }
 #endif
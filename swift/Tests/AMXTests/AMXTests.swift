@@ -1,4 +1,5 @@
 import XCTest
+import CAMX
 @testable import AMX
 
 final class AMXTests: XCTestCase {
@@ -109,6 +110,20 @@ final class AMXTests: XCTestCase {
         XCTAssertEqual(t[2, 1], 6)
     }
     
+    func testTransposeBlocked() {
+        // Spans several 16x16 blocks with ragged edges on both sides
+        let rows = 70, cols = 45
+        let m = Matrix(rows: rows, cols: cols, data: (0..<rows*cols).map { Float($0) })
+        let t = m.transposed()
+        
+        XCTAssertTrue(t.shape == (cols, rows))
+        for i in 0..<rows {
+            for j in 0..<cols {
+                XCTAssertEqual(t[j, i], m[i, j])
+            }
+        }
+    }
+    
     func testAdd() {
         let a = Matrix(rows: 2, cols: 2, data: [1, 2, 3, 4])
         let b = Matrix(rows: 2, cols: 2, data: [5, 6, 7, 8])
@@ -195,6 +210,914 @@ final class AMXTests: XCTestCase {
         }
     }
     
+    // MARK: - C Matrix Helpers
+    
+    /// Build a C AmxMatrix from row-major data. Caller frees with amx_matrix_free.
+    private func makeCMatrix(_ rows: Int, _ cols: Int, _ data: [Float]) -> OpaquePointer {
+        data.withUnsafeBufferPointer { amx_matrix_from_data(rows, cols, $0.baseAddress)! }
+    }
+    
+    /// Reference row-major product of two row-major arrays.
+    private func referenceMatmul(_ a: [Float], _ b: [Float], _ m: Int, _ k: Int, _ n: Int) -> [Float] {
+        var c = [Float](repeating: 0, count: m * n)
+        for i in 0..<m {
+            for kk in 0..<k {
+                let aik = a[i * k + kk]
+                for j in 0..<n {
+                    c[i * n + j] += aik * b[kk * n + j]
+                }
+            }
+        }
+        return c
+    }
+    
+    func testMatmulTransposeFlags() {
+        // A^T * B^T against the explicit product of the transposed copies
+        let m = 37, k = 50, n = 21
+        let aData = (0..<m*k).map { Float($0 % 9) - 4 }
+        let bData = (0..<k*n).map { Float($0 % 5) - 2 }
+        let a = makeCMatrix(m, k, aData), b = makeCMatrix(k, n, bData)
+        let at = amx_matrix_transpose(a), bt = amx_matrix_transpose(b)
+        let c = amx_matrix_matmul_t(at, AMX_TRANS, bt, AMX_TRANS)
+        let acc = makeCMatrix(m, n, [Float](repeating: 1, count: m * n))
+        defer {
+            amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(at); amx_matrix_free(bt)
+            amx_matrix_free(c); amx_matrix_free(acc)
+        }
+        
+        XCTAssertNotNil(c)
+        XCTAssertTrue(amx_matrix_gemm(AMX_NO_TRANS, AMX_TRANS, 2, a, bt, 3, acc))
+        let expected = referenceMatmul(aData, bData, m, k, n)
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j])
+                XCTAssertEqual(amx_matrix_get(acc, i, j), 2 * expected[i * n + j] + 3)
+            }
+        }
+    }
+    
+    func testFusedElementwise() {
+        let rows = 19, cols = 35
+        let xData = (0..<rows*cols).map { Float($0 % 7) - 3 }
+        let yData = (0..<rows*cols).map { Float($0 % 5) - 2 }
+        let x = makeCMatrix(rows, cols, xData), y = makeCMatrix(rows, cols, yData)
+        let out = amx_matrix_zeros(rows, cols)
+        defer { amx_matrix_free(x); amx_matrix_free(y); amx_matrix_free(out) }
+        
+        let mats: [OpaquePointer?] = [x, y]
+        XCTAssertTrue(amx_matrix_lincomb(out, 2, [2, -0.5], mats, 1))
+        XCTAssertTrue(amx_matrix_axpy(3, x, y))
+        amx_matrix_scale_inplace(x, -1)
+        XCTAssertTrue(amx_matrix_add_inplace(x, out))
+        for i in 0..<rows {
+            for j in 0..<cols {
+                let xv = xData[i * cols + j], yv = yData[i * cols + j]
+                XCTAssertEqual(amx_matrix_get(out, i, j), 2 * xv - 0.5 * yv + 1)
+                XCTAssertEqual(amx_matrix_get(y, i, j), yv + 3 * xv)
+                XCTAssertEqual(amx_matrix_get(x, i, j), xv - 0.5 * yv + 1)
+            }
+        }
+        
+        // A non-finite scale must leave the padding lanes zero
+        let z = makeCMatrix(5, 17, [Float](repeating: 1, count: 5 * 17))
+        defer { amx_matrix_free(z) }
+        amx_matrix_scale_inplace(z, .infinity)
+        let zData = amx_matrix_data(z)!, zStride = amx_matrix_stride(z)
+        for i in 0..<5 {
+            XCTAssertEqual(zData[i * zStride], .infinity)
+            for j in 17..<zStride {
+                XCTAssertEqual(zData[i * zStride + j], 0)
+            }
+        }
+    }
+    
+    func testExpressionFusion() {
+        // (A * B + C) * 0.5 + (A * B) with the product shared
+        let m = 20, k = 13, n = 18
+        let aData = (0..<m*k).map { Float($0 % 5) - 2 }
+        let bData = (0..<k*n).map { Float($0 % 3) - 1 }
+        let cData = (0..<m*n).map { Float($0 % 4) }
+        let a = makeCMatrix(m, k, aData), b = makeCMatrix(k, n, bData), c = makeCMatrix(m, n, cData)
+        
+        let ab = amx_expr_matmul(amx_expr_input(a), amx_expr_input(b))
+        let fused = amx_expr_scale(amx_expr_add(amx_expr_retain(ab), amx_expr_input(c)), 0.5)
+        let expr = amx_expr_add(fused, ab)
+        let result = amx_expr_eval(expr)
+        defer {
+            amx_expr_release(expr)
+            amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(c); amx_matrix_free(result)
+        }
+        
+        XCTAssertNotNil(result)
+        let product = referenceMatmul(aData, bData, m, k, n)
+        for i in 0..<m {
+            for j in 0..<n {
+                let p = product[i * n + j]
+                XCTAssertEqual(amx_matrix_get(result, i, j), (p + cData[i * n + j]) * 0.5 + p)
+            }
+        }
+    }
+    
+    func testReductions() {
+        let rows = 21, cols = 37
+        let data = (0..<rows*cols).map { Float($0 % 11) - 5 }
+        let m = makeCMatrix(rows, cols, data)
+        defer { amx_matrix_free(m) }
+        
+        var rowSums = [Float](repeating: 0, count: rows), colSums = [Float](repeating: 0, count: cols)
+        var sumSq: Float = 0
+        for i in 0..<rows {
+            for j in 0..<cols {
+                let v = data[i * cols + j]
+                rowSums[i] += v
+                colSums[j] += v
+                sumSq += v * v
+            }
+        }
+        
+        for mode in [AMX_REDUCE_FAST, AMX_REDUCE_PAIRWISE, AMX_REDUCE_KAHAN] {
+            var out = [Float](repeating: 0, count: cols)
+            XCTAssertTrue(amx_matrix_row_sums(m, &out, mode))
+            XCTAssertEqual(Array(out[0..<rows]), rowSums)
+            XCTAssertTrue(amx_matrix_col_sums(m, &out, mode))
+            XCTAssertEqual(out, colSums)
+            XCTAssertEqual(amx_matrix_frobenius_norm(m, mode), sumSq.squareRoot(), accuracy: 1e-3)
+        }
+        XCTAssertEqual(amx_matrix_max_abs(m), 5)
+    }
+    
+    func testConv2dImplicitGemm() {
+        // Strided, padded, grouped NHWC conv with bias and ReLU against a direct loop
+        var p = AmxConv2dParams()
+        p.batch = 2; p.in_h = 9; p.in_w = 7; p.in_c = 6; p.out_c = 4
+        p.kernel_h = 3; p.kernel_w = 3; p.stride_h = 2; p.stride_w = 1
+        p.pad_h = 1; p.pad_w = 1; p.groups = 2
+        var outH = 0, outW = 0
+        XCTAssertTrue(amx_conv2d_output_size(&p, &outH, &outW))
+        XCTAssertEqual(outH, 5)
+        XCTAssertEqual(outW, 7)
+        
+        let cg = 3, ocg = 2
+        let input = (0..<2*9*7*6).map { Float($0 % 7) - 3 }
+        let filter = (0..<3*3*cg*4).map { Float($0 % 5) - 2 }
+        let bias: [Float] = [1, -2, 0.5, 3]
+        var output = [Float](repeating: 0, count: 2 * outH * outW * 4)
+        XCTAssertTrue(amx_conv2d_f32(&p, input, filter, bias, AMX_ACT_RELU, &output))
+        
+        for n in 0..<2 {
+            for y in 0..<outH {
+                for x in 0..<outW {
+                    for oc in 0..<4 {
+                        let g = oc / ocg
+                        var sum = bias[oc]
+                        for kh in 0..<3 {
+                            for kw in 0..<3 {
+                                let ih = y * 2 - 1 + kh, iw = x - 1 + kw
+                                guard ih >= 0, ih < 9, iw >= 0, iw < 7 else { continue }
+                                for c in 0..<cg {
+                                    sum += input[((n * 9 + ih) * 7 + iw) * 6 + g * cg + c]
+                                         * filter[((kh * 3 + kw) * cg + c) * 4 + oc]
+                                }
+                            }
+                        }
+                        XCTAssertEqual(output[((n * outH + y) * outW + x) * 4 + oc], max(sum, 0))
+                    }
+                }
+            }
+        }
+    }
+    
+    func testDepthwiseAndPointwiseConv() {
+        let h = 6, w = 5, c = 20
+        let input = (0..<h*w*c).map { Float($0 % 9) - 4 }
+        
+        // 3x3 depthwise, padding 1: every channel filtered independently
+        var p = AmxConv2dParams()
+        p.batch = 1; p.in_h = h; p.in_w = w; p.in_c = c; p.out_c = c
+        p.kernel_h = 3; p.kernel_w = 3; p.pad_h = 1; p.pad_w = 1; p.groups = c
+        let dwFilter = (0..<9*c).map { Float($0 % 4) - 1 }
+        var dwOut = [Float](repeating: 0, count: h * w * c)
+        XCTAssertTrue(amx_conv2d_f32(&p, input, dwFilter, nil, AMX_ACT_NONE, &dwOut))
+        for y in 0..<h {
+            for x in 0..<w {
+                for ch in 0..<c {
+                    var sum: Float = 0
+                    for kh in 0..<3 {
+                        for kw in 0..<3 {
+                            let iy = y - 1 + kh, ix = x - 1 + kw
+                            guard iy >= 0, iy < h, ix >= 0, ix < w else { continue }
+                            sum += input[(iy * w + ix) * c + ch] * dwFilter[(kh * 3 + kw) * c + ch]
+                        }
+                    }
+                    XCTAssertEqual(dwOut[(y * w + x) * c + ch], sum)
+                }
+            }
+        }
+        
+        // 1x1 is a GEMM over the pixels, with RELU6 clamping
+        let outC = 3
+        let pwFilter = (0..<c*outC).map { Float($0 % 3) - 1 }
+        var pwOut = [Float](repeating: 0, count: h * w * outC)
+        XCTAssertTrue(amx_conv1x1_f32(input, h * w, c, pwFilter, outC, nil, AMX_ACT_RELU6, &pwOut))
+        let expected = referenceMatmul(input, pwFilter, h * w, c, outC)
+        XCTAssertEqual(pwOut, expected.map { min(max($0, 0), 6) })
+    }
+    
+    func testFlashAttention() {
+        // Two query heads share one K/V head; causal rows check against a direct softmax
+        let heads = 2, len = 90, d = 24
+        let q = (0..<len*heads*d).map { Float(($0 * 7) % 13) / 13 - 0.5 }
+        let k = (0..<len*d).map { Float(($0 * 5) % 11) / 11 - 0.5 }
+        let v = (0..<len*d).map { Float($0 % 17) / 17 }
+        var p = AmxAttentionParams()
+        p.batch = 1; p.heads = heads; p.kv_heads = 1; p.q_len = len; p.kv_len = len
+        p.head_dim = d; p.causal = true
+        var out = [Float](repeating: 0, count: len * heads * d)
+        XCTAssertTrue(amx_attention_f32(&p, q, k, v, &out))
+        
+        let scale = 1 / Float(d).squareRoot()
+        for h in 0..<heads {
+            for i in 0..<len {
+                let qi = (i * heads + h) * d
+                let scores = (0...i).map { j in (0..<d).reduce(Float(0)) { $0 + q[qi + $1] * k[j * d + $1] } * scale }
+                let top = scores.max()!
+                let weights = scores.map { exp($0 - top) }
+                let total = weights.reduce(0, +)
+                for e in 0..<d {
+                    let expected = (0...i).reduce(Float(0)) { $0 + weights[$1] * v[$1 * d + e] } / total
+                    XCTAssertEqual(out[qi + e], expected, accuracy: 1e-4)
+                }
+            }
+        }
+    }
+    
+    func testRowNormalization() {
+        let rows = 5, cols = 37
+        let data = (0..<rows*cols).map { Float(($0 * 13) % 29) / 7 - 2 }
+        let gamma = (0..<cols).map { Float($0 % 3) + 0.5 }
+        let beta = (0..<cols).map { Float($0 % 5) / 10 }
+        
+        let soft = makeCMatrix(rows, cols, data)
+        let norm = makeCMatrix(rows, cols, data)
+        let rms = makeCMatrix(rows, cols, data)
+        defer { amx_matrix_free(soft); amx_matrix_free(norm); amx_matrix_free(rms) }
+        XCTAssertTrue(amx_matrix_softmax(soft))
+        XCTAssertTrue(amx_matrix_layernorm(norm, gamma, beta, 0))
+        XCTAssertTrue(amx_matrix_rmsnorm(rms, gamma, 1e-6))
+        
+        for i in 0..<rows {
+            let row = Array(data[i * cols..<(i + 1) * cols])
+            let top = row.max()!
+            let total = row.reduce(0) { $0 + exp($1 - top) }
+            let mean = row.reduce(0, +) / Float(cols)
+            let variance = row.reduce(0) { $0 + ($1 - mean) * ($1 - mean) } / Float(cols)
+            let meanSquare = row.reduce(0) { $0 + $1 * $1 } / Float(cols)
+            for j in 0..<cols {
+                XCTAssertEqual(amx_matrix_get(soft, i, j), exp(row[j] - top) / total, accuracy: 1e-6)
+                let expectedNorm = (row[j] - mean) / (variance + 1e-5).squareRoot() * gamma[j] + beta[j]
+                XCTAssertEqual(amx_matrix_get(norm, i, j), expectedNorm, accuracy: 1e-4)
+                XCTAssertEqual(amx_matrix_get(rms, i, j), row[j] / (meanSquare + 1e-6).squareRoot() * gamma[j], accuracy: 1e-4)
+            }
+        }
+
+        // -inf masked logits, in both the vector body and the scalar tail, get exactly 0
+        let maskedRow = (0..<20).map { $0 % 3 == 0 ? Float($0) / 10 : -Float.infinity }
+        let masked = makeCMatrix(1, 20, maskedRow)
+        defer { amx_matrix_free(masked) }
+        XCTAssertTrue(amx_matrix_softmax(masked))
+        var maskedTotal: Float = 0
+        for j in 0..<20 {
+            if maskedRow[j] == -Float.infinity {
+                XCTAssertEqual(amx_matrix_get(masked, 0, j), 0)
+            } else {
+                maskedTotal += amx_matrix_get(masked, 0, j)
+            }
+        }
+        XCTAssertEqual(maskedTotal, 1, accuracy: 1e-5)
+
+        // A fully masked row is zeros; +inf entries split the row between them
+        let infinite = makeCMatrix(2, 20, (0..<40).map { i -> Float in
+            i < 20 ? -.infinity : (i % 10 == 3 ? .infinity : Float(i))
+        })
+        defer { amx_matrix_free(infinite) }
+        XCTAssertTrue(amx_matrix_softmax(infinite))
+        for j in 0..<20 {
+            XCTAssertEqual(amx_matrix_get(infinite, 0, j), 0)
+            XCTAssertEqual(amx_matrix_get(infinite, 1, j), j % 10 == 3 ? 0.5 : 0)
+        }
+
+        // Fused as the GEMM epilogue: same result as normalizing the product afterwards
+        let a = makeCMatrix(rows, 20, (0..<rows*20).map { Float($0 % 7) - 3 })
+        let b = makeCMatrix(20, cols, (0..<20*cols).map { Float($0 % 5) / 5 })
+        var op = AmxRowOp()
+        op.kind = AMX_ROW_SOFTMAX
+        let fused = amx_matrix_matmul_row_op(a, b, &op)
+        let product = amx_matrix_matmul(a, b)
+        defer { amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(fused); amx_matrix_free(product) }
+        XCTAssertTrue(amx_matrix_row_op(product, &op))
+        for i in 0..<rows {
+            for j in 0..<cols {
+                XCTAssertEqual(amx_matrix_get(fused, i, j), amx_matrix_get(product, i, j), accuracy: 1e-6)
+            }
+        }
+    }
+    
+    func testTriangularSolve() {
+        // X * U = B for upper U with a unit diagonal; the lower triangle is junk and must not be read
+        let n = 150, m = 90
+        let uData = (0..<n*n).map { i -> Float in
+            let (r, c) = (i / n, i % n)
+            return c > r ? Float((i * 29) % 23) / 230 - 0.05 : 1e6
+        }
+        let xData = (0..<m*n).map { Float($0 % 11) - 5 }
+        let u = makeCMatrix(n, n, uData), x = makeCMatrix(m, n, xData)
+        let unit = makeCMatrix(n, n, (0..<n*n).map { i -> Float in
+            let (r, c) = (i / n, i % n)
+            return c > r ? uData[i] : (c == r ? 1 : 0)
+        })
+        let b = amx_matrix_matmul(x, unit)
+        defer { amx_matrix_free(u); amx_matrix_free(x); amx_matrix_free(unit); amx_matrix_free(b) }
+        
+        XCTAssertTrue(amx_matrix_trsm(AMX_RIGHT, AMX_UPPER, AMX_NO_TRANS, AMX_UNIT, u, b))
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(b, i, j), xData[i * n + j], accuracy: 1e-3)
+            }
+        }
+        
+        // op(T) * X = B with T^T read in place
+        let l = makeCMatrix(3, 3, [2, 0, 0, 1, 4, 0, -1, 2, 5])
+        let rhs = makeCMatrix(3, 1, [1, 2, 5])
+        defer { amx_matrix_free(l); amx_matrix_free(rhs) }
+        XCTAssertTrue(amx_matrix_trsm(AMX_LEFT, AMX_LOWER, AMX_TRANS, AMX_NON_UNIT, l, rhs))
+        // L^T = [2 1 -1; 0 4 2; 0 0 5]: x2 = 1, x1 = 0, x0 = 1
+        XCTAssertEqual(amx_matrix_get(rhs, 0, 0), 1, accuracy: 1e-6)
+        XCTAssertEqual(amx_matrix_get(rhs, 1, 0), 0, accuracy: 1e-6)
+        XCTAssertEqual(amx_matrix_get(rhs, 2, 0), 1, accuracy: 1e-6)
+    }
+    
+    func testSymmetricRankK() {
+        let n = 70, k = 45
+        let aData = (0..<n*k).map { Float(($0 * 31) % 17) / 8 - 1 }
+        let a = makeCMatrix(n, k, aData)
+        let expected = referenceMatmul(aData, (0..<k*n).map { aData[($0 % n) * k + $0 / n] }, n, k, n)
+        
+        // Lower triangle only: tiles wholly above the diagonal keep their old values
+        let c = makeCMatrix(n, n, [Float](repeating: 9, count: n * n))
+        let gram = amx_matrix_gram(a, AMX_NO_TRANS)
+        defer { amx_matrix_free(a); amx_matrix_free(c); amx_matrix_free(gram) }
+        XCTAssertTrue(amx_matrix_syrk(AMX_LOWER, AMX_NO_TRANS, 1, a, 0, c, false))
+        for i in 0..<n {
+            for j in 0..<n {
+                if j / 16 <= i / 16 {
+                    XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j], accuracy: 1e-3)
+                } else {
+                    XCTAssertEqual(amx_matrix_get(c, i, j), 9)
+                }
+                XCTAssertEqual(amx_matrix_get(gram, i, j), expected[i * n + j], accuracy: 1e-3)
+                XCTAssertEqual(amx_matrix_get(gram, i, j), amx_matrix_get(gram, j, i))
+            }
+        }
+    }
+    
+    func testCholeskySolve() {
+        // A = M * M^T + n * I is symmetric positive definite
+        let n = 150, nrhs = 3
+        let mData = (0..<n*n).map { Float(($0 * 7) % 13) / 13 - 0.5 }
+        let m = makeCMatrix(n, n, mData)
+        let a = amx_matrix_matmul_t(m, AMX_NO_TRANS, m, AMX_TRANS)
+        for i in 0..<n { amx_matrix_set(a, i, i, amx_matrix_get(a, i, i) + Float(n)) }
+        let l = amx_matrix_clone(a)
+        let xData = (0..<n*nrhs).map { Float($0 % 5) - 2 }
+        let x = makeCMatrix(n, nrhs, xData)
+        let b = amx_matrix_matmul(a, x)
+        defer {
+            amx_matrix_free(m); amx_matrix_free(a); amx_matrix_free(l)
+            amx_matrix_free(x); amx_matrix_free(b)
+        }
+        
+        XCTAssertEqual(amx_matrix_cholesky(l), 0)
+        XCTAssertEqual(amx_matrix_get(l, 0, 1), 0)
+        XCTAssertTrue(amx_matrix_cholesky_solve(l, b))
+        for i in 0..<n {
+            for j in 0..<nrhs {
+                XCTAssertEqual(amx_matrix_get(b, i, j), xData[i * nrhs + j], accuracy: 1e-3)
+            }
+        }
+        
+        // Negative pivot in the first column is reported as minor 1
+        let bad = makeCMatrix(2, 2, [-1, 0, 0, 1])
+        defer { amx_matrix_free(bad) }
+        XCTAssertEqual(amx_matrix_cholesky(bad), 1)
+    }
+    
+    func testLUSolve() {
+        let n = 140, nrhs = 4
+        let aData = (0..<n*n).map { Float(($0 * 37) % 101) / 50 - 1 }
+        let xData = (0..<n*nrhs).map { Float($0 % 7) - 3 }
+        let a = makeCMatrix(n, n, aData), x = makeCMatrix(n, nrhs, xData)
+        let b = amx_matrix_matmul(a, x)
+        let solved = amx_matrix_solve(a, b)
+        defer { amx_matrix_free(a); amx_matrix_free(x); amx_matrix_free(b); amx_matrix_free(solved) }
+        
+        XCTAssertNotNil(solved)
+        for i in 0..<n {
+            for j in 0..<nrhs {
+                XCTAssertEqual(amx_matrix_get(solved, i, j), xData[i * nrhs + j], accuracy: 1e-2)
+            }
+        }
+        
+        // The first column has its largest entry in row 1, so row 0 swaps with it
+        let small = makeCMatrix(2, 2, [1, 2, 4, 3])
+        defer { amx_matrix_free(small) }
+        var pivots = [Int](repeating: 0, count: 2)
+        XCTAssertEqual(amx_matrix_lu(small, &pivots), 0)
+        XCTAssertEqual(pivots, [1, 1])
+        XCTAssertEqual(amx_matrix_get(small, 0, 0), 4)
+        XCTAssertEqual(amx_matrix_get(small, 1, 0), 0.25)
+        XCTAssertEqual(amx_matrix_get(small, 1, 1), 1.25)
+    }
+    
+    func testQRLeastSquares() {
+        let m = 300, n = 45
+        let aData = (0..<m*n).map { Float(($0 * 53) % 97) / 48 - 1 }
+        let xData = (0..<n).map { Float($0 % 5) - 2 }
+        let a = makeCMatrix(m, n, aData), x = makeCMatrix(n, 1, xData)
+        let b = amx_matrix_matmul(a, x)
+        let solved = amx_matrix_lstsq(a, b)
+        defer { amx_matrix_free(a); amx_matrix_free(x); amx_matrix_free(b); amx_matrix_free(solved) }
+        
+        XCTAssertNotNil(solved)
+        for i in 0..<n {
+            XCTAssertEqual(amx_matrix_get(solved, i, 0), xData[i], accuracy: 1e-2)
+        }
+        
+        // Q * R reproduces A and Q has orthonormal columns
+        let f = amx_matrix_clone(a)
+        var tau = [Float](repeating: 0, count: n)
+        XCTAssertTrue(amx_matrix_qr(f, &tau))
+        let q = amx_matrix_qr_q(f, tau)
+        let r = amx_matrix_zeros(n, n)
+        for i in 0..<n {
+            for j in i..<n { amx_matrix_set(r, i, j, amx_matrix_get(f, i, j)) }
+        }
+        let qr = amx_matrix_matmul(q, r)
+        let qtq = amx_matrix_matmul_t(q, AMX_TRANS, q, AMX_NO_TRANS)
+        defer { amx_matrix_free(f); amx_matrix_free(q); amx_matrix_free(r); amx_matrix_free(qr); amx_matrix_free(qtq) }
+        
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(qr, i, j), aData[i * n + j], accuracy: 1e-3)
+            }
+        }
+        for i in 0..<n {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(qtq, i, j), i == j ? 1 : 0, accuracy: 1e-4)
+            }
+        }
+
+        // Column 4 = 2 * column 0 + column 1: R gets a tiny, not zero, diagonal entry
+        var deficientData = (0..<100*5).map { Float(($0 * 31) % 17) / 8 - 1 }
+        for i in 0..<100 { deficientData[i * 5 + 4] = 2 * deficientData[i * 5] + deficientData[i * 5 + 1] }
+        let deficient = makeCMatrix(100, 5, deficientData)
+        let rhs = makeCMatrix(100, 1, (0..<100).map { Float($0 % 7) })
+        defer { amx_matrix_free(deficient); amx_matrix_free(rhs) }
+        XCTAssertNil(amx_matrix_lstsq(deficient, rhs))
+    }
+    
+    func testSparseMatmul() {
+        // Row 1 is empty, row 3 is fully dense; small entries are dropped by the threshold
+        let m = 6, k = 40, n = 70
+        let aData = (0..<m*k).map { i -> Float in
+            let row = i / k, col = i % k
+            if row == 1 { return 0 }
+            if row == 3 { return Float(col % 7) - 3 }
+            return (row * 7 + col * 3) % 11 == 0 ? Float(col % 5) + 1 : 0.001
+        }
+        let a = makeCMatrix(m, k, aData)
+        let b = makeCMatrix(k, n, (0..<k*n).map { Float($0 % 9) / 4 - 1 })
+        guard let sparse = amx_matrix_csr_from_dense(a, 0.01) else { return XCTFail("csr_from_dense failed") }
+        defer { amx_matrix_free(a); amx_matrix_free(b); amx_matrix_csr_free(sparse) }
+        
+        let kept = aData.filter { abs($0) > 0.01 }.count
+        XCTAssertEqual(amx_matrix_csr_nnz(sparse), kept)
+        XCTAssertEqual(amx_matrix_csr_row_ptr(sparse)[2], amx_matrix_csr_row_ptr(sparse)[1])
+        
+        let c = amx_matrix_csr_matmul(sparse, b)
+        defer { amx_matrix_free(c) }
+        XCTAssertNotNil(c)
+        let dropped = aData.map { abs($0) > 0.01 ? $0 : 0 }
+        let bData = (0..<k*n).map { Float($0 % 9) / 4 - 1 }
+        let expected = referenceMatmul(dropped, bData, m, k, n)
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j], accuracy: 1e-4)
+            }
+        }
+        
+        // Column indices must be sorted and in range
+        let rowPtr: [Int] = [0, 2, 3]
+        let badCols: [UInt32] = [3, 1, 0]
+        let values: [Float] = [1, 2, 3]
+        XCTAssertNil(amx_matrix_csr_from_data(2, 4, rowPtr, badCols, values))
+        XCTAssertNil(amx_matrix_csr_from_data(2, 4, rowPtr, nil, values))
+        let goodCols: [UInt32] = [1, 3, 0]
+        let built = amx_matrix_csr_from_data(2, 4, rowPtr, goodCols, values)
+        let dense = amx_matrix_csr_to_dense(built)
+        defer { amx_matrix_csr_free(built); amx_matrix_free(dense) }
+        XCTAssertEqual(amx_matrix_get(dense, 0, 3), 2)
+        XCTAssertEqual(amx_matrix_get(dense, 1, 0), 3)
+        XCTAssertEqual(amx_matrix_get(dense, 0, 0), 0)
+    }
+    
+    func testBlockSparseMatmul() {
+        // 40 x 50 is 3 x 4 tiles with ragged edges; only tiles (0, 1), (1, 3) and (2, 0) hold values
+        let m = 40, k = 50, n = 33
+        let aData = (0..<m*k).map { i -> Float in
+            let (bi, bj) = (i / k / 16, i % k / 16)
+            let kept = (bi == 0 && bj == 1) || (bi == 1 && bj == 3) || (bi == 2 && bj == 0)
+            return kept ? Float(i % 13) / 6 - 1 : 0
+        }
+        let bData = (0..<k*n).map { Float($0 % 7) / 3 - 1 }
+        let a = makeCMatrix(m, k, aData)
+        let b = makeCMatrix(k, n, bData)
+        guard let sparse = amx_matrix_bsr_from_dense(a, 0) else { return XCTFail("bsr_from_dense failed") }
+        defer { amx_matrix_free(a); amx_matrix_free(b); amx_matrix_bsr_free(sparse) }
+        
+        XCTAssertEqual(amx_matrix_bsr_tiles(sparse), 3)
+        XCTAssertTrue(amx_matrix_bsr_has_tile(sparse, 1, 3))
+        XCTAssertFalse(amx_matrix_bsr_has_tile(sparse, 1, 2))
+        
+        let c = amx_matrix_bsr_matmul(sparse, b)
+        defer { amx_matrix_free(c) }
+        XCTAssertNotNil(c)
+        let expected = referenceMatmul(aData, bData, m, k, n)
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j], accuracy: 1e-4)
+            }
+        }
+    }
+    
+    func testStrassenMatmul() {
+        // A cutoff of 64 recurses twice on 150 x 190 x 170, which pads every side to a multiple of 64
+        let m = 150, k = 190, n = 170
+        let aData = (0..<m*k).map { Float(($0 * 7) % 23) / 11 - 1 }
+        let bData = (0..<k*n).map { Float(($0 * 5) % 19) / 9 - 1 }
+        let a = makeCMatrix(m, k, aData)
+        let b = makeCMatrix(k, n, bData)
+        let fast = amx_matrix_matmul_algo(a, b, AMX_MATMUL_STRASSEN, 64)
+        let tiled = amx_matrix_matmul_algo(a, b, AMX_MATMUL_TILED, 0)
+        defer { amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(fast); amx_matrix_free(tiled) }
+        XCTAssertNotNil(fast)
+        
+        let expected = referenceMatmul(aData, bData, m, k, n)
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(fast, i, j), expected[i * n + j], accuracy: 1e-3)
+                XCTAssertEqual(amx_matrix_get(tiled, i, j), expected[i * n + j], accuracy: 1e-3)
+            }
+        }
+        
+        // 128 x 120 needs no row padding and keeps C's stride, so C is computed in place;
+        // its padding columns must still come out exactly zero
+        let p = makeCMatrix(128, 128, (0..<128*128).map { Float(($0 * 3) % 13) / 6 - 1 })
+        let q = makeCMatrix(128, 120, (0..<128*120).map { Float(($0 * 7) % 11) / 5 - 1 })
+        let inPlace = amx_matrix_matmul_algo(p, q, AMX_MATMUL_STRASSEN, 64)
+        defer { amx_matrix_free(p); amx_matrix_free(q); amx_matrix_free(inPlace) }
+        let stride = amx_matrix_stride(inPlace)
+        let data = amx_matrix_data(inPlace)!
+        for i in 0..<128 {
+            for j in 120..<stride {
+                XCTAssertEqual(data[i * stride + j], 0)
+            }
+        }
+    }
+    
+    func testChainMultiply() {
+        // (30 x 200)(200 x 3)(3 x 150)(150 x 1): the cheap order multiplies from the right
+        let dims = [30, 200, 3, 150, 1]
+        var data: [[Float]] = []
+        var mats: [OpaquePointer?] = []
+        for t in 0..<4 {
+            let values = (0..<dims[t] * dims[t + 1]).map { Float(($0 * (t + 3)) % 17) / 8 - 1 }
+            data.append(values)
+            mats.append(makeCMatrix(dims[t], dims[t + 1], values))
+        }
+        defer { mats.forEach { amx_matrix_free($0) } }
+        
+        let result = amx_matrix_chain_multiply(mats, 4)
+        defer { amx_matrix_free(result) }
+        XCTAssertEqual(amx_matrix_rows(result), 30)
+        XCTAssertEqual(amx_matrix_cols(result), 1)
+        
+        var expected = data[0]
+        for t in 1..<4 {
+            expected = referenceMatmul(expected, data[t], dims[0], dims[t], dims[t + 1])
+        }
+        for i in 0..<30 {
+            XCTAssertEqual(amx_matrix_get(result, i, 0), expected[i], accuracy: abs(expected[i]) * 1e-4 + 1e-3)
+        }
+        
+        // Adjacent shapes must chain
+        let mismatched: [OpaquePointer?] = [mats[0], mats[2]]
+        XCTAssertNil(amx_matrix_chain_multiply(mismatched, 2))
+    }
+    
+    func testNearestNeighbors() {
+        // Query q is database point 3q + 1 shifted by 0.01 along the first axis
+        let d = 5, n = 30
+        let yData = (0..<n*d).map { Float(($0 * 11) % 31) / 4 - 3 }
+        var xData: [Float] = []
+        for q in 0..<4 {
+            let row = Array(yData[(3 * q + 1) * d..<(3 * q + 2) * d])
+            xData += [row[0] + 0.01] + row[1...]
+        }
+        let x = makeCMatrix(4, d, xData)
+        let y = makeCMatrix(n, d, yData)
+        defer { amx_matrix_free(x); amx_matrix_free(y) }
+        
+        let k = 3
+        var scores = [Float](repeating: 0, count: 4 * k)
+        var indices = [UInt32](repeating: 0, count: 4 * k)
+        XCTAssertTrue(amx_matrix_knn(x, y, AMX_METRIC_L2, k, &scores, &indices))
+        let distances = amx_matrix_pairwise(x, y, AMX_METRIC_L2)
+        defer { amx_matrix_free(distances) }
+        for q in 0..<4 {
+            XCTAssertEqual(indices[q * k], UInt32(3 * q + 1))
+            XCTAssertEqual(scores[q * k], 1e-4, accuracy: 1e-3)
+            for r in 0..<k {
+                XCTAssertEqual(scores[q * k + r], amx_matrix_get(distances, q, Int(indices[q * k + r])), accuracy: 1e-3)
+                if r > 0 { XCTAssertLessThanOrEqual(scores[q * k + r - 1], scores[q * k + r]) }
+            }
+        }
+        
+        // A point's own direction has cosine 1, the largest possible
+        var best = [Float](repeating: 0, count: n)
+        var nearest = [UInt32](repeating: 0, count: n)
+        XCTAssertTrue(amx_matrix_knn(y, y, AMX_METRIC_COSINE, 1, &best, &nearest))
+        for j in 0..<n {
+            XCTAssertEqual(best[j], 1, accuracy: 1e-5)
+        }
+        XCTAssertFalse(amx_matrix_knn(x, y, AMX_METRIC_L2, n + 1, &scores, &indices))
+    }
+    
+    // MARK: - Half Precision Tests
+    
+    func testF16RoundTrip() {
+        let values: [Float] = [0, 1, -2.5, 65504, 1e-5, 0.1]
+        var halves = [UInt16](repeating: 0, count: values.count)
+        var back = [Float](repeating: 0, count: values.count)
+        amx_f32_to_f16(values, &halves, values.count)
+        amx_f16_to_f32(halves, &back, values.count)
+        
+        XCTAssertEqual(halves[1], 0x3C00)
+        XCTAssertEqual(halves[3], 0x7BFF)
+        for (v, b) in zip(values, back) {
+            XCTAssertEqual(b, v, accuracy: abs(v) * 1e-3 + 1e-7)
+        }
+    }
+    
+    func testF16Matmul() {
+        // Values are exact in f16, so the f32-accumulated result is exact too
+        // The second shape spans two K blocks and several row tasks
+        for (m, k, n) in [(40, 70, 33), (130, 300, 33)] {
+            let aData = (0..<m*k).map { Float($0 % 7) * 0.25 }
+            let bData = (0..<k*n).map { Float($0 % 5) - 2 }
+            let a = makeCMatrix(m, k, aData)
+            let b = makeCMatrix(k, n, bData)
+            let ah = amx_matrix_f16_from_f32(a)
+            let bh = amx_matrix_f16_from_f32(b)
+            let c = amx_matrix_f16_matmul(ah, bh)
+            defer {
+                amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(c)
+                amx_matrix_f16_free(ah); amx_matrix_f16_free(bh)
+            }
+            
+            XCTAssertNotNil(c)
+            let expected = referenceMatmul(aData, bData, m, k, n)
+            for i in 0..<m {
+                for j in 0..<n {
+                    XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j], accuracy: 1e-3)
+                }
+            }
+        }
+    }
+    
+    // MARK: - BFloat16 Tests
+    
+    func testBF16Conversion() {
+        let values: [Float] = [1, -3.0, 1.00390625, 3.0e38, 0.1]
+        var raw = [UInt16](repeating: 0, count: values.count)
+        var back = [Float](repeating: 0, count: values.count)
+        amx_f32_to_bf16(values, &raw, values.count)
+        amx_bf16_to_f32(raw, &back, values.count)
+        
+        XCTAssertEqual(raw[0], 0x3F80)
+        XCTAssertEqual(raw[1], 0xC040)
+        XCTAssertEqual(back[2], 1.0)  // halfway case rounds to even
+        for (v, b) in zip(values, back) {
+            XCTAssertEqual(b, v, accuracy: abs(v) * 4e-3)
+        }
+    }
+    
+    func testBF16Matmul() {
+        // Small integers are exact in bf16, so the f32-accumulated result is exact
+        // The second shape spans two K blocks and several row tasks
+        for (m, k, n) in [(50, 37, 70), (130, 300, 70)] {
+            let aData = (0..<m*k).map { Float($0 % 9) - 4 }
+            let bData = (0..<k*n).map { Float($0 % 4) }
+            let a = makeCMatrix(m, k, aData)
+            let b = makeCMatrix(k, n, bData)
+            let ah = amx_matrix_bf16_from_f32(a)
+            let bh = amx_matrix_bf16_from_f32(b)
+            let c = amx_matrix_bf16_matmul(ah, bh)
+            defer {
+                amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(c)
+                amx_matrix_bf16_free(ah); amx_matrix_bf16_free(bh)
+            }
+            
+            XCTAssertNotNil(c)
+            let expected = referenceMatmul(aData, bData, m, k, n)
+            for i in 0..<m {
+                for j in 0..<n {
+                    XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j])
+                }
+            }
+        }
+    }
+    
+    func testI8Matmul() {
+        // Asymmetric activations, per-column symmetric weights
+        let m = 45, k = 70, n = 37
+        let aData = (0..<m*k).map { Float($0 % 11) * 0.1 - 0.3 }
+        let bData = (0..<k*n).map { Float($0 % 7) * 0.05 - 0.15 }
+        let a = makeCMatrix(m, k, aData)
+        let b = makeCMatrix(k, n, bData)
+        let qa = amx_matrix_i8_quantize(a, AMX_QUANT_PER_TENSOR, false)
+        let qb = amx_matrix_i8_quantize(b, AMX_QUANT_PER_COL, true)
+        let da = amx_matrix_i8_dequantize(qa)
+        let db = amx_matrix_i8_dequantize(qb)
+        let c = amx_matrix_i8_matmul(qa, qb, nil)
+        defer {
+            amx_matrix_free(a); amx_matrix_free(b); amx_matrix_free(c)
+            amx_matrix_free(da); amx_matrix_free(db)
+            amx_matrix_i8_free(qa); amx_matrix_i8_free(qb)
+        }
+        
+        XCTAssertNotNil(c)
+        XCTAssertNotEqual(amx_matrix_i8_zero_points(qa)![0], 0)
+        
+        // Integer accumulation is exact, so the result matches the dequantized product
+        var daData = [Float](), dbData = [Float]()
+        for i in 0..<m { for p in 0..<k { daData.append(amx_matrix_get(da, i, p)) } }
+        for p in 0..<k { for j in 0..<n { dbData.append(amx_matrix_get(db, p, j)) } }
+        let expected = referenceMatmul(daData, dbData, m, k, n)
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j], accuracy: 1e-3)
+            }
+        }
+    }
+    
+    func testI8MatmulRequant() {
+        // Per-row asymmetric activations over two K blocks and several row tasks
+        let m = 130, k = 300, n = 37
+        let aData = (0..<m*k).map { Float($0 % 11) * 0.1 - Float($0 / k % 4) * 0.2 }
+        let bData = (0..<k*n).map { Float($0 % 7) * 0.05 - 0.15 }
+        let bias = (0..<n).map { Float($0 % 3) - 1 }
+        let a = makeCMatrix(m, k, aData)
+        let b = makeCMatrix(k, n, bData)
+        let qa = amx_matrix_i8_quantize(a, AMX_QUANT_PER_ROW, false)!
+        let qb = amx_matrix_i8_quantize(b, AMX_QUANT_PER_COL, true)!
+        defer {
+            amx_matrix_free(a); amx_matrix_free(b)
+            amx_matrix_i8_free(qa); amx_matrix_i8_free(qb)
+        }
+
+        // Exact zero-point-corrected accumulators from the raw quantized data
+        let qaData = amx_matrix_i8_data(qa)!, qbData = amx_matrix_i8_data(qb)!
+        let aStride = amx_matrix_i8_stride(qa), bStride = amx_matrix_i8_stride(qb)
+        let za = amx_matrix_i8_zero_points(qa)!, zb = amx_matrix_i8_zero_points(qb)!
+        let sa = amx_matrix_i8_scales(qa)!, sb = amx_matrix_i8_scales(qb)!
+        XCTAssertNotEqual(za[0], za[1])
+        var acc = [Int32](repeating: 0, count: m * n)
+        for i in 0..<m {
+            for p in 0..<k {
+                let av = Int32(qaData[i * aStride + p]) - za[i]
+                for j in 0..<n { acc[i * n + j] += av * (Int32(qbData[p * bStride + j]) - zb[j]) }
+            }
+        }
+
+        var c32 = [Int32](repeating: 0, count: m * n)
+        XCTAssertTrue(amx_matrix_i8_matmul_i32(qa, qb, &c32, n))
+        XCTAssertEqual(c32, acc)
+
+        let real = (0..<m*n).map { sa[$0 / n] * sb[$0 % n] * Float(acc[$0]) + bias[$0 % n] }
+        let outScale = real.map { abs($0) }.max()! / 100, outZero: Int32 = 5
+        guard let c = amx_matrix_i8_matmul_requant(qa, qb, bias, outScale, outZero) else {
+            return XCTFail("i8_matmul_requant failed")
+        }
+        defer { amx_matrix_i8_free(c) }
+        let cData = amx_matrix_i8_data(c)!, cStride = amx_matrix_i8_stride(c)
+        for i in 0..<m {
+            for j in 0..<n {
+                let expected = min(max((real[i * n + j] / outScale).rounded() + Float(outZero), -128), 127)
+                XCTAssertEqual(Float(cData[i * cStride + j]), expected, accuracy: 1)
+            }
+        }
+    }
+
+    func testQ4Matmul() {
+        // The second shape spans two K blocks and several row tasks
+        for (m, k, n) in [(20, 96, 50), (130, 320, 50)] {
+            let aData = (0..<m*k).map { Float($0 % 5) - 2 }
+            let wData = (0..<k*n).map { Float($0 % 13) * 0.1 - 0.6 }
+            let a = makeCMatrix(m, k, aData)
+            let w = makeCMatrix(k, n, wData)
+            let q = amx_matrix_q4_quantize(w, 32)
+            let dw = amx_matrix_q4_dequantize(q)
+            let c = amx_matrix_q4_matmul(a, q)
+            defer {
+                amx_matrix_free(a); amx_matrix_free(w); amx_matrix_free(dw); amx_matrix_free(c)
+                amx_matrix_q4_free(q)
+            }
+            
+            XCTAssertNotNil(c)
+            var dwData = [Float]()
+            for p in 0..<k { for j in 0..<n { dwData.append(amx_matrix_get(dw, p, j)) } }
+            let expected = referenceMatmul(aData, dwData, m, k, n)
+            let tolerance = Float(k) * 1e-5
+            for i in 0..<m {
+                for j in 0..<n {
+                    XCTAssertEqual(amx_matrix_get(c, i, j), expected[i * n + j], accuracy: tolerance)
+                }
+            }
+            
+            // GEMV on the first activation row matches the first output row
+            var y = [Float](repeating: 0, count: n)
+            amx_matrix_q4_gemv(q, Array(aData[0..<k]), &y)
+            for j in 0..<n {
+                XCTAssertEqual(y[j], expected[j], accuracy: tolerance)
+            }
+        }
+    }
+    
+    func testI16Q15Matmul() {
+        // 0.5 * 0.25 summed over k = 8 -> 1.0, saturates to 32767 in Q15
+        let m = 40, k = 8, n = 35
+        let half = [Int16](repeating: 16384, count: m * k)
+        let quarter = [Int16](repeating: 8192, count: k * n)
+        let a = half.withUnsafeBufferPointer { amx_matrix_i16_from_data(m, k, $0.baseAddress) }
+        let b = quarter.withUnsafeBufferPointer { amx_matrix_i16_from_data(k, n, $0.baseAddress) }
+        let c = amx_matrix_i16_matmul(a, b, 15)
+        let c2 = amx_matrix_i16_matmul(a, b, 16)
+        defer {
+            amx_matrix_i16_free(a); amx_matrix_i16_free(b)
+            amx_matrix_i16_free(c); amx_matrix_i16_free(c2)
+        }
+        
+        XCTAssertNotNil(c)
+        for i in 0..<m {
+            for j in 0..<n {
+                XCTAssertEqual(amx_matrix_i16_get(c, i, j), Int16.max)
+                XCTAssertEqual(amx_matrix_i16_get(c2, i, j), 16384)
+            }
+        }
+    }
+    
+    // MARK: - Complex Tests
+    
+    func testComplexMatmul() {
+        // Small integers keep every partial product exact for both algorithms.
+        // The second shape runs three K blocks, so 3M resumes its accumulators
+        // across blocks, and spans several row tasks.
+        for (m, k, n) in [(33, 21, 18), (130, 600, 40)] {
+            let aRe = (0..<m*k).map { Float($0 % 5) - 2 }, aIm = (0..<m*k).map { Float($0 % 3) - 1 }
+            let bRe = (0..<k*n).map { Float($0 % 4) - 1 }, bIm = (0..<k*n).map { Float($0 % 7) - 3 }
+            let a = amx_matrix_c32_from_split(m, k, aRe, aIm)
+            let b = amx_matrix_c32_from_split(k, n, bRe, bIm)
+            defer { amx_matrix_c32_free(a); amx_matrix_c32_free(b) }
+            
+            let rr = referenceMatmul(aRe, bRe, m, k, n), ii = referenceMatmul(aIm, bIm, m, k, n)
+            let ri = referenceMatmul(aRe, bIm, m, k, n), ir = referenceMatmul(aIm, bRe, m, k, n)
+            for algo in [AMX_COMPLEX_3M, AMX_COMPLEX_4M] {
+                let c = amx_matrix_c32_matmul(a, b, algo)
+                defer { amx_matrix_c32_free(c) }
+                XCTAssertNotNil(c)
+                
+                var re: Float = 0, im: Float = 0
+                for i in 0..<m {
+                    for j in 0..<n {
+                        amx_matrix_c32_get(c, i, j, &re, &im)
+                        XCTAssertEqual(re, rr[i * n + j] - ii[i * n + j])
+                        XCTAssertEqual(im, ri[i * n + j] + ir[i * n + j])
+                    }
+                }
+            }
+        }
+    }
+    
     // MARK: - AMX Context Tests
     
     func testAmxContext() throws {
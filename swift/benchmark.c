@@ -1,6 +1,8 @@
 // Quick benchmark for AMX matmul
+// Usage: benchmark [n] [tiled|strassen] [cutoff]
 #include "Sources/CAMX/include/amx.h"
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <stdlib.h>
 
@@ -15,29 +17,40 @@ static double get_time_ms(void) {
 int main(int argc, char **argv) {
     int n = 256;
     if (argc > 1) n = atoi(argv[1]);
+    AmxMatmulAlgo algo = AMX_MATMUL_TILED;
+    if (argc > 2 && strcmp(argv[2], "strassen") == 0) algo = AMX_MATMUL_STRASSEN;
+    size_t cutoff = 0;
+    if (argc > 3) cutoff = (size_t)atoi(argv[3]);
+    
+    // Large products take seconds each
+    int iterations = ITERATIONS;
+    if (n >= 4096) iterations = 5;
+    else if (n >= 2048) iterations = 20;
     
     printf("AMX version: %d\n", amx_detect());
     printf("Matrix size: %dx%d\n", n, n);
-    printf("Iterations: %d\n\n", ITERATIONS);
+    printf("Algorithm: %s", algo == AMX_MATMUL_STRASSEN ? "strassen" : "tiled");
+    if (algo == AMX_MATMUL_STRASSEN) printf(" (cutoff %zu)", cutoff ? cutoff : (size_t)2048);
+    printf("\nIterations: %d\n\n", iterations);
     
     AmxMatrix *a = amx_matrix_fill(n, n, 1.0f);
     AmxMatrix *b = amx_matrix_fill(n, n, 2.0f);
     
     // Warmup
-    AmxMatrix *c = amx_matrix_matmul(a, b);
+    AmxMatrix *c = amx_matrix_matmul_algo(a, b, algo, cutoff);
     amx_matrix_free(c);
     
     double start = get_time_ms();
     
-    for (int i = 0; i < ITERATIONS; ++i) {
-        c = amx_matrix_matmul(a, b);
+    for (int i = 0; i < iterations; ++i) {
+        c = amx_matrix_matmul_algo(a, b, algo, cutoff);
         amx_matrix_free(c);
     }
     
     double elapsed = get_time_ms() - start;
-    double per_iter = elapsed / ITERATIONS;
+    double per_iter = elapsed / iterations;
     
-    // 2 * n^3 FLOPs for matmul
+    // 2 * n^3 FLOPs for matmul; Strassen is reported at the same nominal count
     double flops = 2.0 * n * n * n;
     double gflops = (flops / (per_iter / 1000.0)) / 1e9;
     
@@ -47,7 +60,7 @@ int main(int argc, char **argv) {
     printf("  Throughput: %.2f GFLOPS\n", gflops);
     
     // Verify result
-    c = amx_matrix_matmul(a, b);
+    c = amx_matrix_matmul_algo(a, b, algo, cutoff);
     float expected = n * 2.0f;
     float actual = amx_matrix_get(c, 0, 0);
     printf("\nVerification: c[0,0] = %.1f (expected %.1f) %s\n", 